@@ -0,0 +1,214 @@
+#include <memo/CryptoPool.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+#include <elle/With.hh>
+#include <elle/log.hh>
+
+#include <elle/reactor/Barrier.hh>
+#include <elle/reactor/scheduler.hh>
+
+#include <memo/environ.hh>
+
+ELLE_LOG_COMPONENT("memo.CryptoPool");
+
+namespace memo
+{
+  namespace
+  {
+    using Clock = std::chrono::steady_clock;
+
+    double
+    nanoseconds(Clock::duration d)
+    {
+      return std::chrono::duration<double, std::nano>(d).count();
+    }
+
+    /// Fold @a sample into the moving average @a average.
+    void
+    average(double& average, double sample)
+    {
+      average += (sample - average) / 16;
+    }
+
+    /// Most jobs a worker takes at once.
+    auto const batch_size = std::size_t(32);
+  }
+
+  struct CryptoPool::Job
+  {
+    Job(std::function<elle::Buffer ()> const& cipher,
+        elle::reactor::Scheduler& scheduler)
+      : cipher(cipher)
+      , scheduler(scheduler)
+      , cost()
+    {}
+
+    std::function<elle::Buffer ()> const& cipher;
+    elle::reactor::Scheduler& scheduler;
+    elle::reactor::Barrier done;
+    elle::Buffer result;
+    std::exception_ptr error;
+    Clock::duration cost;
+  };
+
+  CryptoPool::CryptoPool(int threads)
+    : _threads(std::max(threads, 0))
+    , _active(std::min(this->_threads, 1))
+    // AES is about a nanosecond per byte, and waking a worker then the
+    // reactor about twenty microseconds.
+    , _byte_cost(1)
+    , _handoff_cost(20000)
+    , _busy(0)
+    , _stop(false)
+  {
+    ELLE_TRACE("%s: start %s workers", this, this->_threads);
+    for (int i = 0; i < this->_threads; ++i)
+      this->_workers.emplace_back([this] { this->_work(); });
+  }
+
+  CryptoPool::~CryptoPool()
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->_mutex);
+      this->_stop = true;
+    }
+    this->_available.notify_all();
+    for (auto& worker: this->_workers)
+      worker.join();
+  }
+
+  CryptoPool&
+  CryptoPool::instance()
+  {
+    static CryptoPool res(
+      memo::getenv("RPC_CRYPTO_THREADS",
+                   int(std::max(std::thread::hardware_concurrency(), 1u))));
+    return res;
+  }
+
+  elle::Buffer
+  CryptoPool::encipher(elle::cryptography::SecretKey const& key,
+                       elle::ConstWeakBuffer plain)
+  {
+    return this->_run(plain.size(), [&] { return key.encipher(plain); });
+  }
+
+  elle::Buffer
+  CryptoPool::decipher(elle::cryptography::SecretKey const& key,
+                       elle::ConstWeakBuffer cipher)
+  {
+    return this->_run(cipher.size(), [&] { return key.decipher(cipher); });
+  }
+
+  std::size_t
+  CryptoPool::threshold() const
+  {
+    // Never hold the reactor more than a few milliseconds, whatever the
+    // measures say.
+    return std::max<std::size_t>(
+      std::min(this->_handoff_cost / this->_byte_cost, 1048576.), 1024);
+  }
+
+  elle::Buffer
+  CryptoPool::_run(std::size_t size, std::function<elle::Buffer ()> const& f)
+  {
+    auto const scheduler = elle::reactor::Scheduler::scheduler();
+    if (!this->_threads || !scheduler || size < this->threshold())
+    {
+      auto const start = Clock::now();
+      auto res = f();
+      if (size)
+        average(this->_byte_cost, nanoseconds(Clock::now() - start) / size);
+      return res;
+    }
+    Job job(f, *scheduler);
+    auto const start = Clock::now();
+    {
+      std::unique_lock<std::mutex> lock(this->_mutex);
+      this->_jobs.emplace_back(&job);
+      // Wake more workers when the backlog outgrows them.
+      if (this->_jobs.size() > std::size_t(this->_active) &&
+          this->_active < this->_threads)
+        ++this->_active;
+    }
+    this->_available.notify_one();
+    // The job lives on our stack until a worker is done with it.
+    elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+    {
+      elle::reactor::wait(job.done);
+    };
+    average(this->_byte_cost, nanoseconds(job.cost) / size);
+    average(this->_handoff_cost,
+            std::max(nanoseconds(Clock::now() - start - job.cost), 0.));
+    if (job.error)
+      std::rethrow_exception(job.error);
+    return std::move(job.result);
+  }
+
+  void
+  CryptoPool::_work()
+  {
+    while (true)
+    {
+      auto batch = std::vector<Job*>{};
+      {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        auto const ready = [this]
+          {
+            return this->_stop ||
+              (!this->_jobs.empty() && this->_busy < this->_active);
+          };
+        while (!ready())
+          if (!this->_available.wait_for(lock, std::chrono::seconds(1), ready)
+              && this->_jobs.empty() && this->_active > 1)
+            // Idle for a while, let a worker go back to sleep.
+            --this->_active;
+        if (this->_stop)
+          return;
+        // Share the backlog among the running workers.
+        auto const share = std::min(
+          batch_size,
+          std::max<std::size_t>(this->_jobs.size() / this->_active, 1));
+        for (auto i = 0u; i < share; ++i)
+        {
+          batch.emplace_back(this->_jobs.front());
+          this->_jobs.pop_front();
+        }
+        ++this->_busy;
+        if (!this->_jobs.empty())
+          this->_available.notify_one();
+      }
+      auto schedulers = std::map<elle::reactor::Scheduler*, std::vector<Job*>>{};
+      for (auto job: batch)
+      {
+        auto const start = Clock::now();
+        try
+        {
+          job->result = job->cipher();
+        }
+        catch (...)
+        {
+          job->error = std::current_exception();
+        }
+        job->cost = Clock::now() - start;
+        schedulers[&job->scheduler].emplace_back(job);
+      }
+      {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        --this->_busy;
+      }
+      this->_available.notify_one();
+      // Wake the reactor once for the whole batch.
+      for (auto& group: schedulers)
+        group.first->io_service().post(
+          [jobs = std::move(group.second)]
+          {
+            for (auto job: jobs)
+              job->done.open();
+          });
+    }
+  }
+}
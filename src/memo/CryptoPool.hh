@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+
+#include <elle/cryptography/SecretKey.hh>
+
+namespace memo
+{
+  /// Worker threads ciphering RPC payloads off the reactor thread.
+  ///
+  /// Payloads are ciphered inline when that is estimated cheaper than a
+  /// round trip to a worker: the threshold follows the measured cost per
+  /// byte and the measured hand-off latency.  Workers take queued jobs by
+  /// batches, and wake the reactor once per batch.  Callers wait for their
+  /// own payload, so writes on a channel keep their order.
+  ///
+  /// At most $MEMO_RPC_CRYPTO_THREADS workers (the number of cores by
+  /// default) are started; they are only woken up as the backlog requires.
+  class CryptoPool
+  {
+  public:
+    CryptoPool(int threads);
+    ~CryptoPool();
+    /// The process-wide pool.
+    static
+    CryptoPool&
+    instance();
+    elle::Buffer
+    encipher(elle::cryptography::SecretKey const& key,
+             elle::ConstWeakBuffer plain);
+    elle::Buffer
+    decipher(elle::cryptography::SecretKey const& key,
+             elle::ConstWeakBuffer cipher);
+    /// Payloads from this size on are handed to workers.
+    std::size_t
+    threshold() const;
+    ELLE_ATTRIBUTE_R(int, threads);
+    /// Workers allowed to run at once.
+    ELLE_ATTRIBUTE_R(int, active);
+
+  private:
+    struct Job;
+    elle::Buffer
+    _run(std::size_t size, std::function<elle::Buffer ()> const& f);
+    void
+    _work();
+    /// Nanoseconds to cipher a byte, averaged.
+    ELLE_ATTRIBUTE(double, byte_cost);
+    /// Nanoseconds from submitting a job to resuming its caller, minus the
+    /// ciphering itself, averaged.
+    ELLE_ATTRIBUTE(double, handoff_cost);
+    ELLE_ATTRIBUTE(std::vector<std::thread>, workers);
+    ELLE_ATTRIBUTE(std::mutex, mutex);
+    ELLE_ATTRIBUTE(std::condition_variable, available);
+    ELLE_ATTRIBUTE(std::deque<Job*>, jobs);
+    /// Workers currently running jobs.
+    ELLE_ATTRIBUTE(int, busy);
+    ELLE_ATTRIBUTE(bool, stop);
+  };
+}
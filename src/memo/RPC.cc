@@ -1,7 +1,13 @@
 #include <memo/RPC.hh>
 
+#include <numeric>
+
+
+#include <memo/model/prometheus.hh>
 #include <memo/utility.hh>
 
+ELLE_LOG_COMPONENT("memo.RPC");
+
 namespace memo
 {
   RPCServer::RPCServer()
@@ -19,6 +25,280 @@ namespace memo
     return output;
   }
 
+  /*----------.
+  | Admission |
+  `----------*/
+
+  std::ostream&
+  operator <<(std::ostream& output, RPCPriority priority)
+  {
+    switch (priority)
+    {
+      case RPCPriority::consensus:
+        return output << "consensus";
+      case RPCPriority::normal:
+        return output << "normal";
+      case RPCPriority::bulk:
+        return output << "bulk";
+    }
+    elle::unreachable();
+  }
+
+  namespace
+  {
+    prometheus::GaugePtr&
+    queue_depth(RPCPriority priority)
+    {
+      static auto const family = prometheus::make_gauge_family(
+        "memo_rpc_server_queue_depth",
+        "How many requests wait for a slot to be served");
+      static auto gauges = std::unordered_map<int, prometheus::GaugePtr>{};
+      auto it = gauges.find(int(priority));
+      if (it == gauges.end())
+        it = gauges.emplace(
+          int(priority),
+          prometheus::make(
+            family, {{"priority", elle::sprintf("%s", priority)}})).first;
+      return it->second;
+    }
+
+    prometheus::HistogramPtr&
+    wait_time(RPCPriority priority)
+    {
+      static auto const family = prometheus::make_histogram_family(
+        "memo_rpc_server_wait_seconds",
+        "How long requests wait for a slot to be served");
+      static auto histograms =
+        std::unordered_map<int, prometheus::HistogramPtr>{};
+      auto it = histograms.find(int(priority));
+      if (it == histograms.end())
+        it = histograms.emplace(
+          int(priority),
+          prometheus::make(family,
+                           {{"priority", elle::sprintf("%s", priority)}},
+                           prometheus::latency_buckets())).first;
+      return it->second;
+    }
+  }
+
+  RPCAdmission::RPCAdmission(int capacity, int procedure_capacity)
+    : _capacity(capacity)
+    , _procedure_capacity(procedure_capacity)
+    , _running(0)
+    , _waiting{{0, 0, 0}}
+  {}
+
+  void
+  RPCAdmission::acquire(std::string const& name, RPCPriority priority)
+  {
+    ELLE_LOG_COMPONENT("memo.RPC");
+    auto const p = int(priority);
+    prometheus::Timer timer(wait_time(priority));
+    auto& procedure = this->_procedures[name];
+    // Whether we wait, and whether for a connection slot.
+    auto waiting = false;
+    auto queued = false;
+    auto const queue = [&] (bool q)
+      {
+        if (q == queued)
+          return;
+        queued = q;
+        this->_waiting[p] += q ? 1 : -1;
+        // Lower priorities may go ahead now.
+        if (!q)
+          this->_changed.signal();
+      };
+    elle::SafeFinally done([&] {
+        queue(false);
+        if (waiting)
+          prometheus::decrement(queue_depth(priority));
+      });
+    while (true)
+    {
+      auto const procedure_full =
+        this->_procedure_capacity && procedure >= this->_procedure_capacity;
+      queue(!procedure_full);
+      auto const before = std::accumulate(
+        this->_waiting.begin(), this->_waiting.begin() + p, 0);
+      if (!procedure_full && before == 0 &&
+          (!this->_capacity || this->_running < this->_capacity))
+        break;
+      if (!waiting)
+      {
+        ELLE_DEBUG("wait for a slot to serve %s", name);
+        waiting = true;
+        prometheus::increment(queue_depth(priority));
+      }
+      elle::reactor::wait(this->_changed);
+    }
+    ++this->_running;
+    ++procedure;
+    _current.get() = Slot{this, name, priority};
+  }
+
+  void
+  RPCAdmission::release(std::string const& name)
+  {
+    --this->_running;
+    --this->_procedures[name];
+    _current.get().reset();
+    this->_changed.signal();
+  }
+
+  bool
+  RPCAdmission::admitted()
+  {
+    return bool(_current.get());
+  }
+
+  void
+  RPCAdmission::suspend(std::function<void ()> const& action)
+  {
+    auto const slot = _current.get();
+    if (!slot)
+      return action();
+    ELLE_DEBUG("suspend %s", slot->name);
+    slot->admission->release(slot->name);
+    action();
+    slot->admission->acquire(slot->name, slot->priority);
+  }
+
+  elle::reactor::LocalStorage<boost::optional<RPCAdmission::Slot>>
+  RPCAdmission::_current;
+
+  /*------------.
+  | Procedure id |
+  `------------*/
+
+  uint32_t
+  rpc_id(std::string const& name)
+  {
+    // FNV-1a: stable across builds and platforms, unlike std::hash.
+    auto res = uint32_t(2166136261u);
+    for (auto c: name)
+    {
+      res ^= uint8_t(c);
+      res *= 16777619u;
+    }
+    return res;
+  }
+
+  bool
+  rpc_compact(elle::Version const& version)
+  {
+    return version >= elle::Version(0, 10, 0);
+  }
+
+  bool
+  BaseRPC::compact() const
+  {
+    return rpc_compact(this->_version);
+  }
+
+  elle::Buffer
+  BaseRPC::_exchange(elle::Buffer request)
+  {
+    auto channel = elle::protocol::Channel{*ELLE_ENFORCE(this->_channels)};
+    if (this->_key)
+    {
+      static auto bench =
+        elle::Bench<>{"bench.rpcclient.encipher", 10000s};
+      auto bs = bench.scoped();
+      ELLE_DEBUG("encipher request")
+        request = CryptoPool::instance().encipher(*this->_key, request);
+    }
+    ELLE_DEBUG("send request")
+      channel.write(request);
+    ELLE_DEBUG("read response request")
+    {
+      auto response = channel.read();
+      if (this->_key)
+      {
+        static auto bench
+          = elle::Bench<>{"bench.rpcclient.decipher", 10000s};
+        auto bs = bench.scoped();
+        response = CryptoPool::instance().decipher(*this->_key, response);
+      }
+      return response;
+    }
+  }
+
+  /*------.
+  | Batch |
+  `------*/
+
+  std::string const&
+  rpc_batch()
+  {
+    static auto const res = std::string("batch");
+    return res;
+  }
+
+  RPCBatch::RPCBatch(elle::protocol::ChanneledStream& channels,
+                     elle::Version const& version,
+                     boost::optional<elle::cryptography::SecretKey> key)
+    : _channels(channels)
+    , _version(version)
+    , _key(std::move(key))
+  {}
+
+  void
+  RPCBatch::send()
+  {
+    auto entries = std::move(this->_entries);
+    this->_entries.clear();
+    if (entries.empty())
+      return;
+    ELLE_TRACE_SCOPE("send batch of %s calls", entries.size());
+    auto const versions = elle::serialization::get_serialization_versions
+      <memo::serialization_tag>(this->_version);
+    if (rpc_compact(this->_version))
+    {
+      auto requests = std::vector<elle::Buffer>{};
+      for (auto& entry: entries)
+        requests.emplace_back(std::move(entry->request));
+      auto frame = elle::Buffer{};
+      {
+        elle::IOStream outs(frame.ostreambuf());
+        auto output = elle::serialization::binary::SerializerOut(
+          outs, versions, false);
+        output.serialize("procedure", rpc_batch());
+        output.serialize("requests", requests);
+      }
+      BaseRPC rpc(rpc_batch(), &this->_channels, this->_version, this->_key);
+      auto response = rpc._exchange(std::move(frame));
+      auto ins = elle::IOStream(response.istreambuf());
+      auto input =
+        elle::serialization::binary::SerializerIn(ins, versions, false);
+      if (!input.deserialize<bool>("success"))
+        std::rethrow_exception(
+          input.deserialize<std::exception_ptr>("exception"));
+      auto responses =
+        input.deserialize<std::vector<elle::Buffer>>("responses");
+      if (responses.size() != entries.size())
+        elle::err("batch of %s calls got %s responses",
+                  entries.size(), responses.size());
+      for (auto i = 0u; i < entries.size(); ++i)
+      {
+        entries[i]->response = std::move(responses[i]);
+        entries[i]->done = true;
+      }
+    }
+    else
+      for (auto& entry: entries)
+      {
+        BaseRPC rpc(entry->name, &this->_channels, this->_version, this->_key);
+        entry->response = rpc._exchange(std::move(entry->request));
+        entry->done = true;
+      }
+  }
+
+  std::size_t
+  RPCBatch::size() const
+  {
+    return this->_entries.size();
+  }
+
   namespace
   {
     auto const _register_serialization =
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <array>
+#include <functional>
+#include <unordered_map>
+
 #include <elle/serialization/json.hh>
 #include <elle/serialization/binary.hh>
 #include <elle/os/environ.hh>
+#include <elle/finally.hh>
 #include <elle/log.hh>
 #include <elle/bench.hh>
 
@@ -12,11 +17,13 @@
 #include <elle/reactor/network/socket.hh>
 #include <elle/reactor/Scope.hh>
 #include <elle/reactor/semaphore.hh>
+#include <elle/reactor/signal.hh>
 #include <elle/reactor/storage.hh>
 
 #include <elle/protocol/ChanneledStream.hh>
 #include <elle/protocol/Serializer.hh>
 
+#include <memo/CryptoPool.hh>
 #include <memo/environ.hh>
 #include <memo/model/doughnut/Passport.hh>
 
@@ -71,6 +78,35 @@ namespace memo
     ELLE_ATTRIBUTE_R(std::string, name);
   };
 
+  /// The compact identifier of procedure @a name.
+  ///
+  /// Sent instead of the procedure name on networks with compatibility
+  /// version 0.10.0 or later.
+  uint32_t
+  rpc_id(std::string const& name);
+
+  /// Whether calls on networks with compatibility version @a version send
+  /// procedure ids and take batches.
+  bool
+  rpc_compact(elle::Version const& version);
+
+  /// The procedure name of call batches.
+  ///
+  /// @see RPCBatch, rpc_compact.
+  std::string const&
+  rpc_batch();
+
+  /// The serialization name of argument @a N.
+  ///
+  /// Binary serialization ignores them, build them once.
+  template <int N>
+  std::string const&
+  rpc_argument()
+  {
+    static auto const res = elle::sprintf("arg%s", N);
+    return res;
+  }
+
   /*-------.
   | Server |
   `-------*/
@@ -143,53 +179,50 @@ namespace memo
     handle(elle::serialization::SerializerIn& input,
            elle::serialization::SerializerOut& output) override
     {
-      this->_handle<List<Args...>>(0, input, output);
+      this->_handle<List<Args...>, 0>(input, output);
     }
 
   private:
-    template <typename Remaining, typename ... Parsed>
+    template <typename Remaining, int N, typename ... Parsed>
     std::enable_if_t<
       !Remaining::empty &&
       !elle::serialization::virtually<
         std::remove_reference_t<typename Remaining::Head>>()>
-    _handle(int n,
-            elle::serialization::SerializerIn& input,
+    _handle(elle::serialization::SerializerIn& input,
             elle::serialization::SerializerOut& output,
             Parsed&& ... parsed)
     {
       ELLE_LOG_COMPONENT("memo.RPC");
       using Head = std::remove_cv_reference_t<typename Remaining::Head>;
-      auto arg = input.deserialize<Head>(elle::sprintf("arg%s", n));
+      auto arg = input.deserialize<Head>(rpc_argument<N>());
       ELLE_DUMP("got argument: %s", arg);
-      this->_handle<typename Remaining::Tail,
+      this->_handle<typename Remaining::Tail, N + 1,
                     Parsed..., typename Remaining::Head>(
-        n + 1, input, output, std::forward<Parsed>(parsed)..., std::move(arg));
+        input, output, std::forward<Parsed>(parsed)..., std::move(arg));
     }
 
-    template <typename Remaining, typename ... Parsed>
+    template <typename Remaining, int N, typename ... Parsed>
     std::enable_if_t<
       !Remaining::empty &&
       elle::serialization::virtually<
         std::remove_reference_t<typename Remaining::Head>>()>
-    _handle(int n,
-            elle::serialization::SerializerIn& input,
+    _handle(elle::serialization::SerializerIn& input,
             elle::serialization::SerializerOut& output,
             Parsed&& ... parsed)
     {
       ELLE_LOG_COMPONENT("memo.RPC");
       using Head = std::remove_cv_reference_t<typename Remaining::Head>;
       auto arg =
-        input.deserialize<std::unique_ptr<Head>>(elle::sprintf("arg%s", n));
+        input.deserialize<std::unique_ptr<Head>>(rpc_argument<N>());
       ELLE_DUMP("got argument: %s", *arg);
-      this->_handle<typename Remaining::Tail,
+      this->_handle<typename Remaining::Tail, N + 1,
                     Parsed..., typename Remaining::Head>(
-        n + 1, input, output, std::forward<Parsed>(parsed)..., std::move(*arg));
+        input, output, std::forward<Parsed>(parsed)..., std::move(*arg));
     }
 
-    template <typename Remaining, typename ... Parsed>
+    template <typename Remaining, int N, typename ... Parsed>
     std::enable_if_t<Remaining::empty && std::is_void<R>::value>
-    _handle(int n,
-            elle::serialization::SerializerIn& input,
+    _handle(elle::serialization::SerializerIn& input,
             elle::serialization::SerializerOut& output,
             Parsed&& ... parsed)
     {
@@ -217,10 +250,9 @@ namespace memo
       }
     }
 
-    template <typename Remaining, typename ... Parsed>
+    template <typename Remaining, int N, typename ... Parsed>
     std::enable_if_t<Remaining::empty && !std::is_void<R>::value>
-    _handle(int n,
-            elle::serialization::SerializerIn& input,
+    _handle(elle::serialization::SerializerIn& input,
             elle::serialization::SerializerOut& output,
             Parsed&& ... parsed)
     {
@@ -249,6 +281,68 @@ namespace memo
     }
   };
 
+  /*-----------.
+  | Admission  |
+  `-----------*/
+
+  /// Which waiting requests are served first when a connection is busy.
+  enum class RPCPriority
+  {
+    /// Consensus rounds, on which writes and reads of other peers wait.
+    consensus,
+    normal,
+    /// Background transfers, such as rebalancing.
+    bulk,
+  };
+
+  std::ostream&
+  operator <<(std::ostream& output, RPCPriority priority);
+
+  /// Bound the requests served concurrently on a connection, overall and
+  /// per procedure.
+  ///
+  /// Requests waiting for a slot are admitted by priority, then in order.
+  class RPCAdmission
+  {
+  public:
+    /// @param capacity  Requests served at once, 0 for no limit.
+    /// @param procedure_capacity  Requests to a same procedure served at
+    ///                            once, 0 for no limit.
+    RPCAdmission(int capacity, int procedure_capacity);
+    /// Wait for a slot to serve procedure @a name.
+    void
+    acquire(std::string const& name, RPCPriority priority);
+    /// Free the slot of procedure @a name.
+    void
+    release(std::string const& name);
+    /// Whether the current thread holds a slot.
+    static
+    bool
+    admitted();
+    /// Free the slot of the current thread while running @a action, such
+    /// as waiting on other peers, then wait for a slot again.
+    static
+    void
+    suspend(std::function<void ()> const& action);
+    ELLE_ATTRIBUTE_R(int, capacity);
+    ELLE_ATTRIBUTE_R(int, procedure_capacity);
+    ELLE_ATTRIBUTE_R(int, running);
+  private:
+    struct Slot
+    {
+      RPCAdmission* admission;
+      std::string name;
+      RPCPriority priority;
+    };
+    /// The slot held by each thread.
+    static elle::reactor::LocalStorage<boost::optional<Slot>> _current;
+    /// Requests being served, per procedure.
+    ELLE_ATTRIBUTE((std::unordered_map<std::string, int>), procedures);
+    /// Requests waiting for a connection slot, per priority.
+    ELLE_ATTRIBUTE((std::array<int, 3>), waiting);
+    ELLE_ATTRIBUTE(elle::reactor::Signal, changed);
+  };
+
   /// Answer to RPCs.
   class RPCServer
   {
@@ -273,8 +367,12 @@ namespace memo
     void
     add(std::string const& name, std::function<R (Args...)> f)
     {
-      this->_rpcs[name] =
-        std::make_unique<ConcreteRPCHandler<R, Args...>>(name, f);
+      auto handler = std::make_unique<ConcreteRPCHandler<R, Args...>>(name, f);
+      auto& by_id = this->_ids[rpc_id(name)];
+      if (by_id && by_id->name() != name)
+        elle::err("RPC %s has the same id as %s", name, by_id->name());
+      by_id = handler.get();
+      this->_rpcs[name] = std::move(handler);
     }
 
     /// Add an RPC to the server.
@@ -289,6 +387,21 @@ namespace memo
       add(name, std::function<std::get_signature<Fun>>(fun));
     }
 
+    /// Set the priority of the RPC named @a name, normal by default.
+    void
+    priority(std::string const& name, RPCPriority priority)
+    {
+      this->_priorities[name] = priority;
+    }
+
+    /// The priority of the RPC named @a name.
+    RPCPriority
+    priority(std::string const& name) const
+    {
+      auto it = this->_priorities.find(name);
+      return it == this->_priorities.end() ? RPCPriority::normal : it->second;
+    }
+
     /// An umbrella to cover common exceptions related to RPCs, such as
     /// closed sockets, etc.
     ///
@@ -364,38 +477,54 @@ namespace memo
     }
 
     /// Start serving RPCs on the given ChanneledStream.
+    ///
+    /// Up to $MEMO_RPC_SERVE_THREADS requests (0 for no limit) are served
+    /// concurrently, and up to $MEMO_RPC_SERVE_PROCEDURE_THREADS of a same
+    /// procedure, so that slow procedures do not hold up cheap ones.  At
+    /// most $MEMO_RPC_SERVE_QUEUE requests wait for a slot.
     void
     _serve(elle::protocol::ChanneledStream& channels)
     {
       ELLE_LOG_COMPONENT("memo.RPC");
-      auto nthreads = memo::getenv("RPC_SERVE_THREADS", 1);
-      elle::reactor::Semaphore sem(nthreads? nthreads+1 : 1000000000);
+      auto const nthreads = memo::getenv("RPC_SERVE_THREADS", 16);
+      if (nthreads == 1)
+      {
+        // Serve requests one at a time, in order.
+        while (true)
+        {
+          auto channel = channels.accept();
+          this->_serve(channel);
+        }
+      }
+      RPCAdmission admission(
+        nthreads, memo::getenv("RPC_SERVE_PROCEDURE_THREADS", 12));
+      auto const queue = memo::getenv("RPC_SERVE_QUEUE", 256);
+      elle::reactor::Semaphore sem(
+        nthreads ? nthreads + queue + 1 : 1000000000);
       elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& s)
       {
         while (true)
         {
           elle::reactor::Lock l(sem);
           auto channel = channels.accept();
-          if (nthreads == 1)
-            this->_serve(channel);
-          else
-          {
-            auto schannel = std::make_shared<decltype(channel)>(
-              std::move(channel));
-            s.run_background(elle::sprintf("serve %s", *schannel),
-              [&, schannel]
-              {
-                elle::reactor::Lock l(sem);
-                this->_serve(*schannel);
-              });
-          }
+          auto schannel = std::make_shared<decltype(channel)>(
+            std::move(channel));
+          s.run_background(elle::sprintf("serve %s", *schannel),
+            [&, schannel]
+            {
+              elle::reactor::Lock l(sem);
+              this->_serve(*schannel, &admission);
+            });
         }
       };
     }
 
     /// Start serving RPCs on a specific channel.
+    ///
+    /// @param admission Where to wait for a slot, if bounded.
     void
-    _serve(elle::protocol::Channel& channel)
+    _serve(elle::protocol::Channel& channel,
+           RPCAdmission* admission = nullptr)
     {
       ELLE_LOG_COMPONENT("memo.RPC");
       auto request = channel.read();
@@ -409,17 +538,7 @@ namespace memo
           static auto bench = elle::Bench<>{"bench.rpcserve.decipher",
                                             10000s};
           auto bs = bench.scoped();
-          if (request.size() > 262144)
-          {
-            auto& key = this->_key.get();
-            elle::With<elle::reactor::Thread::NonInterruptible>() << [&] {
-              elle::reactor::background([&] {
-                  request = key.decipher(request);
-              });
-            };
-          }
-          else
-            request = this->_key->decipher(request);
+          request = CryptoPool::instance().decipher(*this->_key, request);
         }
         catch(std::exception const& e)
         {
@@ -427,6 +546,24 @@ namespace memo
           throw;
         }
       }
+      auto response = this->_dispatch(request, admission);
+      if (had_key)
+      {
+        static auto bench =
+          elle::Bench<>{"bench.rpcserve.encipher", 10000s};
+        auto bs = bench.scoped();
+        response = CryptoPool::instance().encipher(*this->_key, response);
+      }
+      channel.write(response);
+    }
+
+    /// Run the call serialized in @a request.
+    ///
+    /// @return The serialized response.
+    elle::Buffer
+    _dispatch(elle::Buffer& request, RPCAdmission* admission)
+    {
+      ELLE_LOG_COMPONENT("memo.RPC");
       elle::IOStream ins(request.istreambuf());
       auto const versions = elle::serialization::get_serialization_versions
         <memo::serialization_tag>(this->_version);
@@ -434,13 +571,34 @@ namespace memo
       input.set_context(this->_context);
       std::string name;
       input.serialize("procedure", name);
-      elle::Buffer response;
+      auto handler = static_cast<RPCHandler*>(nullptr);
+      if (name.empty())
+      {
+        // Newer peers send the procedure id.
+        auto const id = input.deserialize<uint32_t>("id");
+        auto it = this->_ids.find(id);
+        if (it != this->_ids.end())
+        {
+          handler = it->second;
+          name = handler->name();
+        }
+        else
+          name = elle::sprintf("#%x", id);
+      }
+      else
       {
         auto it = this->_rpcs.find(name);
+        if (it != this->_rpcs.end())
+          handler = it->second.get();
+      }
+      elle::Buffer response;
+      {
         elle::IOStream outs(response.ostreambuf());
         auto output = elle::serialization::binary::SerializerOut(
           outs, versions, false);
-        if (it == this->_rpcs.end())
+        if (!handler && name == rpc_batch())
+          this->_dispatch_batch(input, output, admission);
+        else if (!handler)
         {
           ELLE_WARN("%s: unknown RPC: %s", *this, name);
           output.serialize("success", false);
@@ -450,11 +608,18 @@ namespace memo
         else
         {
           ELLE_TRACE_SCOPE("%s: run procedure %s", *this, name);
+          if (admission)
+            admission->acquire(name, this->priority(name));
+          elle::SafeFinally release([&] {
+              // The slot may have been given up while suspended.
+              if (admission && RPCAdmission::admitted())
+                admission->release(name);
+            });
           {
             output.set_context(this->_context);
             try
             {
-              it->second->handle(input, output);
+              handler->handle(input, output);
             }
             catch (elle::Error const& e)
             {
@@ -465,27 +630,32 @@ namespace memo
           }
         }
       }
-      if (had_key)
+      return response;
+    }
+
+    /// Run the calls of a batch concurrently.
+    void
+    _dispatch_batch(elle::serialization::SerializerIn& input,
+                    elle::serialization::SerializerOut& output,
+                    RPCAdmission* admission)
+    {
+      ELLE_LOG_COMPONENT("memo.RPC");
+      auto requests = input.deserialize<std::vector<elle::Buffer>>("requests");
+      ELLE_TRACE_SCOPE("%s: run batch of %s calls", *this, requests.size());
+      auto responses = std::vector<elle::Buffer>(requests.size());
+      elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& s)
       {
-        static auto bench =
-          elle::Bench<>{"bench.rpcserve.encipher", 10000s};
-        auto bs = bench.scoped();
-        if (response.size() >= 262144)
-        {
-          auto& key = this->_key.get();
-          elle::With<elle::reactor::Thread::NonInterruptible>() << [&] {
-            elle::reactor::background([&] {
-                response = key.encipher(
-	          elle::ConstWeakBuffer(response.contents(),
-	            response.size()));
-              });
-          };
-        }
-        else
-          response = _key->encipher(
-            elle::ConstWeakBuffer(response.contents(), response.size()));
-      }
-      channel.write(response);
+        for (auto i = 0u; i < requests.size(); ++i)
+          s.run_background(
+            elle::sprintf("batch call %s", i),
+            [&, i]
+            {
+              responses[i] = this->_dispatch(requests[i], admission);
+            });
+        elle::reactor::wait(s);
+      };
+      output.serialize("success", true);
+      output.serialize("responses", responses);
     }
 
     /// Upsert a value of type `T` to the context.
@@ -500,6 +670,9 @@ namespace memo
     }
 
     std::unordered_map<std::string, std::unique_ptr<RPCHandler>> _rpcs;
+    /// Handlers by procedure id.
+    std::unordered_map<uint32_t, RPCHandler*> _ids;
+    std::unordered_map<std::string, RPCPriority> _priorities;
     elle::serialization::Context _context;
     boost::optional<elle::cryptography::SecretKey> _key;
     boost::signals2::signal<void()> _destroying;
@@ -528,11 +701,20 @@ namespace memo
             elle::Version const& version,
             boost::optional<elle::cryptography::SecretKey> key = {})
       : _name(std::move(name))
+      , _id(rpc_id(this->_name))
       , _channels(channels)
       , _key(std::move(key))
       , _version(version)
     {}
 
+    /// Whether the peer takes procedure ids instead of names.
+    bool
+    compact() const;
+    /// Send the serialized @a request and return the serialized response,
+    /// ciphering both with the key if any.
+    elle::Buffer
+    _exchange(elle::Buffer request);
+
     /// Return the credentials, if applicable.
     ///
     /// @returns A buffer, empty or containing a secret key.
@@ -561,6 +743,7 @@ namespace memo
 
     elle::serialization::Context _context;
     ELLE_ATTRIBUTE_R(std::string, name);
+    ELLE_ATTRIBUTE_R(uint32_t, id);
     ELLE_ATTRIBUTE_R(elle::protocol::ChanneledStream*, channels, protected);
     ELLE_ATTRIBUTE_RX(
       boost::optional<elle::cryptography::SecretKey>, key, protected);
@@ -633,37 +816,36 @@ namespace memo
   template <typename R, typename ... Args>
   struct RPCCall<R (Args...)>
   {
-    template <typename Head, typename ... Tail>
+    template <int N, typename Head, typename ... Tail>
     static
     std::enable_if_t<
       elle::serialization::virtually<std::remove_cv_reference_t<Head>>()>
-    call_arguments(int n,
-                   elle::serialization::SerializerOut& output,
+    call_arguments(elle::serialization::SerializerOut& output,
                    Head&& head,
                    Tail&& ... tail)
     {
       using RawHead = std::remove_cv_reference_t<Head>;
       RawHead* ptr = const_cast<RawHead*>(&head);
-      output.serialize(elle::sprintf("arg%s", n), ptr);
-      call_arguments(n + 1, output, std::forward<Tail>(tail)...);
+      output.serialize(rpc_argument<N>(), ptr);
+      call_arguments<N + 1>(output, std::forward<Tail>(tail)...);
     }
 
-    template <typename Head, typename ... Tail>
+    template <int N, typename Head, typename ... Tail>
     static
     std::enable_if_t<
       !elle::serialization::virtually<std::remove_reference_t<Head>>()>
-    call_arguments(int n,
-                   elle::serialization::SerializerOut& output,
+    call_arguments(elle::serialization::SerializerOut& output,
                    Head&& head,
                    Tail&& ... tail)
     {
-      output.serialize(elle::sprintf("arg%s", n), head);
-      call_arguments(n + 1, output, std::forward<Tail>(tail)...);
+      output.serialize(rpc_argument<N>(), head);
+      call_arguments<N + 1>(output, std::forward<Tail>(tail)...);
     }
 
+    template <int N>
     static
     void
-    call_arguments(int, elle::serialization::SerializerOut&)
+    call_arguments(elle::serialization::SerializerOut&)
     {}
 
     template <typename Res>
@@ -693,82 +875,154 @@ namespace memo
     _call(elle::Version const& version,
           RPC<R (Args...)>& self,
           Args const&... args)
+    {
+      return _send(version, self, self.compact(), args...);
+    }
+
+    static
+    R
+    _send(elle::Version const& version,
+          RPC<R (Args...)>& self,
+          bool compact,
+          Args const&... args)
     {
       ELLE_LOG_COMPONENT("memo.RPC");
       ELLE_TRACE_SCOPE("%s: call", self);
+      auto response =
+        self._exchange(_request(version, self, compact, args...));
+      return _response(version, self, response);
+    }
+
+    /// The serialized call of @a self with @a args.
+    static
+    elle::Buffer
+    _request(elle::Version const& version,
+             RPC<R (Args...)>& self,
+             bool compact,
+             Args const&... args)
+    {
+      ELLE_LOG_COMPONENT("memo.RPC");
       auto versions = elle::serialization::get_serialization_versions
         <memo::serialization_tag>(version);
-      auto channel = elle::protocol::Channel{*ELLE_ENFORCE(self.channels())};
+      elle::Buffer call;
+      elle::IOStream outs(call.ostreambuf());
+      ELLE_DEBUG("build request")
       {
-        elle::Buffer call;
-        elle::IOStream outs(call.ostreambuf());
-
-        ELLE_DEBUG("build request")
+        auto output = elle::serialization::binary::SerializerOut(outs, versions, false);
+        output.set_context(self._context);
+        if (compact)
         {
-          auto output = elle::serialization::binary::SerializerOut(outs, versions, false);
-          output.set_context(self._context);
-          output.serialize("procedure", self.name());
-          call_arguments(0, output, args...);
+          auto id = self.id();
+          output.serialize("procedure", std::string());
+          output.serialize("id", id);
         }
-        outs.flush();
-        if (self.key())
-        {
-          static auto bench =
-            elle::Bench<>{"bench.rpcclient.encipher", 10000s};
-          auto bs = bench.scoped();
-          // FIXME: scheduler::run?
-          ELLE_DEBUG("encipher request")
-            if (call.size() > 262144)
-            {
-              elle::With<elle::reactor::Thread::NonInterruptible>() << [&] {
-                elle::reactor::background([&] {
-                    call = self.key()->encipher(
-                      elle::ConstWeakBuffer(call.contents(), call.size()));
-                  });
-              };
-            }
-            else
-              call = self.key()->encipher(
-                elle::ConstWeakBuffer(call.contents(), call.size()));
-        }
-        ELLE_DEBUG("send request")
-          channel.write(call);
+        else
+          output.serialize("procedure", self.name());
+        call_arguments<0>(output, args...);
+      }
+      outs.flush();
+      return call;
+    }
+
+    /// The result of @a self from its serialized @a response.
+    static
+    R
+    _response(elle::Version const& version,
+              RPC<R (Args...)>& self,
+              elle::Buffer& response)
+    {
+      ELLE_LOG_COMPONENT("memo.RPC");
+      auto versions = elle::serialization::get_serialization_versions
+        <memo::serialization_tag>(version);
+      auto ins = elle::IOStream(response.istreambuf());
+      auto input
+        = elle::serialization::binary::SerializerIn(ins, versions, false);
+      input.set_context(self._context);
+      if (input.deserialize<bool>("success"))
+        return get_result<R>(input);
+      else
+      {
+        ELLE_TRACE_SCOPE("call failed, get exception");
+        auto e = input.deserialize<std::exception_ptr>("exception");
+        std::rethrow_exception(e);
       }
-      ELLE_DEBUG("read response request")
+    }
+  };
+
+  /// Calls to a peer sent in a single round trip.
+  ///
+  /// Queue calls with `call`, send them all with `send`, then get each
+  /// result, or rethrow its exception, from the returned handles.  The
+  /// server runs the calls concurrently.  On networks older than batches,
+  /// calls are sent one after the other.
+  ///
+  /// Calls are sent on the batch channels with its key, the RPCs only
+  /// provide their procedure and serialization context and must outlive
+  /// the batch.
+  class RPCBatch
+  {
+  private:
+    struct Entry
+    {
+      std::string name;
+      elle::Buffer request;
+      elle::Buffer response;
+      bool done = false;
+    };
+
+  public:
+    /// The result of a batched call.
+    template <typename R>
+    class Result
+    {
+    public:
+      /// The result of the call, once the batch is sent.
+      R
+      get()
       {
-        auto response = channel.read();
-        if (self.key())
-        {
-          static auto bench
-            = elle::Bench<>{"bench.rpcclient.decipher", 10000s};
-          auto bs = bench.scoped();
-          if (response.size() > 262144)
-          {
-            elle::With<elle::reactor::Thread::NonInterruptible>() << [&] {
-              elle::reactor::background([&] {
-                  response = self.key()->decipher(
-                    elle::ConstWeakBuffer(response.contents(), response.size()));
-              });
-            };
-          }
-          else
-            response = self.key()->decipher(
-              elle::ConstWeakBuffer(response.contents(), response.size()));
-        }
-        auto ins = elle::IOStream(response.istreambuf());
-        auto input
-          = elle::serialization::binary::SerializerIn(ins, versions, false);
-        input.set_context(self._context);
-        if (input.deserialize<bool>("success"))
-          return get_result<R>(input);
-        else
-        {
-          ELLE_TRACE_SCOPE("call failed, get exception");
-          auto e = input.deserialize<std::exception_ptr>("exception");
-          std::rethrow_exception(e);
-        }
+        if (!this->_entry->done)
+          elle::err("%s: batch not sent", this->_entry->name);
+        return this->_decode(this->_entry->response);
       }
+
+    private:
+      friend class RPCBatch;
+      std::shared_ptr<Entry> _entry;
+      std::function<R (elle::Buffer&)> _decode;
+    };
+
+    RPCBatch(elle::protocol::ChanneledStream& channels,
+             elle::Version const& version,
+             boost::optional<elle::cryptography::SecretKey> key = {});
+    /// Queue a call of @a rpc with @a args.
+    template <typename R, typename ... Args>
+    Result<R>
+    call(RPC<R (Args...)>& rpc, Args const& ... args)
+    {
+      auto const version = this->_version;
+      auto entry = std::make_shared<Entry>();
+      entry->name = rpc.name();
+      entry->request = RPCCall<R (Args...)>::_request(
+        version, rpc, rpc_compact(version), args...);
+      this->_entries.emplace_back(entry);
+      auto res = Result<R>{};
+      res._entry = std::move(entry);
+      res._decode = [&rpc, version] (elle::Buffer& response)
+        {
+          return RPCCall<R (Args...)>::_response(version, rpc, response);
+        };
+      return res;
     }
+    /// Send the queued calls and wait for their responses.
+    void
+    send();
+    /// Number of calls queued.
+    std::size_t
+    size() const;
+    ELLE_ATTRIBUTE(elle::protocol::ChanneledStream&, channels);
+    ELLE_ATTRIBUTE(elle::Version, version);
+    ELLE_ATTRIBUTE(boost::optional<elle::cryptography::SecretKey>, key);
+    ELLE_ATTRIBUTE(std::vector<std::shared_ptr<Entry>>, entries);
   };
 
   std::ostream&
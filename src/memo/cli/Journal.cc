@@ -6,6 +6,7 @@
 #include <memo/cli/Memo.hh>
 #include <memo/model/doughnut/ACB.hh>
 #include <memo/model/doughnut/Async.hh>
+#include <memo/model/doughnut/Journal.hh>
 #include <memo/model/doughnut/OKB.hh>
 
 ELLE_LOG_COMPONENT("cli.journal");
@@ -19,6 +20,7 @@ namespace memo
     using Error = elle::das::cli::Error;
 
     using Async = memo::model::doughnut::consensus::Async;
+    using AsyncJournal = memo::model::doughnut::consensus::Journal;
 
     Journal::Journal(Memo& memo)
       : Object(memo)
@@ -42,13 +44,17 @@ namespace memo
     namespace
     {
       Async::Op
-      get_operation(memo::Memo& ifnt,
-                    memo::User const& owner,
+      get_operation(memo::User const& owner,
                     memo::Network& network,
-                    bfs::path const& path, std::string const& id)
+                    bfs::path const& root,
+                    AsyncJournal::Index const& index,
+                    int id)
       {
-        bfs::ifstream f;
-        ifnt._open_read(f, path, id, "operation");
+        auto it = index.find(id);
+        if (it == index.end())
+          elle::err<MissingLocalResource>("operation \"%s\" does not exist",
+                                          id);
+        auto data = AsyncJournal::read(root, id, it->second);
         auto dht = network.run(owner);
         auto ctx = elle::serialization::Context
           {
@@ -56,7 +62,8 @@ namespace memo
             memo::model::doughnut::ACBDontWaitForSignature{},
             memo::model::doughnut::OKBDontWaitForSignature{}
           };
-        return elle::serialization::binary::deserialize<Async::Op>(f, true, ctx);
+        return elle::serialization::binary::deserialize<Async::Op>(
+          data, true, ctx);
       }
     }
 
@@ -71,13 +78,13 @@ namespace memo
       auto network = memo.network_get(network_name, owner);
       auto dht = network.run(owner);
       bfs::path async_path = network.cache_dir(owner) / "async";
-      auto report = [&] (bfs::path const& path)
+      auto const index = AsyncJournal::scan(async_path);
+      auto report = [&] (int id)
         {
-          auto name = path.filename().string();
-          std::cout << name << ": ";
+          std::cout << id << ": ";
           try
           {
-            auto op = get_operation(memo, owner, network, path, name);
+            auto op = get_operation(owner, network, async_path, index, id);
             if (op.resolver)
               std::cout << op.resolver->description();
             else
@@ -90,10 +97,10 @@ namespace memo
           std::cout << std::endl;
         };
       if (operation)
-        report(async_path / elle::sprintf("%s", *operation));
+        report(*operation);
       else
-        for (auto const& path: Async::entries(async_path))
-          report(path);
+        for (auto const& entry: index)
+          report(entry.first);
     }
 
     /*---------------.
@@ -109,9 +116,9 @@ namespace memo
       auto& memo = cli.memo();
       auto owner = cli.as_user();
       auto network = memo.network_get(network_name, owner);
-      auto id = std::to_string(operation);
-      auto path = network.cache_dir(owner) / "async" / id;
-      auto op = get_operation(memo, owner, network, path, id);
+      auto const async_path = network.cache_dir(owner) / "async";
+      auto op = get_operation(owner, network, async_path,
+                              AsyncJournal::scan(async_path), operation);
       elle::serialization::json::serialize(op, std::cout);
     }
 
@@ -135,15 +142,11 @@ namespace memo
       for (auto const& network: networks)
       {
         bfs::path async_path = network.cache_dir(owner) / "async";
-        int operation_count = 0;
+        auto const index = AsyncJournal::scan(async_path);
+        int operation_count = index.size();
         int64_t data_size = 0;
-        if (bfs::exists(async_path))
-          for (auto const& p: bfs::directory_iterator(async_path))
-            if (is_visible_file(p))
-            {
-              operation_count++;
-              data_size += bfs::file_size(p);
-            }
+        for (auto const& entry: index)
+          data_size += entry.second.length;
         if (cli.script())
           res[network.name] = elle::json::Object
             {
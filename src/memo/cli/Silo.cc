@@ -11,6 +11,7 @@
 #include <memo/silo/Filesystem.hh>
 #include <memo/silo/GCS.hh>
 #include <memo/silo/GoogleDrive.hh>
+#include <memo/silo/Packfile.hh>
 #include <memo/silo/S3.hh>
 #ifndef ELLE_WINDOWS
 # include <memo/silo/sftp.hh>
@@ -69,6 +70,16 @@ namespace memo
                    cli::capacity = boost::none,
                    cli::output = boost::none,
                    cli::path = boost::none)
+      , packfile(*this,
+                 "Store blocks in append-only segment files",
+                 elle::das::cli::Options{
+                   {"path", elle::das::cli::Option{
+                       '\0', "directory where to store segments", false}}},
+                 cli::name,
+                 cli::description = boost::none,
+                 cli::capacity = boost::none,
+                 cli::output = boost::none,
+                 cli::path = boost::none)
       MEMO_ENTREPRISE(
       , gcs(*this,
             "Store blocks on Google Cloud Storage",
@@ -178,6 +189,33 @@ namespace memo
           std::move(description)));
     }
 
+    void
+    Silo::Create::mode_packfile(std::string const& name,
+                                boost::optional<std::string> description,
+                                boost::optional<std::string> capacity,
+                                boost::optional<std::string> output,
+                                boost::optional<std::string> root)
+    {
+      auto const path = root ? memo::canonical_folder(root.get())
+        : (memo::xdg_data_home() / "blocks" / name);
+      if (bfs::exists(path))
+      {
+        if (!bfs::is_directory(path))
+          elle::err("path is not directory: %s", path);
+        if (!bfs::is_empty(path))
+          std::cout << "WARNING: Path is not empty: " << path << '\n'
+                    << "WARNING: You may encounter unexpected behavior.\n";
+      }
+      mode_create(
+        this->cli(),
+        output,
+        std::make_unique<memo::silo::PackfileSiloConfig>(
+          name,
+          path.string(),
+          elle::convert_capacity(capacity),
+          std::move(description)));
+    }
+
     MEMO_ENTREPRISE(
     void
     Silo::Create::mode_gcs(std::string const& name,
@@ -37,6 +37,7 @@ namespace memo
                                  MEMO_ENTREPRISE(,cli::dropbox)
                                  MEMO_ENTREPRISE(,cli::gcs)
                                  MEMO_ENTREPRISE(,cli::google_drive)
+                                 ,cli::packfile
                                  MEMO_ENTREPRISE(,cli::s3)));
         Create(Memo& memo);
 
@@ -78,6 +79,22 @@ namespace memo
                         boost::optional<std::string> output,
                         boost::optional<std::string> path);
 
+        /// Packfile.
+        Mode<Create,
+             void (decltype(cli::name)::Formal<std::string const&>,
+                   decltype(cli::description = boost::optional<std::string>()),
+                   decltype(cli::capacity = boost::optional<std::string>()),
+                   decltype(cli::output = boost::optional<std::string>()),
+                   decltype(cli::path = boost::optional<std::string>())),
+             decltype(modes::mode_packfile)>
+        packfile;
+        void
+        mode_packfile(std::string const& name,
+                      boost::optional<std::string> description,
+                      boost::optional<std::string> capacity,
+                      boost::optional<std::string> output,
+                      boost::optional<std::string> path);
+
         MEMO_ENTREPRISE(
 
         /// GCS.
@@ -216,6 +216,7 @@ namespace memo
     ELLE_DAS_SYMBOL(login);
     ELLE_DAS_SYMBOL(manage_volumes);
     ELLE_DAS_SYMBOL(networking);
+    ELLE_DAS_SYMBOL(packfile);
     ELLE_DAS_SYMBOL(populate_hub);
     ELLE_DAS_SYMBOL(populate_network);
     ELLE_DAS_SYMBOL(run);
@@ -273,6 +274,7 @@ namespace memo
       ELLE_DAS_SYMBOL(mode_manage_volumes);
       ELLE_DAS_SYMBOL(mode_mount);
       ELLE_DAS_SYMBOL(mode_networking);
+      ELLE_DAS_SYMBOL(mode_packfile);
       ELLE_DAS_SYMBOL(mode_populate_hub);
       ELLE_DAS_SYMBOL(mode_populate_network);
       ELLE_DAS_SYMBOL(mode_pull);
@@ -21,10 +21,15 @@ namespace
     static auto const res = Vars
     {
 
+      {"ACB_KEY_CACHE_SIZE", "Bytes of unwrapped ACB keys kept in memory [4194304]"},
+      {"ASYNC_COALESCE_WINDOW", ""},
+      {"ASYNC_JOURNAL_SEGMENT_SIZE", ""},
+      {"ASYNC_JOURNAL_SYNC", ""},
       {"ASYNC_NOPOP", ""},
       {"ASYNC_POP_DELAY", ""},
       {"ASYNC_SQUASH", ""},
       {"BACKGROUND_DECODE", ""},
+      {"BACKGROUND_ENCODE", "Wrap ACB tokens on the CPU pool [true]"},
       {"BACKTRACE", ""},
       {"BALANCED_TRANSFERS", ""},
       {"BEYOND", ""},
@@ -46,8 +51,11 @@ namespace
       {"KELIPS_ASYNC", ""},
       {"KELIPS_ASYNC_SEND", ""},
       {"KELIPS_COMPRESSION", ""},
+      {"KELIPS_GOSSIP_BANDWIDTH", "Bytes per second gossip may send, 0 for unlimited [65536]"},
+      {"KELIPS_GOSSIP_MTU", "Largest gossip datagram in bytes [1200]"},
       {"KELIPS_SNUB", ""},
       {"KEY_HASH", ""},
+      {"KOUNCIL_SYNC_INTERVAL", "Seconds between address book reconciliations [60]"},
       {"KOUNCIL_WATCHER_INTERVAL", ""},
       {"KOUNCIL_WATCHER_MAX_RETRY", ""},
       {"LOG_DIR", "Where logs are stored [~/.cache/infinit/memo/logs]"},
@@ -57,8 +65,16 @@ namespace
       {"LOOKAHEAD_THREADS", ""},
       {"MAX_EMBED_SIZE", ""},
       {"MAX_SQUASH_SIZE", ""},
+      {"MULTIFETCH_BATCH_SIZE", ""},
+      {"MULTIFETCH_PARALLELISM", ""},
+      {"NEGATIVE_CACHE_SIZE", ""},
+      {"NEGATIVE_CACHE_TTL", ""},
+      {"PAXOS_BATCH_WINDOW", ""},
       {"PAXOS_CACHE_SIZE", ""},
       {"PAXOS_LENIENT_FETCH", ""},
+      {"PAXOS_REBALANCE_BANDWIDTH", "Bytes per second rebalancing may transfer [unlimited]"},
+      {"PAXOS_REBALANCE_OPERATIONS", "Blocks per second rebalancing may repair [100]"},
+      {"PAXOS_REBALANCE_PARALLELISM", "Blocks repaired concurrently [8]"},
       {"PREEMPT_DECODE", ""},
       {"PREFETCH_DEPTH", ""},
       {"PREFETCH_GROUP", ""},
@@ -66,12 +82,18 @@ namespace
       {"PREFETCH_THREADS", ""},
       {"PRESERVE_ACLS", ""},
       {"PROMETHEUS_ENDPOINT", ""},
+      {"PROMETHEUS_LATENCY_BUCKETS", ""},
       {"RDV", ""},
       {"RPC_CRYPTO", ""},
+      {"RPC_CRYPTO_THREADS", ""},
       {"RPC_DISABLE_CRYPTO", ""},
+      {"RPC_SERVE_PROCEDURE_THREADS", ""},
+      {"RPC_SERVE_QUEUE", ""},
       {"RPC_SERVE_THREADS", ""},
       {"RUNTIME_DIR", ""},
       {"SIGNAL_HANDLER", ""},
+      {"SIGNATURE_CACHE_SIZE", "Bytes of verified signatures kept in memory [1048576]"},
+      {"SILO_FILTER", "Build a filter of the stored keys in the background [false]"},
       {"SOFTFAIL_RUNNING", ""},
       {"SOFTFAIL_TIMEOUT", ""},
       {"STATE_HOME", ""},
@@ -103,6 +103,8 @@ namespace memo
         this->_method_names.push_back(std::make_unique<std::string>(route));
         int index = 0;
         this->_counters.push_back(prom::make(_call_f, {{"call", route}}));
+        this->_latencies.push_back(prom::make(_latency_f, {{"call", route}},
+                                              prom::latency_buckets()));
         index = this->_counters.size()-1;
 
         ::grpc::Service::AddMethod(
@@ -115,6 +117,7 @@ namespace memo
                 GRet* ret)
               {
                 increment(_counters[index]);
+                prom::Timer timer(_latencies[index]);
                 return invoke_named<NF, GArg, GRet, NoExcept>(
                   *this, sched, dht, nf, ctx, arg, ret);
               },
@@ -128,6 +131,12 @@ namespace memo
                                     "How many grpc calls are made");
       /// Call counters for methods.  One per method.
       std::vector<prom::CounterPtr> _counters;
+      /// Histogram family for method latencies.
+      prom::Family<prom::Histogram>* _latency_f
+        = prom::make_histogram_family("memo_grpc_latency_seconds",
+                                      "How long grpc calls take");
+      /// Latency histograms for methods.  One per method.
+      std::vector<prom::HistogramPtr> _latencies;
 
       /// Counter family for method results.
       prom::Family<prom::Counter>* _res_f
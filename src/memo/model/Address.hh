@@ -19,6 +19,8 @@ namespace memo
     {
       static const uint8_t mutable_block = 0;
       static const uint8_t immutable_block = 1;
+      /// Consensus metadata stored along a block, never listed.
+      static const uint8_t block_metadata = 0x80;
     }
 
     class Address
@@ -10,6 +10,7 @@
 #include <memo/utility.hh>
 
 #include <elle/reactor/cxa_get_globals.hh>
+#include <elle/reactor/for-each.hh>
 
 ELLE_LOG_COMPONENT("memo.model.Model");
 
@@ -295,6 +296,32 @@ namespace memo
       return this->_update(std::move(copy), std::move(resolver));
     }
 
+    void
+    Model::seal_and_insert(std::vector<blocks::Block*> const& batch)
+    {
+      ELLE_TRACE_SCOPE("%s: insert %s blocks", *this, batch.size());
+      // Each block waits for its own signatures while the others are
+      // sealed, so storing overlaps signing.
+      elle::reactor::for_each_parallel(
+        batch,
+        [&] (blocks::Block* block)
+        {
+          this->seal_and_insert(*block);
+        });
+    }
+
+    void
+    Model::seal_and_update(std::vector<blocks::Block*> const& batch)
+    {
+      ELLE_TRACE_SCOPE("%s: update %s blocks", *this, batch.size());
+      elle::reactor::for_each_parallel(
+        batch,
+        [&] (blocks::Block* block)
+        {
+          this->seal_and_update(*block);
+        });
+    }
+
     void
     Model::print(std::ostream& out) const
     {
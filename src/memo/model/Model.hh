@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 
@@ -236,6 +237,12 @@ namespace memo
       void
       seal_and_insert(blocks::Block& block,
                       std::unique_ptr<ConflictResolver> = {});
+      /// Seal and insert @a batch concurrently, waiting for all of them.
+      ///
+      /// Sealing runs on the CPU pool, so signing and wrapping keys for
+      /// many blocks is spread over all cores.
+      void
+      seal_and_insert(std::vector<blocks::Block*> const& batch);
       /// Update an existing block.
       ///
       /// @param block             Block to update.
@@ -250,6 +257,9 @@ namespace memo
       void
       seal_and_update(blocks::Block& block,
                       std::unique_ptr<ConflictResolver> = {});
+      /// Seal and update @a batch concurrently, waiting for all of them.
+      void
+      seal_and_update(std::vector<blocks::Block*> const& batch);
       /// Remove an existing block.
       elle::das::named::Function<
         void (
@@ -210,6 +210,33 @@ namespace memo
           target = use_encrypt ? k.decrypt(src, acb_padding) : k.open(src);
       }
 
+      /// Tokens to wrap a block secret for, and the keys to wrap it with.
+      using Tokens = std::vector<
+        std::pair<elle::Buffer*, elle::cryptography::rsa::PublicKey const*>>;
+
+      static
+      void
+      background_wrap(Tokens const& tokens,
+                      elle::Buffer const& secret,
+                      bool use_encrypt)
+      {
+        auto const wrap = [&]
+          {
+            for (auto const& t: tokens)
+              *t.first = use_encrypt ?
+                t.second->encrypt(secret, acb_padding) :
+                t.second->seal(secret);
+          };
+        static bool bg = memo::getenv("BACKGROUND_ENCODE", true);
+        if (bg)
+          elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+          {
+            elle::reactor::background(wrap);
+          };
+        else
+          wrap();
+      }
+
       template <typename Block>
       elle::Buffer
       BaseACB<Block>::_decrypt_data(elle::Buffer const& data) const
@@ -217,31 +244,53 @@ namespace memo
         if (this->world_readable())
           return this->_data;
         bool use_encrypt = this->_seal_version >= elle::Version(0, 7, 0);
-        elle::Buffer secret_buffer;
+        auto& cache = this->doughnut()->secret_cache();
+        auto const open = [&] (elle::Buffer const& token,
+                               elle::cryptography::rsa::PublicKey const& K,
+                               elle::cryptography::rsa::PrivateKey const& k)
+          {
+            return cache.secret(token, K, [&]
+              {
+                static auto bench = elle::Bench<>{"bench.acb.decrypt_2", 10000s};
+                auto bs = bench.scoped();
+                elle::Buffer secret_buffer;
+                background_open(secret_buffer, token, k, use_encrypt);
+                if (use_encrypt)
+                  return elle::cryptography::SecretKey(secret_buffer.string());
+                else
+                  return elle::serialization::json::deserialize
+                    <elle::cryptography::SecretKey>(secret_buffer);
+              });
+          };
+        auto secret = boost::optional<elle::cryptography::SecretKey>{};
         if (this->owner_private_key())
         {
           ELLE_DEBUG("%s: we are owner", *this);
-          background_open(secret_buffer, this->_owner_token,
-                          *this->owner_private_key(), use_encrypt);
+          secret = open(this->_owner_token,
+                        *this->owner_key(), *this->owner_private_key());
         }
         else if (!this->_acl_entries.empty())
         {
           // FIXME: factor searching the token
           for (auto const& e: this->_acl_entries)
             if (e.key == this->doughnut()->keys().K())
-              background_open(secret_buffer, e.token,
-                              this->doughnut()->keys().k(), use_encrypt);
+            {
+              secret = open(e.token, e.key, this->doughnut()->keys().k());
+              break;
+            }
         }
-        if (secret_buffer.empty())
+        if (!secret)
         {
           int idx = 0;
           for (auto const& e: this->_acl_group_entries)
           {
             try
             {
-              Group g(*this->doughnut(), e.key);
-              auto keys = g.group_keys();
               int v = this->_group_version[idx];
+              auto keys = cache.group_keys(e.key, v, [&]
+                {
+                  return Group(*this->doughnut(), e.key).group_keys();
+                });
               if (v >= signed(keys.size()))
               {
                 ELLE_DEBUG("announced version %s bigger than size %s",
@@ -249,7 +298,8 @@ namespace memo
                 ++idx;
                 continue;
               }
-              background_open(secret_buffer, e.token, keys[v].k(), use_encrypt);
+              secret = open(e.token, keys[v].K(), keys[v].k());
+              break;
             }
             catch (elle::Error const& e)
             {
@@ -258,20 +308,11 @@ namespace memo
             ++idx;
           }
         }
-        if (secret_buffer.empty())
+        if (!secret)
           // FIXME: better exceptions
           throw ValidationFailed("no read permissions");
-        static auto bench = elle::Bench<>{"bench.acb.decrypt_2", 10000s};
-        auto bs = bench.scoped();
-        auto secret = [&]() {
-          if (use_encrypt)
-            return elle::cryptography::SecretKey(secret_buffer.string());
-          else
-            return elle::serialization::json::deserialize
-               <elle::cryptography::SecretKey>(secret_buffer);
-        }();
-        ELLE_DUMP("%s: secret: %s", *this, secret);
-        return secret.decipher(this->_data);
+        ELLE_DUMP("%s: secret: %s", *this, *secret);
+        return secret->decipher(this->_data);
       }
 
       /*------------.
@@ -659,7 +700,8 @@ namespace memo
                   return blocks::ValidationResult::failure("group key out of range");
                 auto& key = pubkeys[key_index];
                 ELLE_DEBUG("validating with group key %s: %s", key_index, key);
-                if (!key.verify(this->data_signature(), *this->_data_sign()))
+                if (!this->doughnut()->signature_cache().verify(
+                      key, this->data_signature(), *this->_data_sign()))
                 {
                   ELLE_DEBUG("%s: group author signature invalid", *this);
                   return blocks::ValidationResult::failure("Invalid group key signature");
@@ -674,7 +716,8 @@ namespace memo
             else
             {
               auto& key = entry ? entry->key : *this->owner_key();
-              if (!key.verify(this->data_signature(), *this->_data_sign()))
+              if (!this->doughnut()->signature_cache().verify(
+                    key, this->data_signature(), *this->_data_sign()))
               {
                 ELLE_DEBUG("%s: author signature invalid", *this);
                 return blocks::ValidationResult::failure
@@ -851,14 +894,16 @@ namespace memo
             secret_buffer = key.get().password().string();
           this->_seal_version = seal_version;
           bool use_encrypt = seal_version >= elle::Version(0, 7, 0);
-          this->_owner_token = use_encrypt ?
-            this->owner_key()->encrypt(secret_buffer, acb_padding)
-            : this->owner_key()->seal(secret_buffer);
+          // Wrap all tokens at once, off the reactor thread, so sealing many
+          // blocks concurrently spreads over the CPU pool.
+          auto tokens = Tokens{{&this->_owner_token, this->owner_key().get()}};
+          auto group_keys = std::vector<elle::cryptography::rsa::PublicKey>{};
+          group_keys.reserve(this->_acl_group_entries.size());
           int idx = 0;
           for (auto& e: this->_acl_entries)
           {
             if (e.read)
-              e.token = use_encrypt ? e.key.encrypt(secret_buffer, acb_padding) : e.key.seal(secret_buffer);
+              tokens.emplace_back(&e.token, &e.key);
             if (!sign_key && e.key == this->doughnut()->keys().K())
             {
               ELLE_DEBUG("we are editor %s", idx);
@@ -874,9 +919,8 @@ namespace memo
               Group g(*this->doughnut(), e.key);
               if (e.read)
               {
-                e.token = use_encrypt ?
-                 g.current_public_key().encrypt(secret_buffer, acb_padding)
-                 : g.current_public_key().seal(secret_buffer);
+                group_keys.emplace_back(g.current_public_key());
+                tokens.emplace_back(&e.token, &group_keys.back());
                 this->_group_version[idx - this->_acl_entries.size()] =
                   g.version() - 1;
               }
@@ -901,6 +945,7 @@ namespace memo
             }
             ++idx;
           }
+          background_wrap(tokens, secret_buffer, use_encrypt);
           if (!sign_key && this->_world_writable)
           {
             ELLE_DEBUG("block is world writable");
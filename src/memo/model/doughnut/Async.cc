@@ -1,9 +1,8 @@
 #include <fstream>
 
 #include <boost/filesystem.hpp>
-#include <boost/filesystem/fstream.hpp>
-#include <boost/range/algorithm/sort.hpp>
 
+#include <elle/IOStream.hh>
 #include <elle/os/environ.hh>
 #include <elle/serialization/binary.hh>
 #include <elle/serialization/json.hh>
@@ -102,20 +101,6 @@ namespace memo
             this->_init_barrier.open();
         }
 
-        std::vector<fs::path>
-        Async::entries(fs::path const& root)
-        {
-          auto paths = std::vector<fs::path>
-            {fs::directory_iterator(root), fs::directory_iterator()};
-          boost::sort(paths,
-                    [] (fs::path const& a, fs::path const& b)
-                    {
-                      return std::stoi(a.filename().string()) <
-                        std::stoi(b.filename().string());
-                    });
-          return paths;
-        }
-
         void
         Async::_init()
         {
@@ -124,9 +109,27 @@ namespace memo
             });
           ELLE_TRACE_SCOPE("%s: restore journal from %s",
                            *this, this->_journal_dir);
-          for (auto const& p: Async::entries(_journal_dir))
+          try
+          {
+            this->_journal = std::make_unique<Journal>(
+              this->_journal_dir,
+              memo::getenv("ASYNC_JOURNAL_SEGMENT_SIZE", 64 * 1024 * 1024),
+              memo::getenv("ASYNC_JOURNAL_SYNC", true));
+          }
+          catch (elle::reactor::Terminate const&)
+          {
+            throw;
+          }
+          catch (std::exception const& e)
+          {
+            ELLE_ERR("%s: unable to open journal %s: %s",
+                     *this, this->_journal_dir, e.what());
+            this->_journal_error = std::current_exception();
+            return;
+          }
+          for (auto const& entry: this->_journal->index())
           {
-            auto id = std::stoi(p.filename().string());
+            auto id = entry.first;
             Op op;
             try
             {
@@ -193,7 +196,7 @@ namespace memo
         void
         Async::_load_operations()
         {
-          if (this->_journal_dir.empty())
+          if (!this->_journal)
             return;
           for (auto it = this->_operations.get<1>().find(
                  this->_first_disk_index.get());
@@ -232,9 +235,9 @@ namespace memo
         }
 
         Async::Op
-        Async::_load_op(fs::path const& p, bool signature)
+        Async::_load_op(elle::Buffer const& data, bool signature)
         {
-          fs::ifstream is(p, std::ios::binary);
+          elle::IOStream is(data.istreambuf());
           elle::serialization::binary::SerializerIn sin(is);
           sin.set_context<Model*>(&this->doughnut()); // FIXME: needed ?
           sin.set_context<Doughnut*>(&this->doughnut());
@@ -255,15 +258,31 @@ namespace memo
         Async::Op
         Async::_load_op(int id, bool signature)
         {
-          auto op = this->_load_op(this->_journal_dir / std::to_string(id), signature);
+          auto op = this->_load_op(this->_journal->get(id), signature);
           op.index = id;
           return op;
         }
 
+        elle::Buffer
+        Async::_serialize(Op const& op) const
+        {
+          auto res = elle::Buffer{};
+          {
+            elle::IOStream os(res.ostreambuf());
+            elle::serialization::binary::SerializerOut sout(os);
+            sout.set_context(ACBDontWaitForSignature{});
+            sout.set_context(OKBDontWaitForSignature{});
+            sout.serialize_forward(op);
+          }
+          return res;
+        }
+
         void
         Async::_push_op(Op op)
         {
           op.index = -1; // for nice debug prints, we will set that later
+          op.pushed = elle::Clock::now();
+          op.squashed = 0;
           // squash check
           static bool squash_enabled = memo::getenv("ASYNC_SQUASH", true);
           auto its = this->_operations.get<0>().equal_range(op.address);
@@ -273,11 +292,10 @@ namespace memo
             SquashOperation last_candidate_order = std::make_pair(
               Squash::stop, SquashConflictResolverOptions(0));
             // Check for squashability: we need resolvers, and we can't touch
-            // the head of the queue since it's currently being processed
-            int current = this->_operations.get<1>().begin()->index;
+            // the operation currently being processed
             std::vector<int> candidates;
             for (auto it = its.first; it != its.second; ++it)
-              if (it->index != current)
+              if (it->index != this->_processing)
                 candidates.push_back(it->index);
             std::sort(candidates.begin(), candidates.end(),
               [](int x, int y) { return x > y;});
@@ -341,82 +359,80 @@ namespace memo
                       o.mode = std::move(op.mode);
                       o.remove_signature = std::move(op.remove_signature);
                       o.resolver = std::move(cr);
+                      ++o.squashed;
                     });
-                  if (!this->_journal_dir.empty())
+                  this->_squashed.signal();
+                  if (this->_journal)
                   {
-                    auto path =
-                      _journal_dir / std::to_string(last_candidate_index);
-                    fs::ofstream os(path, std::ios::binary);
-                    elle::serialization::binary::SerializerOut sout(os);
-                    sout.set_context(ACBDontWaitForSignature{});
-                    sout.set_context(OKBDontWaitForSignature{});
-                    sout.serialize_forward(*copit);
+                    this->_journal->put(
+                      last_candidate_index, this->_serialize(*copit));
+                    this->_journal->commit();
                   }
                   return;
               }
               else
               { // at_last_position
                 op.resolver = std::move(cr);
+                op.pushed = cop.pushed;
+                op.squashed = cop.squashed + 1;
                 int idx = last_candidate_index;
                 int lastidx = this->_operations.get<1>().rbegin()->index;
                 ELLE_DEBUG("Erasing op at %s", last_candidate_index);
                 this->_operations.get<1>().erase(last_candidate_index);
-                if (!this->_journal_dir.empty())
-                {
-                  auto path = this->_journal_dir / std::to_string(idx);
-                  fs::remove(path);
-                }
+                if (this->_journal)
+                  this->_journal->drop(idx);
                 if (this->_first_disk_index
                   && this->_first_disk_index.get() == idx)
                 {
                   if (++*this->_first_disk_index > lastidx)
                     this->_first_disk_index.reset();
                 }
+                this->_squashed.signal();
                 // go on to regular push_op
               }
             }
           }
-          bool reentered = this->_in_push;
-          auto in_push = elle::scoped_assignment(this->_in_push, true);
-          op.index = ++this->_next_index;
-          ELLE_TRACE_SCOPE("%s: push %s", *this, op);
-          if (!this->_journal_dir.empty())
-          {
-            auto path = _journal_dir / std::to_string(op.index);
-            fs::ofstream os(path, std::ios::binary);
-            elle::serialization::binary::SerializerOut sout(os);
-            sout.set_context(ACBDontWaitForSignature{});
-            sout.set_context(OKBDontWaitForSignature{});
-            sout.serialize_forward(op);
-          }
-          if (reentered)
-          {
-            this->_reentered_ops.emplace_back(std::move(op));
-            return;
-          }
-          auto queue = [this](Op op)
           {
-            if (!this->_first_disk_index)
+            bool reentered = this->_in_push;
+            auto in_push = elle::scoped_assignment(this->_in_push, true);
+            op.index = ++this->_next_index;
+            ELLE_TRACE_SCOPE("%s: push %s", *this, op);
+            if (this->_journal)
+              this->_journal->put(op.index, this->_serialize(op));
+            if (reentered)
+              this->_reentered_ops.emplace_back(std::move(op));
+            else
             {
-              if (!this->_journal_dir.empty() &&
-                  this->_queue.size() >= this->_queue.max_size())
+              auto queue = [this](Op op)
               {
-                ELLE_TRACE("in-memory asynchronous queue at capacity at index %s",
-                           op.index);
-                this->_first_disk_index = op.index;
-                op.block.reset();
-              }
-              else
-                this->_queue.put(op.index);
+                if (!this->_first_disk_index)
+                {
+                  if (this->_journal &&
+                      this->_queue.size() >= this->_queue.max_size())
+                  {
+                    ELLE_TRACE(
+                      "in-memory asynchronous queue at capacity at index %s",
+                      op.index);
+                    this->_first_disk_index = op.index;
+                    op.block.reset();
+                  }
+                  else
+                    this->_queue.put(op.index);
+                }
+                else
+                  op.block.reset();
+                this->_operations.emplace(std::move(op));
+              };
+              queue(std::move(op));
+              for (auto& op: this->_reentered_ops)
+                queue(std::move(op));
+              this->_reentered_ops.clear();
             }
-            else
-              op.block.reset();
-            this->_operations.emplace(std::move(op));
-          };
-          queue(std::move(op));
-          for (auto& op: this->_reentered_ops)
-            queue(std::move(op));
-          this->_reentered_ops.clear();
+          }
+          // Commit outside of the push, so that operations pushed meanwhile
+          // are queued by their own call and share our fsync.
+          if (this->_journal)
+            this->_journal->commit();
         }
 
         void
@@ -425,6 +441,8 @@ namespace memo
                       std::unique_ptr<ConflictResolver> resolver)
         {
           elle::reactor::wait(this->_init_barrier);
+          if (this->_journal_error)
+            std::rethrow_exception(this->_journal_error);
           this->_queue.open();
           this->_push_op(
             Op(block->address(), std::move(block), mode, std::move(resolver)));
@@ -434,6 +452,8 @@ namespace memo
         Async::_remove(Address address, blocks::RemoveSignature rs)
         {
           elle::reactor::wait(this->_init_barrier);
+          if (this->_journal_error)
+            std::rethrow_exception(this->_journal_error);
           this->_queue.open();
           this->_push_op(Op(address, nullptr, {}, {}, std::move(rs)));
         }
@@ -545,13 +565,21 @@ namespace memo
                 it = this->_operations.get<1>().begin();
               }
 
+              this->_coalesce(index);
+              if (this->_exit_requested)
+                break;
+              it = this->_operations.get<1>().begin();
+              if (it == this->_operations.get<1>().end() || it->index != index)
+                // Squashed in a later operation meanwhile.
+                continue;
               elle::generic_unique_ptr<Op const> op(&*it, [] (Op const*) {});
               ELLE_ASSERT_EQ(op->index, index);
+              this->_processing = index;
               this->_process_operation(std::move(op));
-              if (!this->_journal_dir.empty())
+              this->_processing.reset();
+              if (this->_journal)
               {
-                auto path = this->_journal_dir / std::to_string(index);
-                fs::remove(path);
+                this->_journal->drop(index);
                 this->_last_processed_index = index;
               }
               this->_operations.get<1>().erase(it);
@@ -565,6 +593,33 @@ namespace memo
           ELLE_TRACE("exiting loop");
         }
 
+        void
+        Async::_coalesce(int index)
+        {
+          static auto const window = std::chrono::milliseconds(
+            memo::getenv("ASYNC_COALESCE_WINDOW", 100));
+          // Resolvers refuse to squash past that many, see
+          // ConflictResolver::squashable.
+          static auto const size = memo::getenv("MAX_SQUASH_SIZE", 20u);
+          auto& operations = this->_operations.get<1>();
+          while (!this->_exit_requested)
+          {
+            auto it = operations.find(index);
+            // Only operations with a resolver can be squashed.
+            if (it == operations.end() || !it->resolver ||
+                unsigned(it->squashed) + 1 >= size)
+              return;
+            auto const remaining = it->pushed + window - elle::Clock::now();
+            if (remaining <= 0s)
+              return;
+            ELLE_DEBUG("%s: hold %s back for squashing (%s squashed so far)",
+                       this, index, it->squashed)
+              elle::reactor::wait(
+                this->_squashed,
+                std::chrono::duration_cast<elle::Duration>(remaining));
+          }
+        }
+
         void
         Async::_process_operation(elle::generic_unique_ptr<Op const> op)
         {
@@ -710,6 +765,8 @@ namespace memo
           resolver = std::move(b.resolver);
           remove_signature = std::move(b.remove_signature);
           index = b.index;
+          pushed = b.pushed;
+          squashed = b.squashed;
           if (auto mb = dynamic_cast<blocks::MutableBlock*>(block.get()))
             version = mb->version();
           else if (auto mb = dynamic_cast<blocks::MutableBlock*>(
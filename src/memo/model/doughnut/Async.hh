@@ -1,5 +1,6 @@
 #pragma once
 
+#include <exception>
 #include <functional>
 #include <unordered_map>
 
@@ -10,10 +11,13 @@
 
 #include <elle/reactor/Channel.hh>
 #include <elle/reactor/Thread.hh>
+#include <elle/reactor/signal.hh>
 
+#include <elle/Duration.hh>
 #include <elle/optional.hh>
 
 #include <memo/model/doughnut/Consensus.hh>
+#include <memo/model/doughnut/Journal.hh>
 
 namespace memo
 {
@@ -67,11 +71,6 @@ namespace memo
           elle::json::Object
           stats() override;
 
-        public:
-          static
-          std::vector<fs::path>
-          entries(fs::path const& root);
-
           /*----------.
           | Operation |
           `----------*/
@@ -98,6 +97,11 @@ namespace memo
             blocks::RemoveSignature remove_signature;
             int index;
             int version;
+            /// When the first of the operations squashed in this one was
+            /// pushed, not persisted.
+            elle::Time pushed = elle::Time{};
+            /// Number of operations squashed in this one, not persisted.
+            int squashed = 0;
             using Model = elle::das::Model<
               Op,
               decltype(elle::meta::list(symbols::address,
@@ -116,14 +120,20 @@ namespace memo
           _process_loop();
           void
           _process_operation(elle::generic_unique_ptr<Op const> op);
+          /// Hold operation @a index back for the coalescing window, so that
+          /// following updates of the same block get squashed in it.
+          void
+          _coalesce(int index);
           void
           _init();
           void
           _push_op(Op op);
           Async::Op
-          _load_op(fs::path const& path, bool signature = true);
+          _load_op(elle::Buffer const& data, bool signature = true);
           Async::Op
           _load_op(int id, bool signature = true);
+          elle::Buffer
+          _serialize(Op const& op) const;
           void
           _load_operations();
           using Operations = bmi::multi_index_container<
@@ -139,6 +149,11 @@ namespace memo
           ELLE_ATTRIBUTE(int, next_index);
           ELLE_ATTRIBUTE(int, last_processed_index);
           ELLE_ATTRIBUTE(fs::path, journal_dir);
+          /// Persisted operations, opened by the restore thread.
+          ELLE_ATTRIBUTE(std::unique_ptr<Journal>, journal);
+          /// Why the journal could not be opened, rethrown by operations
+          /// that would not be persisted.
+          ELLE_ATTRIBUTE(std::exception_ptr, journal_error);
           /// Index of the first operation stored on disk because memory is at
           /// capacity.
           ELLE_ATTRIBUTE(boost::optional<int>, first_disk_index);
@@ -148,6 +163,10 @@ namespace memo
           ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, init_thread);
           ELLE_ATTRIBUTE(elle::reactor::Barrier, init_barrier);
           ELLE_ATTRIBUTE(bool, in_push);
+          /// Operation being sent to the backend, which cannot be squashed.
+          ELLE_ATTRIBUTE(boost::optional<int>, processing);
+          /// Signaled when an operation is squashed in the coalesced one.
+          ELLE_ATTRIBUTE(elle::reactor::Signal, squashed);
           ELLE_ATTRIBUTE(std::vector<Op>, reentered_ops);
           ELLE_ATTRIBUTE_R(unsigned long, processed_op_count);
           void
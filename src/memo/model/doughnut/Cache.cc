@@ -13,6 +13,7 @@
 #include <elle/serialization/binary.hh>
 
 #include <memo/model/MissingBlock.hh>
+#include <memo/model/doughnut/ACB.hh>
 #include <memo/model/doughnut/Doughnut.hh>
 #include <memo/model/doughnut/Local.hh>
 #include <memo/model/doughnut/OKB.hh>
@@ -32,6 +33,33 @@ namespace memo
           return elle::Clock::now();
         }
 
+        namespace
+        {
+          /// Discard written bytes, only counting them.
+          class CountingBuffer
+            : public std::streambuf
+          {
+          public:
+            std::streamsize count = 0;
+
+          protected:
+            int_type
+            overflow(int_type c) override
+            {
+              if (!traits_type::eq_int_type(c, traits_type::eof()))
+                ++this->count;
+              return traits_type::not_eof(c);
+            }
+
+            std::streamsize
+            xsputn(char const*, std::streamsize n) override
+            {
+              this->count += n;
+              return n;
+            }
+          };
+        }
+
         class CacheConflictResolver: public ConflictResolver
         {
         public:
@@ -101,6 +129,7 @@ namespace memo
           , _cache_size(cache_size.value_or(64_MiB))
           , _disk_cache_path(disk_cache_path)
           , _disk_cache_size(disk_cache_size.value_or(512_MiB))
+          , _cache(this->_cache_size)
           , _disk_cache_used(0)
           , _cleanup_thread(
             new elle::reactor::Thread(elle::sprintf("%s cleanup", *this),
@@ -144,7 +173,7 @@ namespace memo
         Cache::_remove(Address address, blocks::RemoveSignature rs)
         {
           ELLE_TRACE_SCOPE("%s: remove %f", this, address);
-          if (this->_cache.erase(address) > 0)
+          if (this->_cache.erase(address))
             ELLE_DEBUG("drop block from cache");
           else if (auto it = elle::find(this->_disk_cache, address))
           {
@@ -228,8 +257,27 @@ namespace memo
               && dynamic_cast<blocks::ImmutableBlock*>(&b))
             this->_disk_cache_push(b);
           else if (dynamic_cast<blocks::MutableBlock*>(&b) && this->_cache_size)
-            this->_cache.emplace(b.clone());
+            this->_cache.insert(
+              b.address(), CachedBlock(b.clone()), this->_footprint(b));
+        }
 
+        uint64_t
+        Cache::_footprint(blocks::Block& block)
+        {
+          static auto bench = elle::Bench<>{"bench.cache.footprint", 10000s};
+          auto bs = bench.scoped();
+          CountingBuffer buffer;
+          {
+            std::ostream os(&buffer);
+            elle::serialization::binary::SerializerOut sout(os);
+            sout.set_context<Doughnut*>(&this->doughnut());
+            // Signatures may still be pending, they are small enough not to
+            // matter.
+            sout.set_context(ACBDontWaitForSignature{});
+            sout.set_context(OKBDontWaitForSignature{});
+            sout.serialize_forward(&block);
+          }
+          return buffer.count;
         }
 
         std::unique_ptr<blocks::Block>
@@ -243,13 +291,11 @@ namespace memo
           static auto bench_disk_hit = elle::Bench<int>{"bench.cache.disk.hit", 1000s};
           static auto bench = elle::Bench<>{"bench.cache._fetch", 10000s};
           auto bs = bench.scoped();
-          auto hit = this->_cache.find(address);
-          if (hit != this->_cache.end())
+          if (auto hit = this->_cache.find(address))
           {
             cache_hit = true;
             ELLE_DEBUG("cache hit on %f", address);
-            this->_cache.modify(
-              hit, [] (CachedBlock& b) { b.last_used(now()); });
+            hit->last_used(now());
             bench_hit.add(1);
             if (local_version)
               if (auto mb =
@@ -328,20 +374,9 @@ namespace memo
         void
         Cache::insert(std::unique_ptr<blocks::Block> cloned)
         {
-          auto hit = this->_cache.find(cloned->address());
-          if (hit != this->_cache.end())
-          {
-            this->_cache.modify(
-              hit, [&] (CachedBlock& b) {
-                b.block() = std::move(cloned);
-                b.last_used(now());
-                b.last_fetched(now());
-              });
-          }
-          else
-          {
-            this->_cache.emplace(std::move(cloned));
-          }
+          auto const address = cloned->address();
+          auto const size = this->_footprint(*cloned);
+          this->_cache.insert(address, CachedBlock(std::move(cloned)), size);
         }
 
         void
@@ -457,38 +492,32 @@ namespace memo
               ELLE_DEBUG_SCOPE("%s: cleanup cache", *this);
               ELLE_DEBUG("evict unused blocks")
               {
-                auto& order = this->_cache.get<1>();
                 auto deadline = now - this->_cache_ttl;
-                auto it = order.begin();
-                while (it != order.end() && it->last_used() < deadline)
-                {
-                  ELLE_DUMP("evict %s", it->block()->address());
-                  it = order.erase(it);
-                }
+                this->_cache.erase_if(
+                  [&] (Address const& address, CachedBlock const& cached)
+                  {
+                    if (!(cached.last_used() < deadline))
+                      return false;
+                    ELLE_DUMP("evict %s", address);
+                    return true;
+                  });
               }
-              // FIXME: take cache_size in account too
               ELLE_DEBUG("refresh obsolete blocks")
               {
-                auto& order = this->_cache.get<2>();
                 auto deadline = now - this->_cache_invalidation;
                 std::vector<Model::AddressVersion> need_refresh;
-                for (auto it = order.begin(); it != order.end(); ++it)
-                {
-                  auto& cached = *it;
-                  if (!(cached.last_fetched() < deadline))
-                    break;
-                  auto const address = cached.block()->address();
-                  if (auto mb =
-                      dynamic_cast<blocks::MutableBlock*>(cached.block().get()))
-                  {
-                    need_refresh.push_back(std::make_pair(address, mb->version()));
-                  }
-                  else
+                this->_cache.each(
+                  [&] (Address const& address, CachedBlock& cached)
                   {
-                    ELLE_WARN("Nonmutable block %f in Cache", address);
-                    break;
-                  }
-                }
+                    if (!(cached.last_fetched() < deadline))
+                      return;
+                    if (auto mb = dynamic_cast<blocks::MutableBlock*>(
+                          cached.block().get()))
+                      need_refresh.push_back(
+                        std::make_pair(address, mb->version()));
+                    else
+                      ELLE_WARN("Nonmutable block %f in Cache", address);
+                  });
                 static const int batch_size =
                   memo::getenv("CACHE_REFRESH_BATCH_SIZE", 20);
                 for (int i=0; i < signed(need_refresh.size()); i+= batch_size)
@@ -512,18 +541,15 @@ namespace memo
                                    a, elle::exception_string(e));
                         this->_cache.erase(a);
                       }
-                      else
+                      else if (auto cached = this->_cache.peek(a))
                       {
-                        auto it = this->_cache.find(a);
-                        if (it != this->_cache.end())
-                          this->_cache.modify(
-                            it,
-                            [&] (CachedBlock& cache)
-                            {
-                              if (b)
-                                cache.block() = std::move(b);
-                              cache.last_fetched(now);
-                            });
+                        cached->last_fetched(now);
+                        if (b)
+                        {
+                          auto const size = this->_footprint(*b);
+                          cached->block() = std::move(b);
+                          this->_cache.resize(a, size);
+                        }
                       }
                     });
                   }
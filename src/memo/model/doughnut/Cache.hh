@@ -12,6 +12,7 @@
 
 #include <memo/model/blocks/MutableBlock.hh>
 #include <memo/model/doughnut/Consensus.hh>
+#include <memo/model/doughnut/TinyLFU.hh>
 
 namespace memo
 {
@@ -89,6 +90,9 @@ namespace memo
           _insert_cache(blocks::Block& b);
           std::unique_ptr<blocks::Block>
           _copy(blocks::Block& block);
+          /// The serialized size of @a block, accounted in the RAM cache.
+          uint64_t
+          _footprint(blocks::Block& block);
           ELLE_ATTRIBUTE_R(elle::Duration, cache_invalidation);
           ELLE_ATTRIBUTE_R(elle::Duration, cache_ttl);
           ELLE_ATTRIBUTE_R(int, cache_size);
@@ -104,29 +108,9 @@ namespace memo
             ELLE_ATTRIBUTE_RW(elle::Time, last_used);
             ELLE_ATTRIBUTE_RW(elle::Time, last_fetched);
           };
-          /// Sort mutable blocks first, ordered by last_fetched
-          struct LastFetch
-          {
-            bool
-            operator ()(CachedBlock const& lhs, CachedBlock const& rhs) const;
-          };
-
-          using BlockCache = bmi::multi_index_container<
-            CachedBlock,
-            bmi::indexed_by<
-              bmi::hashed_unique<
-                bmi::const_mem_fun<
-                  CachedBlock,
-                  Address, &CachedBlock::address> >,
-              bmi::ordered_non_unique<
-                bmi::const_mem_fun<
-                  CachedBlock,
-                  elle::Time const&, &CachedBlock::last_used> >,
-              bmi::ordered_non_unique<
-                bmi::const_mem_fun<
-                  CachedBlock,
-                  elle::Time const&, &CachedBlock::last_fetched> >
-            > >;
+          /// Mutable blocks, bounded by their serialized size, with the
+          /// scan-resistant W-TinyLFU policy.
+          using BlockCache = TinyLFU<Address, CachedBlock>;
           ELLE_ATTRIBUTE(BlockCache, cache);
           class CachedCHB
           {
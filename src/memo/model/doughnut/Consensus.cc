@@ -1,21 +1,62 @@
 #include <memo/model/doughnut/Consensus.hh>
 
+#include <map>
+#include <typeindex>
+
+#include <elle/make-vector.hh>
 #include <elle/os/environ.hh>
 
+#include <memo/environ.hh>
+
 #include <memo/silo/MissingKey.hh>
 #include <memo/model/Conflict.hh>
 #include <memo/model/doughnut/Doughnut.hh>
 #include <memo/model/doughnut/Local.hh>
 #include <memo/model/doughnut/Remote.hh>
 #include <memo/model/MissingBlock.hh>
+#include <memo/model/prometheus.hh>
 
 #include <elle/reactor/Channel.hh>
 #include <elle/reactor/Scope.hh>
 #include <elle/reactor/scheduler.hh>
+#include <elle/reactor/semaphore.hh>
 #include <elle/reactor/network/Error.hh>
 
 ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Consensus");
 
+namespace
+{
+  /// The latency histogram of @a operation for the type of @a consensus.
+  ///
+  /// Stacked consensuses each record their own latency, labeled with
+  /// their type.
+  memo::prometheus::HistogramPtr const&
+  latency(memo::model::doughnut::consensus::Consensus const& consensus,
+          char const* operation)
+  {
+    static auto const family = memo::prometheus::make_histogram_family(
+      "memo_consensus_latency_seconds",
+      "How long consensus operations take");
+    static auto histograms = std::map<
+      std::pair<std::type_index, std::string>,
+      memo::prometheus::HistogramPtr>{};
+    auto const key = std::make_pair(std::type_index(typeid(consensus)),
+                                    std::string(operation));
+    auto it = histograms.find(key);
+    if (it == histograms.end())
+      it = histograms.emplace(
+        key,
+        memo::prometheus::make(
+          family,
+          {
+            {"consensus", elle::type_info(consensus).name()},
+            {"operation", operation},
+          },
+          memo::prometheus::latency_buckets())).first;
+    return it->second;
+  }
+}
+
 namespace memo
 {
   namespace model
@@ -34,6 +75,7 @@ namespace memo
                          std::unique_ptr<ConflictResolver> resolver)
         {
           ELLE_TRACE_SCOPE("%s: store %s (mode: %s)", *this, block, mode);
+          prometheus::Timer timer(latency(*this, "store"));
           this->_store(std::move(block), mode, std::move(resolver));
         }
 
@@ -94,6 +136,7 @@ namespace memo
         {
           ELLE_TRACE_SCOPE("%s: fetch %f if newer than %s",
                            *this, address, local_version);
+          prometheus::Timer timer(latency(*this, "fetch"));
           return this->_fetch(address, local_version);
         }
 
@@ -102,6 +145,7 @@ namespace memo
                          ReceiveBlock res)
         {
            ELLE_TRACE_SCOPE("%s: fetch %s", *this, addresses);
+           prometheus::Timer timer(latency(*this, "multifetch"));
            this->_fetch(addresses, res);
         }
 
@@ -109,18 +153,113 @@ namespace memo
         Consensus::_fetch(std::vector<AddressVersion> const& addresses,
                           ReceiveBlock res)
         {
+          static auto const batch_size =
+            std::max(memo::getenv("MULTIFETCH_BATCH_SIZE", 256), 1);
+          static auto const parallelism =
+            std::max(memo::getenv("MULTIFETCH_PARALLELISM", 8), 1);
+          auto const fetch_one = [&] (AddressVersion const& a)
+            {
+              try
+              {
+                auto block = this->fetch(a.first, a.second);
+                res(a.first, std::move(block), {});
+              }
+              catch (elle::Error const& e)
+              {
+                res(a.first, {}, std::current_exception());
+              }
+            };
+          // Group addresses by owner, so each peer is queried in batches.
+          using Batch = std::vector<AddressVersion>;
+          auto owners =
+            std::unordered_map<Address, std::pair<overlay::WeakMember, Batch>>{};
+          auto versions = std::unordered_map<Address, boost::optional<int>>{};
           for (auto const& a: addresses)
+            versions.emplace(a);
+          try
           {
-            try
-            {
-              auto block = this->fetch(a.first, a.second);
-              res(a.first, std::move(block), {});
-            }
-            catch (elle::Error const& e)
+            auto hits = this->doughnut().overlay()->lookup(
+              elle::make_vector(addresses,
+                                [] (auto const& a) { return a.first; }),
+              1);
+            for (auto const& hit: hits)
+              if (auto owner = hit.second.lock())
+              {
+                auto version = versions.find(hit.first);
+                if (version == versions.end())
+                  continue;
+                auto& o = owners[owner->id()];
+                o.first = hit.second;
+                o.second.emplace_back(*version);
+                versions.erase(version);
+              }
+          }
+          catch (elle::Error const& e)
+          {
+            ELLE_TRACE("%s: grouping lookup failed: %s", this, e);
+          }
+          auto batches = std::vector<std::pair<overlay::WeakMember, Batch>>{};
+          for (auto& o: owners)
+          {
+            auto& all = o.second.second;
+            for (auto it = all.begin(); it != all.end();)
             {
-              res(a.first, {}, std::current_exception());
+              auto const end =
+                it + std::min<std::ptrdiff_t>(batch_size, all.end() - it);
+              batches.emplace_back(o.second.first, Batch(it, end));
+              it = end;
             }
           }
+          ELLE_DEBUG("%s: fetch %s addresses in %s batches from %s peers",
+                     this, addresses.size(), batches.size(), owners.size());
+          elle::reactor::Semaphore slots(parallelism);
+          elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& s)
+          {
+            for (auto& batch: batches)
+              s.run_background(
+                elle::print("fetch {} blocks", batch.second.size()),
+                [&]
+                {
+                  elle::reactor::Lock lock(slots);
+                  auto fetched = boost::optional<Peer::FetchManyResult>{};
+                  if (auto owner = batch.first.lock())
+                    try
+                    {
+                      fetched.emplace(owner->fetch(batch.second));
+                    }
+                    catch (elle::Error const& e)
+                    {
+                      ELLE_TRACE("%s: batched fetch from %s failed: %s",
+                                 this, *owner, e);
+                    }
+                  if (!fetched)
+                  {
+                    // Fallback to a per-address lookup, which can route
+                    // around the faulty owner.
+                    for (auto const& a: batch.second)
+                      fetch_one(a);
+                    return;
+                  }
+                  for (auto const& a: batch.second)
+                  {
+                    auto it = fetched->find(a.first);
+                    if (it == fetched->end())
+                      res(a.first, {},
+                          std::make_exception_ptr(MissingBlock(a.first)));
+                    else
+                      res(a.first, std::move(it->second), {});
+                  }
+                });
+            // Addresses no owner was found for.
+            for (auto const& a: versions)
+              s.run_background(elle::print("fetch {}", a.first),
+                               [&]
+                               {
+                                 elle::reactor::Lock lock(slots);
+                                 fetch_one(a);
+                               });
+            elle::reactor::wait(s);
+          };
         }
 
         std::unique_ptr<blocks::Block>
@@ -135,6 +274,7 @@ namespace memo
         void
         Consensus::remove(Address address, blocks::RemoveSignature rs)
         {
+          prometheus::Timer timer(latency(*this, "remove"));
           int count = 0;
           while (true)
           {
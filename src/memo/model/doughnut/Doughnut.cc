@@ -513,20 +513,60 @@ namespace memo
       Doughnut::_fetch(Address address,
                        boost::optional<int> local_version) const
       {
-        return this->_consensus->fetch(address, std::move(local_version));
+        if (this->_known_missing(address))
+        {
+          ELLE_DEBUG("%s: %f is known to be missing", this, address);
+          throw MissingBlock(address);
+        }
+        try
+        {
+          return this->_consensus->fetch(address, std::move(local_version));
+        }
+        catch (MissingBlock const&)
+        {
+          this->_remember_missing(address);
+          throw;
+        }
       }
 
       void
       Doughnut::_fetch(std::vector<AddressVersion> const& addresses,
                        ReceiveBlock res) const
       {
-        this->_consensus->fetch(addresses, res);
+        auto query = std::vector<AddressVersion>{};
+        for (auto const& a: addresses)
+          if (this->_known_missing(a.first))
+            res(a.first, {}, std::make_exception_ptr(MissingBlock(a.first)));
+          else
+            query.emplace_back(a);
+        if (query.empty())
+          return;
+        this->_consensus->fetch(
+          query,
+          [&] (Address address,
+               std::unique_ptr<blocks::Block> block,
+               std::exception_ptr e)
+          {
+            if (e)
+              try
+              {
+                std::rethrow_exception(e);
+              }
+              catch (MissingBlock const&)
+              {
+                this->_remember_missing(address);
+              }
+              catch (...)
+              {}
+            res(address, std::move(block), e);
+          });
       }
 
       void
       Doughnut::_insert(std::unique_ptr<blocks::Block> block,
                         std::unique_ptr<ConflictResolver> resolver)
       {
+        this->_missing_cache.erase(block->address());
         this->_consensus->store(std::move(block),
                                 StoreMode::STORE_INSERT,
                                 std::move(resolver));
@@ -536,6 +576,7 @@ namespace memo
       Doughnut::_update(std::unique_ptr<blocks::Block> block,
                         std::unique_ptr<ConflictResolver> resolver)
       {
+        this->_missing_cache.erase(block->address());
         this->_consensus->store(std::move(block),
                                 StoreMode::STORE_UPDATE,
                                 std::move(resolver));
@@ -547,6 +588,47 @@ namespace memo
         this->_consensus->remove(address, std::move(rs));
       }
 
+      /*---------------.
+      | Negative cache |
+      `---------------*/
+
+      bool
+      Doughnut::_known_missing(Address const& address) const
+      {
+        auto it = this->_missing_cache.find(address);
+        if (it == this->_missing_cache.end())
+          return false;
+        if (it->expiration < elle::Clock::now())
+        {
+          this->_missing_cache.erase(it);
+          return false;
+        }
+        return true;
+      }
+
+      void
+      Doughnut::_remember_missing(Address const& address) const
+      {
+        static auto const ttl =
+          std::chrono::milliseconds(memo::getenv("NEGATIVE_CACHE_TTL", 1000));
+        static auto const size = memo::getenv("NEGATIVE_CACHE_SIZE", 4096);
+        if (ttl == ttl.zero() || size <= 0)
+          return;
+        auto const now = elle::Clock::now();
+        auto& order = this->_missing_cache.get<1>();
+        // Drop expired entries, then the least recent ones beyond the bound.
+        while (!order.empty() &&
+               (order.front().expiration < now ||
+                signed(order.size()) >= size))
+          order.pop_front();
+        auto const res = order.push_back(Missing{address, now + ttl});
+        if (!res.second)
+        {
+          order.replace(res.first, Missing{address, now + ttl});
+          order.relocate(order.end(), res.first);
+        }
+      }
+
       /*------------------.
       | Service discovery |
       `------------------*/
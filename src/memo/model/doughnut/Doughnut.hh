@@ -21,6 +21,8 @@
 #include <memo/model/doughnut/Consensus.hh>
 #include <memo/model/doughnut/Dock.hh>
 #include <memo/model/doughnut/Passport.hh>
+#include <memo/model/doughnut/SecretCache.hh>
+#include <memo/model/doughnut/SignatureCache.hh>
 #include <memo/model/prometheus.hh>
 #include <memo/overlay/Overlay.hh>
 
@@ -213,6 +215,10 @@ namespace memo
 
       public:
         ELLE_ATTRIBUTE_R(KeyCache, key_cache);
+        /// Keys unwrapped to read ACBs.
+        ELLE_ATTRIBUTE_RX(SecretCache, secret_cache);
+        /// Signatures of blocks already validated.
+        ELLE_ATTRIBUTE_RX(SignatureCache, signature_cache);
 
       protected:
         std::unique_ptr<blocks::MutableBlock>
@@ -255,6 +261,34 @@ namespace memo
         void
         _remove(Address address, blocks::RemoveSignature rs) override;
         friend class Local;
+
+      /*---------------.
+      | Negative cache |
+      `---------------*/
+      private:
+        /// Whether @a address was recently found missing.
+        bool
+        _known_missing(Address const& address) const;
+        /// Remember @a address is missing for $MEMO_NEGATIVE_CACHE_TTL
+        /// milliseconds, sparing repeated existence probes the overlay walk.
+        void
+        _remember_missing(Address const& address) const;
+        struct Missing
+        {
+          Address address;
+          elle::Time expiration;
+        };
+        /// Recently missing addresses, least recently found missing first.
+        /// All entries live as long, so this is also the expiration order.
+        using MissingCache = bmi::multi_index_container<
+          Missing,
+          bmi::indexed_by<
+            bmi::hashed_unique<
+              bmi::member<Missing, Address, &Missing::address>>,
+            bmi::sequenced<>>>;
+        ELLE_ATTRIBUTE(MissingCache, missing_cache, mutable);
+
+      protected:
         ELLE_ATTRIBUTE(std::unique_ptr<MonitoringServer>, monitoring_server);
 
       /*------------------.
@@ -0,0 +1,409 @@
+#include <memo/model/doughnut/Journal.hh>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifdef ELLE_WINDOWS
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#include <boost/crc.hpp>
+#include <boost/optional.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <elle/Error.hh>
+#include <elle/With.hh>
+#include <elle/finally.hh>
+#include <elle/log.hh>
+#include <elle/reactor/scheduler.hh>
+
+ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Journal");
+
+namespace
+{
+  // On-disk layout, in host byte order.  A segment is a sequence of
+  // records, each a RecordHeader followed by `length` bytes of payload.
+
+  uint32_t const record_magic = 0x6a726e6c; // "jrnl"
+
+  enum Kind: uint32_t
+  {
+    put_kind = 1,
+    drop_kind = 2,
+  };
+
+  struct RecordHeader
+  {
+    uint32_t magic;
+    uint32_t kind;
+    int32_t index;
+    uint32_t length;
+    uint32_t checksum;
+  };
+
+  uint32_t
+  checksum(int32_t index, elle::ConstWeakBuffer payload)
+  {
+    auto crc = boost::crc_32_type{};
+    crc.process_bytes(&index, sizeof index);
+    crc.process_bytes(payload.contents(), payload.size());
+    return crc.checksum();
+  }
+
+  std::string const segment_prefix = "segment-";
+
+  /// The segment number of @a path, if it is one.
+  boost::optional<int>
+  segment_number(boost::filesystem::path const& path)
+  {
+    auto const name = path.filename().string();
+    if (name.compare(0, segment_prefix.size(), segment_prefix) != 0)
+      return {};
+    try
+    {
+      return std::stoi(name.substr(segment_prefix.size()));
+    }
+    catch (std::logic_error const&)
+    {
+      return {};
+    }
+  }
+
+  /// The operation index of @a path, if it is a legacy journal entry.
+  boost::optional<int>
+  legacy_index(boost::filesystem::path const& path)
+  {
+    auto const name = path.filename().string();
+    if (name.empty() ||
+        name.find_first_not_of("0123456789") != std::string::npos)
+      return {};
+    return std::stoi(name);
+  }
+
+  void
+  sync_file(std::FILE* f)
+  {
+#ifdef ELLE_WINDOWS
+    auto const res = ::_commit(::_fileno(f));
+#else
+    auto const res = ::fsync(::fileno(f));
+#endif
+    if (res)
+      elle::err("unable to sync journal: %s", std::strerror(errno));
+  }
+}
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        namespace bfs = boost::filesystem;
+
+        Journal::Journal(bfs::path root, int64_t segment_size, bool sync)
+          : _root(std::move(root))
+          , _segment_size(segment_size)
+          , _sync(sync)
+          , _syncs(0)
+          , _active(-1)
+          , _active_size(0)
+          , _appended(0)
+          , _durable(0)
+        {
+          ELLE_TRACE_SCOPE("%s: open %s", this, this->_root);
+          bfs::create_directories(this->_root);
+          this->_index = Journal::scan(this->_root);
+          auto last = -1;
+          for (auto const& p: bfs::directory_iterator(this->_root))
+            if (auto const segment = segment_number(p.path()))
+            {
+              last = std::max(last, *segment);
+              this->_live.emplace(*segment, 0);
+            }
+          for (auto const& entry: this->_index)
+            if (entry.second.segment >= 0)
+              ++this->_live[entry.second.segment];
+          // Never append after a possibly torn record.
+          this->_open(last + 1);
+          this->_migrate();
+          this->_truncate();
+        }
+
+        Journal::~Journal()
+        {
+          if (this->_output)
+            std::fflush(this->_output.get());
+        }
+
+        void
+        Journal::put(int index, elle::ConstWeakBuffer payload)
+        {
+          ELLE_DEBUG_SCOPE("%s: put %s (%s bytes)", this, index, payload.size());
+          if (this->_active_size >= uint64_t(this->_segment_size))
+            this->_open(this->_active + 1);
+          auto const offset = this->_active_size;
+          this->_append(put_kind, index, payload);
+          auto it = this->_index.find(index);
+          if (it != this->_index.end())
+            this->_release(it->second);
+          this->_index[index] = Location{
+            this->_active, offset, uint32_t(payload.size())};
+          ++this->_live[this->_active];
+        }
+
+        void
+        Journal::drop(int index)
+        {
+          auto it = this->_index.find(index);
+          if (it == this->_index.end())
+            return;
+          ELLE_DEBUG_SCOPE("%s: drop %s", this, index);
+          this->_append(drop_kind, index, {});
+          this->_release(it->second);
+          this->_index.erase(it);
+          this->_truncate();
+        }
+
+        void
+        Journal::commit()
+        {
+          auto const target = this->_appended;
+          while (this->_durable < target)
+            if (auto syncing = this->_syncing)
+              // Piggyback on the fsync in progress, then check whether it
+              // covered our records.
+              elle::reactor::wait(*syncing);
+            else
+            {
+              auto barrier = std::make_shared<elle::reactor::Barrier>();
+              this->_syncing = barrier;
+              elle::SafeFinally done([&] {
+                  this->_syncing.reset();
+                  barrier->open();
+                });
+              auto const upto = this->_appended;
+              this->_fsync();
+              this->_durable = std::max(this->_durable, upto);
+            }
+        }
+
+        elle::Buffer
+        Journal::get(int index)
+        {
+          auto it = this->_index.find(index);
+          if (it == this->_index.end())
+            elle::err("operation %s is not in the journal", index);
+          if (it->second.segment == this->_active)
+            std::fflush(this->_output.get());
+          return Journal::read(this->_root, index, it->second);
+        }
+
+        /*--------.
+        | Reading |
+        `--------*/
+
+        auto
+        Journal::scan(bfs::path const& root)
+          -> Index
+        {
+          auto res = Index{};
+          if (!bfs::exists(root))
+            return res;
+          auto segments = std::map<int, bfs::path>{};
+          for (auto const& p: bfs::directory_iterator(root))
+            if (auto const segment = segment_number(p.path()))
+              segments.emplace(*segment, p.path());
+            else if (auto const index = legacy_index(p.path()))
+              res[*index] = Location{
+                -1, 0, uint32_t(bfs::file_size(p.path()))};
+          for (auto const& segment: segments)
+          {
+            bfs::ifstream input(segment.second, std::ios::binary);
+            auto offset = uint64_t(0);
+            auto payload = elle::Buffer{};
+            while (true)
+            {
+              RecordHeader header;
+              input.read(reinterpret_cast<char*>(&header), sizeof header);
+              if (input.gcount() == 0)
+                break;
+              if (input.gcount() != sizeof header ||
+                  header.magic != record_magic)
+              {
+                ELLE_WARN("%s: torn record at offset %s, ignoring the rest",
+                          segment.second, offset);
+                break;
+              }
+              payload.size(header.length);
+              input.read(reinterpret_cast<char*>(payload.mutable_contents()),
+                         header.length);
+              if (input.gcount() != std::streamsize(header.length) ||
+                  checksum(header.index, payload) != header.checksum)
+              {
+                ELLE_WARN("%s: torn record at offset %s, ignoring the rest",
+                          segment.second, offset);
+                break;
+              }
+              if (header.kind == put_kind)
+                res[header.index] =
+                  Location{segment.first, offset, header.length};
+              else
+                res.erase(header.index);
+              offset += sizeof header + header.length;
+            }
+          }
+          return res;
+        }
+
+        elle::Buffer
+        Journal::read(bfs::path const& root,
+                      int index,
+                      Location const& location)
+        {
+          auto const path = location.segment < 0
+            ? root / std::to_string(index)
+            : Journal::_segment_path(root, location.segment);
+          bfs::ifstream input(path, std::ios::binary);
+          if (location.segment >= 0)
+            input.seekg(location.offset + sizeof(RecordHeader));
+          auto res = elle::Buffer(location.length);
+          input.read(reinterpret_cast<char*>(res.mutable_contents()),
+                     location.length);
+          if (!input || input.gcount() != std::streamsize(location.length))
+            elle::err("unable to read operation %s from %s", index, path);
+          return res;
+        }
+
+        /*--------.
+        | Writing |
+        `--------*/
+
+        bfs::path
+        Journal::_segment_path(bfs::path const& root, int segment)
+        {
+          return root / (segment_prefix + std::to_string(segment));
+        }
+
+        void
+        Journal::_open(int segment)
+        {
+          auto const path = Journal::_segment_path(this->_root, segment);
+          ELLE_TRACE("%s: start segment %s", this, path);
+          if (this->_output)
+          {
+            // Commits only sync the active segment: make the one being
+            // retired durable now.
+            if (std::fflush(this->_output.get()))
+              elle::err("unable to write journal: %s", std::strerror(errno));
+            if (this->_sync)
+              sync_file(this->_output.get());
+          }
+          auto output = std::fopen(path.string().c_str(), "ab");
+          if (!output)
+            elle::err("unable to open journal segment %s: %s",
+                      path, std::strerror(errno));
+          // A fsync in progress may still hold the previous file.
+          this->_output.reset(output, &std::fclose);
+          this->_active = segment;
+          this->_active_size = 0;
+          this->_live.emplace(segment, 0);
+        }
+
+        void
+        Journal::_append(uint32_t kind, int index, elle::ConstWeakBuffer payload)
+        {
+          auto const header = RecordHeader{
+            record_magic,
+            kind,
+            index,
+            uint32_t(payload.size()),
+            checksum(index, payload),
+          };
+          auto const output = this->_output.get();
+          if (std::fwrite(&header, sizeof header, 1, output) != 1 ||
+              (payload.size() &&
+               std::fwrite(payload.contents(), payload.size(), 1, output) != 1))
+            elle::err("unable to write journal segment %s: %s",
+                      Journal::_segment_path(this->_root, this->_active),
+                      std::strerror(errno));
+          this->_active_size += sizeof header + payload.size();
+          ++this->_appended;
+        }
+
+        void
+        Journal::_release(Location const& location)
+        {
+          if (location.segment >= 0)
+            --this->_live[location.segment];
+        }
+
+        void
+        Journal::_truncate()
+        {
+          while (!this->_live.empty())
+          {
+            auto it = this->_live.begin();
+            if (it->first == this->_active || it->second > 0)
+              break;
+            auto const path = Journal::_segment_path(this->_root, it->first);
+            ELLE_TRACE("%s: delete processed segment %s", this, path);
+            auto erc = boost::system::error_code{};
+            bfs::remove(path, erc);
+            if (erc)
+              ELLE_WARN("%s: unable to delete %s: %s", this, path, erc.message());
+            this->_live.erase(it);
+          }
+        }
+
+        void
+        Journal::_migrate()
+        {
+          // Legacy files superseded by segments are leftovers of an
+          // interrupted migration: they must go too, lest they resurrect
+          // operations once the segments are truncated.
+          auto files = std::vector<int>{};
+          for (auto const& p: bfs::directory_iterator(this->_root))
+            if (auto const index = legacy_index(p.path()))
+              files.emplace_back(*index);
+          if (files.empty())
+            return;
+          ELLE_TRACE_SCOPE("%s: migrate %s legacy operations",
+                           this, files.size());
+          for (auto index: files)
+          {
+            auto const& location = this->_index.at(index);
+            if (location.segment < 0)
+              this->put(index, Journal::read(this->_root, index, location));
+          }
+          this->commit();
+          for (auto index: files)
+            bfs::remove(this->_root / std::to_string(index));
+        }
+
+        void
+        Journal::_fsync()
+        {
+          auto output = this->_output;
+          if (std::fflush(output.get()))
+            elle::err("unable to write journal: %s", std::strerror(errno));
+          if (!this->_sync)
+            return;
+          ++this->_syncs;
+          // Puts go on while the disk syncs, and join the next commit.
+          elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+          {
+            elle::reactor::background([&] { sync_file(output.get()); });
+          };
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdio>
+#include <map>
+#include <memory>
+
+#include <boost/filesystem/path.hpp>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+
+#include <elle/reactor/Barrier.hh>
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        /// Append-only log of the asynchronous operations, by index.
+        ///
+        /// Records are appended to segment files, a new one being started
+        /// once the active one reaches `segment_size`.  Putting an index
+        /// again supersedes its previous payload, dropping it forgets it.
+        /// Segments whose payloads were all superseded or dropped are
+        /// deleted, oldest first.  Concurrent commits share a single fsync.
+        ///
+        /// Journals from before segments, holding one file per operation
+        /// named after its index, are read transparently and migrated when
+        /// opened for writing.
+        class Journal
+        {
+        public:
+          /// Where the payload of an operation lives.
+          struct Location
+          {
+            /// Segment number, or -1 for a legacy per-operation file.
+            int segment;
+            uint64_t offset;
+            uint32_t length;
+          };
+          using Index = std::map<int, Location>;
+
+          /// Open, recover and take ownership of the journal in @a root.
+          Journal(boost::filesystem::path root,
+                  int64_t segment_size = 64 * 1024 * 1024,
+                  bool sync = true);
+          ~Journal();
+          /// Record @a payload for operation @a index.
+          ///
+          /// The record is only durable once committed.
+          void
+          put(int index, elle::ConstWeakBuffer payload);
+          /// Forget operation @a index.
+          void
+          drop(int index);
+          /// Wait until all records put so far are durable.
+          void
+          commit();
+          /// The payload of operation @a index.
+          elle::Buffer
+          get(int index);
+          ELLE_ATTRIBUTE_R(boost::filesystem::path, root);
+          ELLE_ATTRIBUTE_R(int64_t, segment_size);
+          ELLE_ATTRIBUTE_R(bool, sync);
+          /// Operations recorded, in order.
+          ELLE_ATTRIBUTE_R(Index, index);
+          /// Number of fsyncs performed.
+          ELLE_ATTRIBUTE_R(int, syncs);
+
+        /*---------.
+        | Reading  |
+        `---------*/
+        public:
+          /// The operations recorded in @a root, without modifying it.
+          ///
+          /// Only record headers are kept in memory: payloads are streamed
+          /// to check their integrity.  A torn record ends its segment.
+          static
+          Index
+          scan(boost::filesystem::path const& root);
+          /// The payload of operation @a index, at @a location in the journal
+          /// in @a root.
+          static
+          elle::Buffer
+          read(boost::filesystem::path const& root,
+               int index,
+               Location const& location);
+
+        private:
+          static
+          boost::filesystem::path
+          _segment_path(boost::filesystem::path const& root, int segment);
+          void
+          _open(int segment);
+          void
+          _append(uint32_t kind, int index, elle::ConstWeakBuffer payload);
+          /// Account for @a location not being live anymore.
+          void
+          _release(Location const& location);
+          /// Delete the oldest segments with no live payload.
+          void
+          _truncate();
+          void
+          _migrate();
+          /// Make everything written to the active segment durable.
+          void
+          _fsync();
+          /// Live payloads per segment.
+          ELLE_ATTRIBUTE((std::map<int, int>), live);
+          ELLE_ATTRIBUTE(int, active);
+          ELLE_ATTRIBUTE(uint64_t, active_size);
+          ELLE_ATTRIBUTE(std::shared_ptr<std::FILE>, output);
+          /// Sequence number of the last record appended.
+          ELLE_ATTRIBUTE(uint64_t, appended);
+          /// Sequence number of the last record made durable.
+          ELLE_ATTRIBUTE(uint64_t, durable);
+          /// Opened when the fsync in progress, if any, is done.
+          ELLE_ATTRIBUTE(std::shared_ptr<elle::reactor::Barrier>, syncing);
+        };
+      }
+    }
+  }
+}
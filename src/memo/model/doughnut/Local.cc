@@ -62,6 +62,27 @@ namespace memo
         : Super(dht, std::move(id))
         , _storage(std::move(storage))
       {
+        // Block metadata can only be told apart once addresses are flagged.
+        if (this->_storage)
+          this->_storage->hide_metadata(
+            dht.version() >= elle::Version(0, 5, 0));
+        // Answer fetches of blocks we do not hold without reaching storage.
+        // Building the filter lists the whole silo, do not hold startup.
+        if (this->_storage && memo::getenv("SILO_FILTER", false))
+          this->_filter_thread.reset(
+            new elle::reactor::Thread(
+              elle::sprintf("%s filter", this),
+              [this]
+              {
+                try
+                {
+                  this->_storage->enable_filter();
+                }
+                catch (elle::Error const& e)
+                {
+                  ELLE_WARN("%s: unable to build key filter: %s", this, e);
+                }
+              }));
         auto p = dht.protocol();
         std::unique_ptr<elle::reactor::network::TCPServer> old_server;
         int num_run = 0;
@@ -154,6 +175,11 @@ namespace memo
       void
       Local::_cleanup()
       {
+        if (this->_filter_thread)
+        {
+          this->_filter_thread->terminate_now();
+          this->_filter_thread.reset();
+        }
         if (this->_server_thread)
         {
           this->_server_thread->terminate_now();
@@ -212,15 +238,7 @@ namespace memo
         }
         catch (silo::MissingKey const&)
         {}
-        elle::Buffer data = [&block]
-          {
-            elle::Buffer res;
-            elle::IOStream s(res.ostreambuf());
-            Serializer::SerializerOut output(s);
-            auto ptr = &block;
-            output.serialize_forward(ptr);
-            return res;
-          }();
+        auto data = Local::_serialize(block);
         try
         {
           this->_storage->set(block.address(), data,
@@ -256,6 +274,34 @@ namespace memo
         return res;
       }
 
+      elle::Buffer
+      Local::_fetch_serialized(Address address) const
+      {
+        ELLE_TRACE_SCOPE("%s: fetch serialized %f", this, address);
+        // Observers need the decoded block.
+        if (!this->_on_fetch.empty())
+          return Local::_serialize(*this->_fetch(address, {}));
+        try
+        {
+          return this->_storage->get(address);
+        }
+        catch (silo::MissingKey const& e)
+        {
+          throw MissingBlock(e.key());
+        }
+      }
+
+      elle::Buffer
+      Local::_serialize(blocks::Block const& block)
+      {
+        elle::Buffer res;
+        elle::IOStream s(res.ostreambuf());
+        Serializer::SerializerOut output(s);
+        auto ptr = &block;
+        output.serialize_forward(ptr);
+        return res;
+      }
+
       void
       Local::remove(Address address, blocks::RemoveSignature rs)
       {
@@ -389,6 +435,22 @@ namespace memo
                    this->_require_auth(rpcs, false);
                    return this->fetch(address, local_version);
                  });
+        if (this->_doughnut.version() >= elle::Version(0, 10, 0))
+        {
+          if (this->_stores_serialized())
+            rpcs.add("fetch_serialized",
+                     [this, &rpcs] (Address address)
+                     {
+                       this->_require_auth(rpcs, false);
+                       return this->_fetch_serialized(address);
+                     });
+          rpcs.add("fetch_many",
+                   [this, &rpcs] (std::vector<AddressVersion> const& addresses)
+                   {
+                     this->_require_auth(rpcs, false);
+                     return this->fetch(addresses);
+                   });
+        }
         if (this->_doughnut.version() >= elle::Version(0, 4, 0))
           rpcs.add("remove",
                    [this, &rpcs] (Address address, blocks::RemoveSignature rs)
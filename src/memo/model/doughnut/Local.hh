@@ -65,6 +65,16 @@ namespace memo
         std::unique_ptr<blocks::Block>
         _fetch(Address address,
                boost::optional<int> local_version) const override;
+        /// The block at @a address, serialized as by `store`.
+        ///
+        /// Stored blocks were validated when stored: their bytes are served
+        /// as is, without decoding them.  Only registered if
+        /// `_stores_serialized`.
+        elle::Buffer
+        _fetch_serialized(Address address) const;
+        static
+        elle::Buffer
+        _serialize(blocks::Block const& block);
 
       /*-----.
       | Keys |
@@ -131,6 +141,7 @@ namespace memo
         ELLE_ATTRIBUTE_RX(std::unique_ptr<elle::reactor::network::UTPServer>, utp_server);
         ELLE_ATTRIBUTE(std::unique_ptr<elle::reactor::Thread>, utp_server_thread);
         ELLE_ATTRIBUTE(elle::reactor::Barrier, server_barrier);
+        ELLE_ATTRIBUTE(std::unique_ptr<elle::reactor::Thread>, filter_thread);
         ELLE_ATTRIBUTE_R(std::list<std::shared_ptr<Connection>>, peers);
       protected:
         virtual
@@ -479,7 +479,8 @@ namespace memo
         {
           ELLE_ASSERT(this->signature() != elle::Buffer());
           auto sign = this->_sign();
-          if (!this->_owner_key->verify(this->signature(), *sign))
+          if (!this->doughnut()->signature_cache().verify(
+                *this->_owner_key, this->signature(), *sign))
           {
             ELLE_TRACE("invalid signature for version %s: %x",
               this->_version, this->signature());
@@ -2,6 +2,7 @@
 
 #include <memo/model/doughnut/Peer.hh>
 #include <memo/model/blocks/MutableBlock.hh>
+#include <memo/model/MissingBlock.hh>
 
 ELLE_LOG_COMPONENT("memo.model.doughnut.Peer");
 
@@ -51,6 +52,48 @@ namespace memo
         return res;
       }
 
+      auto
+      Peer::fetch(std::vector<AddressVersion> const& addresses) const
+        -> FetchManyResult
+      {
+        ELLE_TRACE_SCOPE("%s: fetch %s blocks", this, addresses.size());
+        auto res = this->_fetch(addresses);
+        for (auto const& a: addresses)
+          if (a.second)
+          {
+            auto it = res.find(a.first);
+            if (it != res.end())
+              if (auto mb =
+                  dynamic_cast<blocks::MutableBlock*>(it->second.get()))
+                if (mb->version() == a.second.get())
+                  it->second.reset();
+          }
+        return res;
+      }
+
+      auto
+      Peer::_fetch(std::vector<AddressVersion> const& addresses) const
+        -> FetchManyResult
+      {
+        auto res = FetchManyResult{};
+        for (auto const& a: addresses)
+          try
+          {
+            res.emplace(a.first, this->fetch(a.first, a.second));
+          }
+          catch (MissingBlock const&)
+          {
+            ELLE_DEBUG("%s: block %f is missing", this, a.first);
+          }
+        return res;
+      }
+
+      bool
+      Peer::_stores_serialized() const
+      {
+        return true;
+      }
+
       /*-----.
       | Keys |
       `-----*/
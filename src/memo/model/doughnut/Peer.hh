@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 
 #include <boost/signals2.hpp>
 
@@ -45,12 +46,22 @@ namespace memo
       | Blocks |
       `-------*/
       public:
+        using AddressVersion = Model::AddressVersion;
+        /// Blocks fetched in one batch.
+        ///
+        /// A null block means the local version is up to date, an absent
+        /// address means the block is missing.
+        using FetchManyResult =
+          std::unordered_map<Address, std::unique_ptr<blocks::Block>>;
         virtual
         void
         store(blocks::Block const& block, StoreMode mode) = 0;
         std::unique_ptr<blocks::Block>
         fetch(Address address,
               boost::optional<int> local_version) const;
+        /// Fetch several blocks at once.
+        FetchManyResult
+        fetch(std::vector<AddressVersion> const& addresses) const;
         virtual
         void
         remove(Address address, blocks::RemoveSignature rs) = 0;
@@ -59,6 +70,15 @@ namespace memo
         std::unique_ptr<blocks::Block>
         _fetch(Address address,
                boost::optional<int> local_version) const = 0;
+        /// Fetch blocks one by one, override to batch them.
+        virtual
+        FetchManyResult
+        _fetch(std::vector<AddressVersion> const& addresses) const;
+        /// Whether blocks are stored serialized as by `store`, so they can
+        /// be served without decoding them.
+        virtual
+        bool
+        _stores_serialized() const;
 
       /*-----.
       | Keys |
@@ -194,6 +194,23 @@ namespace memo
         this->_connection->disconnect();
       }
 
+      prometheus::HistogramPtr const&
+      Remote::latency(std::string const& name)
+      {
+        static auto const family = prometheus::make_histogram_family(
+          "memo_remote_rpc_latency_seconds",
+          "How long remote procedure calls take");
+        static auto histograms =
+          std::unordered_map<std::string, prometheus::HistogramPtr>{};
+        auto it = histograms.find(name);
+        if (it == histograms.end())
+          it = histograms.emplace(
+            name,
+            prometheus::make(family, {{"rpc", name}},
+                             prometheus::latency_buckets())).first;
+        return it->second;
+      }
+
       /*-------.
       | Blocks |
       `-------*/
@@ -215,6 +232,21 @@ namespace memo
                     boost::optional<int> local_version) const
       {
         BENCH("fetch");
+        // Unless the peer can skip sending an up to date block, fetch the
+        // bytes it stores and decode them only here.
+        if (!local_version &&
+            this->_doughnut.version() >= elle::Version(0, 10, 0) &&
+            this->_stores_serialized())
+        {
+          using FetchSerialized = auto (Address) -> elle::Buffer;
+          auto fetch = elle::unconst(this)->make_rpc<FetchSerialized>(
+            "fetch_serialized");
+          auto data = fetch(address);
+          elle::serialization::Context ctx;
+          ctx.set<Doughnut*>(&this->_doughnut);
+          return elle::serialization::binary::deserialize<
+            std::unique_ptr<blocks::Block>>(data, true, ctx);
+        }
         using Fetch = auto (Address, boost::optional<int>)
           -> std::unique_ptr<blocks::Block>;
         auto fetch = elle::unconst(this)->make_rpc<Fetch>("fetch");
@@ -222,6 +254,20 @@ namespace memo
         return fetch(std::move(address), std::move(local_version));
       }
 
+      auto
+      Remote::_fetch(std::vector<AddressVersion> const& addresses) const
+        -> FetchManyResult
+      {
+        if (this->_doughnut.version() < elle::Version(0, 10, 0))
+          return Super::_fetch(addresses);
+        BENCH("fetch_many");
+        using FetchMany = auto (std::vector<AddressVersion> const&)
+          -> FetchManyResult;
+        auto fetch = elle::unconst(this)->make_rpc<FetchMany>("fetch_many");
+        fetch.set_context<Doughnut*>(&this->_doughnut);
+        return fetch(addresses);
+      }
+
       void
       Remote::remove(Address address, blocks::RemoveSignature rs)
       {
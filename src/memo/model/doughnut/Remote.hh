@@ -13,6 +13,7 @@
 #include <memo/model/doughnut/Doughnut.hh>
 #include <memo/model/doughnut/Peer.hh>
 #include <memo/model/doughnut/protocol.hh>
+#include <memo/model/prometheus.hh>
 
 #include <memo/RPC.hh>
 
@@ -106,6 +107,10 @@ namespace memo
         auto
         safe_perform(std::string const& name, Op op)
           -> decltype(op());
+        /// The latency histogram of remote procedures named @a name.
+        static
+        prometheus::HistogramPtr const&
+        latency(std::string const& name);
       private:
         ELLE_ATTRIBUTE(Protocol, protocol);
 
@@ -121,6 +126,8 @@ namespace memo
         std::unique_ptr<blocks::Block>
         _fetch(Address address,
               boost::optional<int> local_version) const override;
+        FetchManyResult
+        _fetch(std::vector<AddressVersion> const& addresses) const override;
 
       /*-----.
       | Keys |
@@ -19,6 +19,7 @@ namespace memo
       typename RPC<F>::result_type
       RemoteRPC<F>::operator()(Args const& ... args)
       {
+        prometheus::Timer timer(Remote::latency(this->name()));
         // GCC bug, argument packs dont work in lambdas
         auto helper = std::bind(&remote_call_next<F, Args...>,
           this, std::ref(args)...);
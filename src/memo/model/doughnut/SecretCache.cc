@@ -0,0 +1,106 @@
+#include <memo/model/doughnut/SecretCache.hh>
+
+#include <elle/log.hh>
+
+#include <elle/cryptography/hash.hh>
+
+#include <memo/environ.hh>
+
+ELLE_LOG_COMPONENT("memo.model.doughnut.SecretCache");
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace
+      {
+        /// Rough memory held by a cached secret and its key.
+        auto const secret_size = uint64_t(256);
+        /// Rough memory held by a cached RSA key pair.
+        auto const key_pair_size = uint64_t(2048);
+
+        std::string
+        token_key(elle::Buffer const& token,
+                  elle::cryptography::rsa::PublicKey const& recipient)
+        {
+          auto buffer =
+            elle::cryptography::rsa::publickey::der::encode(recipient);
+          buffer.append(token.contents(), token.size());
+          return elle::cryptography::hash(
+            buffer, elle::cryptography::Oneway::sha256).string();
+        }
+      }
+
+      SecretCache::SecretCache(uint64_t capacity)
+        : _secret_hits(0)
+        , _secret_misses(0)
+        , _group_hits(0)
+        , _group_misses(0)
+        , _secrets(capacity)
+        , _groups(capacity)
+      {}
+
+      SecretCache::SecretCache()
+        : SecretCache(memo::getenv("ACB_KEY_CACHE_SIZE", 4 * 1024 * 1024))
+      {}
+
+      SecretCache::Secret
+      SecretCache::secret(elle::Buffer const& token,
+                          elle::cryptography::rsa::PublicKey const& recipient,
+                          std::function<Secret ()> const& open)
+      {
+        auto const key = token_key(token, recipient);
+        if (auto res = this->_secrets.find(key))
+        {
+          ++this->_secret_hits;
+          return *res;
+        }
+        ++this->_secret_misses;
+        auto res = open();
+        this->_secrets.insert(key, res, secret_size);
+        return res;
+      }
+
+      SecretCache::GroupKeys
+      SecretCache::group_keys(elle::cryptography::rsa::PublicKey const& group,
+                              int version,
+                              std::function<GroupKeys ()> const& fetch)
+      {
+        // Group keys are only ever appended, so known versions stay valid.
+        if (auto res = this->_groups.find(group))
+          if (version < signed(res->size()))
+          {
+            ++this->_group_hits;
+            return *res;
+          }
+        ++this->_group_misses;
+        auto res = fetch();
+        ELLE_DEBUG("%s: cache %s keys of group %s", this, res.size(), group);
+        this->_groups.insert(group, res, key_pair_size * res.size());
+        return res;
+      }
+
+      void
+      SecretCache::clear()
+      {
+        this->_secrets.clear();
+        this->_groups.clear();
+      }
+
+      elle::json::Object
+      SecretCache::stats() const
+      {
+        return {
+          {"secrets", this->_secrets.count()},
+          {"secret_hits", this->_secret_hits},
+          {"secret_misses", this->_secret_misses},
+          {"groups", this->_groups.count()},
+          {"group_hits", this->_group_hits},
+          {"group_misses", this->_group_misses},
+        };
+      }
+    }
+  }
+}
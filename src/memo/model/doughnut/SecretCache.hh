@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+#include <elle/json/json.hh>
+
+#include <elle/cryptography/SecretKey.hh>
+#include <elle/cryptography/rsa/KeyPair.hh>
+#include <elle/cryptography/rsa/PublicKey.hh>
+
+#include <memo/model/doughnut/TinyLFU.hh>
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      /// Keys unwrapped to read ACBs, so reading an unchanged block again
+      /// only costs a symmetric decipher.
+      ///
+      /// Secrets are cached by digest of their token and the public key it
+      /// was wrapped for, and only ever handed to callers holding the
+      /// matching private key.  Group keys are cached by group, and fetched
+      /// again when a block announces a version we do not know yet.  Both
+      /// live in memory only, bounded in size.
+      class SecretCache
+      {
+      public:
+        using Secret = elle::cryptography::SecretKey;
+        using GroupKeys = std::vector<elle::cryptography::rsa::KeyPair>;
+        /// Build a cache holding about @a capacity bytes of each kind of
+        /// key.
+        SecretCache(uint64_t capacity);
+        /// Build a cache sized from the environment.
+        SecretCache();
+        /// The secret @a token holds for @a recipient, calling @a open to
+        /// unwrap it unless cached.
+        Secret
+        secret(elle::Buffer const& token,
+               elle::cryptography::rsa::PublicKey const& recipient,
+               std::function<Secret ()> const& open);
+        /// The keys of @a group, at least up to @a version, calling
+        /// @a fetch to get them unless cached.
+        GroupKeys
+        group_keys(elle::cryptography::rsa::PublicKey const& group,
+                   int version,
+                   std::function<GroupKeys ()> const& fetch);
+        void
+        clear();
+        elle::json::Object
+        stats() const;
+        ELLE_ATTRIBUTE_R(int64_t, secret_hits);
+        ELLE_ATTRIBUTE_R(int64_t, secret_misses);
+        ELLE_ATTRIBUTE_R(int64_t, group_hits);
+        ELLE_ATTRIBUTE_R(int64_t, group_misses);
+
+      private:
+        ELLE_ATTRIBUTE((consensus::TinyLFU<std::string, Secret>), secrets);
+        ELLE_ATTRIBUTE(
+          (consensus::TinyLFU<elle::cryptography::rsa::PublicKey, GroupKeys>),
+          groups);
+      };
+    }
+  }
+}
@@ -0,0 +1,85 @@
+#include <memo/model/doughnut/SignatureCache.hh>
+
+#include <elle/log.hh>
+
+#include <elle/cryptography/hash.hh>
+
+#include <memo/environ.hh>
+
+ELLE_LOG_COMPONENT("memo.model.doughnut.SignatureCache");
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace
+      {
+        /// Rough memory held by a cached digest.
+        auto const entry_size = uint64_t(96);
+
+        std::string
+        signature_key(elle::cryptography::rsa::PublicKey const& key,
+                      elle::Buffer const& signature,
+                      elle::Buffer const& data)
+        {
+          // DER encodings are self delimiting and digests have a fixed size,
+          // so no two triples share a preimage.
+          auto buffer = elle::cryptography::rsa::publickey::der::encode(key);
+          auto const digest = elle::cryptography::hash(
+            data, elle::cryptography::Oneway::sha256);
+          buffer.append(digest.contents(), digest.size());
+          buffer.append(signature.contents(), signature.size());
+          return elle::cryptography::hash(
+            buffer, elle::cryptography::Oneway::sha256).string();
+        }
+      }
+
+      SignatureCache::SignatureCache(uint64_t capacity)
+        : _hits(0)
+        , _misses(0)
+        , _verified(capacity)
+      {}
+
+      SignatureCache::SignatureCache()
+        : SignatureCache(memo::getenv("SIGNATURE_CACHE_SIZE", 1024 * 1024))
+      {}
+
+      bool
+      SignatureCache::verify(elle::cryptography::rsa::PublicKey const& key,
+                             elle::Buffer const& signature,
+                             elle::Buffer const& data)
+      {
+        auto const digest = signature_key(key, signature, data);
+        if (this->_verified.find(digest))
+        {
+          ++this->_hits;
+          return true;
+        }
+        ++this->_misses;
+        if (!key.verify(signature, data))
+          return false;
+        ELLE_DUMP("%s: record valid signature %x", this, signature);
+        this->_verified.insert(digest, true, entry_size);
+        return true;
+      }
+
+      void
+      SignatureCache::clear()
+      {
+        this->_verified.clear();
+      }
+
+      elle::json::Object
+      SignatureCache::stats() const
+      {
+        return {
+          {"signatures", this->_verified.count()},
+          {"hits", this->_hits},
+          {"misses", this->_misses},
+        };
+      }
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+#include <elle/json/json.hh>
+
+#include <elle/cryptography/rsa/PublicKey.hh>
+
+#include <memo/model/doughnut/TinyLFU.hh>
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      /// Signatures known to be valid, so validating a block fetched again,
+      /// or stored again by a peer, does not verify its signatures again.
+      ///
+      /// Entries are keyed by a digest of the key, the signature and the
+      /// signed data, and only successful verifications are recorded: a
+      /// lookup succeeds exactly when the verification would.  Entries live
+      /// in memory only, bounded in size.
+      class SignatureCache
+      {
+      public:
+        /// Build a cache holding about @a capacity bytes of entries.
+        SignatureCache(uint64_t capacity);
+        /// Build a cache sized from the environment.
+        SignatureCache();
+        /// Whether @a signature of @a data by @a key is valid.
+        bool
+        verify(elle::cryptography::rsa::PublicKey const& key,
+               elle::Buffer const& signature,
+               elle::Buffer const& data);
+        void
+        clear();
+        elle::json::Object
+        stats() const;
+        ELLE_ATTRIBUTE_R(int64_t, hits);
+        ELLE_ATTRIBUTE_R(int64_t, misses);
+
+      private:
+        ELLE_ATTRIBUTE((consensus::TinyLFU<std::string, bool>), verified);
+      };
+    }
+  }
+}
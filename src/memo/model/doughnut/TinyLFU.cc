@@ -0,0 +1,86 @@
+#include <memo/model/doughnut/TinyLFU.hh>
+
+#include <algorithm>
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        namespace
+        {
+          std::size_t
+          _width(std::size_t entries)
+          {
+            auto res = std::size_t(16);
+            while (res < entries)
+              res *= 2;
+            return res;
+          }
+
+          uint64_t const seeds[] = {
+            0xc3a5c85c97cb3127ull,
+            0xb492b66fbe98f273ull,
+            0x9ae16a3b2f90404full,
+            0xcbf29ce484222325ull,
+          };
+        }
+
+        FrequencySketch::FrequencySketch(std::size_t entries)
+          : _counters(_width(entries), 0)
+          , _additions(0)
+          , _sample_size(10 * std::max(entries, std::size_t(16)))
+        {}
+
+        std::size_t
+        FrequencySketch::_index(std::size_t hash, int i) const
+        {
+          auto h = (uint64_t(hash) + seeds[i]) * seeds[i];
+          h ^= h >> 32;
+          // The width is a power of two.
+          return h & (this->_counters.size() - 1);
+        }
+
+        void
+        FrequencySketch::increment(std::size_t hash)
+        {
+          auto added = false;
+          for (int i = 0; i < 4; ++i)
+          {
+            auto& counter = this->_counters[this->_index(hash, i)];
+            if (counter < 15)
+            {
+              ++counter;
+              added = true;
+            }
+          }
+          if (added && ++this->_additions >= this->_sample_size)
+          {
+            for (auto& counter: this->_counters)
+              counter /= 2;
+            this->_additions /= 2;
+          }
+        }
+
+        int
+        FrequencySketch::frequency(std::size_t hash) const
+        {
+          auto res = 15;
+          for (int i = 0; i < 4; ++i)
+            res = std::min<int>(res, this->_counters[this->_index(hash, i)]);
+          return res;
+        }
+
+        void
+        FrequencySketch::clear()
+        {
+          std::fill(this->_counters.begin(), this->_counters.end(), 0);
+          this->_additions = 0;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <elle/assert.hh>
+#include <elle/attribute.hh>
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        /// Approximate access frequencies of keys, by their hash.
+        ///
+        /// A count-min sketch of 4-bit counters, halved every so many
+        /// increments so that past popularity fades.
+        class FrequencySketch
+        {
+        public:
+          /// Build a sketch able to tell apart about @a entries keys.
+          FrequencySketch(std::size_t entries);
+          void
+          increment(std::size_t hash);
+          int
+          frequency(std::size_t hash) const;
+          void
+          clear();
+        private:
+          std::size_t
+          _index(std::size_t hash, int i) const;
+          ELLE_ATTRIBUTE(std::vector<uint8_t>, counters);
+          ELLE_ATTRIBUTE(std::size_t, additions);
+          ELLE_ATTRIBUTE(std::size_t, sample_size);
+        };
+
+        /// A byte-bounded cache with the W-TinyLFU policy.
+        ///
+        /// New entries enter a small LRU window.  Entries leaving the window
+        /// only join the main segmented LRU if they were more frequently
+        /// requested than the main entry they would evict, which keeps
+        /// one-shot scans from flushing popular entries.  Lookups, insertions
+        /// and evictions are constant time.
+        template <typename Key, typename Value, typename Hash = std::hash<Key>>
+        class TinyLFU
+        {
+        public:
+          /// Build a cache holding at most @a capacity bytes.
+          TinyLFU(uint64_t capacity);
+          /// The value for @a key if cached, recording the access.
+          Value*
+          find(Key const& key);
+          /// The value for @a key if cached, without recording the access.
+          Value*
+          peek(Key const& key);
+          /// Cache or replace @a value for @a key, accounting @a size bytes.
+          ///
+          /// @return Whether the value is cached after eviction.
+          bool
+          insert(Key const& key, Value value, uint64_t size);
+          /// Account @a size bytes for @a key, after updating it in place.
+          ///
+          /// @return Whether the value is cached after eviction.
+          bool
+          resize(Key const& key, uint64_t size);
+          /// Drop @a key.
+          ///
+          /// @return Whether it was cached.
+          bool
+          erase(Key const& key);
+          /// Drop the entries matching @a predicate.
+          void
+          erase_if(std::function<bool (Key const&, Value const&)> predicate);
+          /// Invoke @a f on every entry.
+          void
+          each(std::function<void (Key const&, Value&)> const& f);
+          void
+          clear();
+          std::size_t
+          count() const;
+          /// Maximum bytes held.
+          ELLE_ATTRIBUTE_R(uint64_t, capacity);
+          /// Bytes held.
+          ELLE_ATTRIBUTE_R(uint64_t, size);
+
+        private:
+          enum class Segment
+          {
+            window,
+            probation,
+            protection,
+          };
+          using List = std::list<Key>;
+          struct Entry
+          {
+            Value value;
+            uint64_t size;
+            Segment segment;
+            typename List::iterator position;
+          };
+          using Entries = std::unordered_map<Key, Entry, Hash>;
+          List&
+          _list(Segment segment);
+          uint64_t&
+          _bytes(Segment segment);
+          void
+          _move(Entry& entry, Segment segment);
+          typename Entries::iterator
+          _remove(typename Entries::iterator it);
+          /// Move overflowing window entries to the main segments.
+          void
+          _evict();
+          /// Move overflowing protection entries back to probation.
+          void
+          _demote();
+          ELLE_ATTRIBUTE(Entries, entries);
+          ELLE_ATTRIBUTE(List, window);
+          ELLE_ATTRIBUTE(List, probation);
+          ELLE_ATTRIBUTE(List, protection);
+          ELLE_ATTRIBUTE(uint64_t, window_bytes);
+          ELLE_ATTRIBUTE(uint64_t, probation_bytes);
+          ELLE_ATTRIBUTE(uint64_t, protection_bytes);
+          ELLE_ATTRIBUTE(FrequencySketch, sketch);
+          ELLE_ATTRIBUTE(Hash, hash);
+        };
+      }
+    }
+  }
+}
+
+#include <memo/model/doughnut/TinyLFU.hxx>
@@ -0,0 +1,270 @@
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        template <typename Key, typename Value, typename Hash>
+        TinyLFU<Key, Value, Hash>::TinyLFU(uint64_t capacity)
+          : _capacity(capacity)
+          , _size(0)
+          , _window_bytes(0)
+          , _probation_bytes(0)
+          , _protection_bytes(0)
+          // Mutable blocks are mostly small, size the sketch for 1 KiB ones.
+          , _sketch(capacity / 1024)
+        {}
+
+        template <typename Key, typename Value, typename Hash>
+        Value*
+        TinyLFU<Key, Value, Hash>::find(Key const& key)
+        {
+          this->_sketch.increment(this->_hash(key));
+          auto it = this->_entries.find(key);
+          if (it == this->_entries.end())
+            return nullptr;
+          auto& entry = it->second;
+          switch (entry.segment)
+          {
+            case Segment::window:
+              this->_move(entry, Segment::window);
+              break;
+            case Segment::probation:
+              this->_move(entry, Segment::protection);
+              this->_demote();
+              break;
+            case Segment::protection:
+              this->_move(entry, Segment::protection);
+              break;
+          }
+          return &entry.value;
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        Value*
+        TinyLFU<Key, Value, Hash>::peek(Key const& key)
+        {
+          auto it = this->_entries.find(key);
+          if (it == this->_entries.end())
+            return nullptr;
+          return &it->second.value;
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        bool
+        TinyLFU<Key, Value, Hash>::insert(Key const& key,
+                                          Value value,
+                                          uint64_t size)
+        {
+          this->_sketch.increment(this->_hash(key));
+          auto it = this->_entries.find(key);
+          if (it != this->_entries.end())
+          {
+            auto& entry = it->second;
+            entry.value = std::move(value);
+            this->_bytes(entry.segment) += size - entry.size;
+            this->_size += size - entry.size;
+            entry.size = size;
+            this->_move(entry, entry.segment);
+          }
+          else
+          {
+            if (size > this->_capacity)
+              return false;
+            this->_window.emplace_front(key);
+            this->_entries.emplace(
+              key,
+              Entry{std::move(value), size, Segment::window,
+                    this->_window.begin()});
+            this->_window_bytes += size;
+            this->_size += size;
+          }
+          this->_demote();
+          this->_evict();
+          return this->_entries.find(key) != this->_entries.end();
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        bool
+        TinyLFU<Key, Value, Hash>::resize(Key const& key, uint64_t size)
+        {
+          auto it = this->_entries.find(key);
+          if (it == this->_entries.end())
+            return false;
+          auto& entry = it->second;
+          this->_bytes(entry.segment) += size - entry.size;
+          this->_size += size - entry.size;
+          entry.size = size;
+          this->_demote();
+          this->_evict();
+          return this->_entries.find(key) != this->_entries.end();
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        bool
+        TinyLFU<Key, Value, Hash>::erase(Key const& key)
+        {
+          auto it = this->_entries.find(key);
+          if (it == this->_entries.end())
+            return false;
+          this->_remove(it);
+          return true;
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        void
+        TinyLFU<Key, Value, Hash>::erase_if(
+          std::function<bool (Key const&, Value const&)> predicate)
+        {
+          for (auto it = this->_entries.begin(); it != this->_entries.end();)
+            if (predicate(it->first, it->second.value))
+              it = this->_remove(it);
+            else
+              ++it;
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        void
+        TinyLFU<Key, Value, Hash>::each(
+          std::function<void (Key const&, Value&)> const& f)
+        {
+          for (auto& entry: this->_entries)
+            f(entry.first, entry.second.value);
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        void
+        TinyLFU<Key, Value, Hash>::clear()
+        {
+          this->_entries.clear();
+          this->_window.clear();
+          this->_probation.clear();
+          this->_protection.clear();
+          this->_size = 0;
+          this->_window_bytes = 0;
+          this->_probation_bytes = 0;
+          this->_protection_bytes = 0;
+          this->_sketch.clear();
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        std::size_t
+        TinyLFU<Key, Value, Hash>::count() const
+        {
+          return this->_entries.size();
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        auto
+        TinyLFU<Key, Value, Hash>::_list(Segment segment)
+          -> List&
+        {
+          switch (segment)
+          {
+            case Segment::window:
+              return this->_window;
+            case Segment::probation:
+              return this->_probation;
+            case Segment::protection:
+              return this->_protection;
+          }
+          elle::unreachable();
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        uint64_t&
+        TinyLFU<Key, Value, Hash>::_bytes(Segment segment)
+        {
+          switch (segment)
+          {
+            case Segment::window:
+              return this->_window_bytes;
+            case Segment::probation:
+              return this->_probation_bytes;
+            case Segment::protection:
+              return this->_protection_bytes;
+          }
+          elle::unreachable();
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        void
+        TinyLFU<Key, Value, Hash>::_move(Entry& entry, Segment segment)
+        {
+          auto& to = this->_list(segment);
+          to.splice(to.begin(), this->_list(entry.segment), entry.position);
+          this->_bytes(entry.segment) -= entry.size;
+          this->_bytes(segment) += entry.size;
+          entry.segment = segment;
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        auto
+        TinyLFU<Key, Value, Hash>::_remove(typename Entries::iterator it)
+          -> typename Entries::iterator
+        {
+          auto& entry = it->second;
+          this->_list(entry.segment).erase(entry.position);
+          this->_bytes(entry.segment) -= entry.size;
+          this->_size -= entry.size;
+          return this->_entries.erase(it);
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        void
+        TinyLFU<Key, Value, Hash>::_demote()
+        {
+          auto const main = this->_capacity - this->_capacity / 100;
+          while (this->_protection_bytes > main / 5 * 4)
+            this->_move(this->_entries.at(this->_protection.back()),
+                        Segment::probation);
+        }
+
+        template <typename Key, typename Value, typename Hash>
+        void
+        TinyLFU<Key, Value, Hash>::_evict()
+        {
+          auto const window = this->_capacity / 100;
+          auto const main = this->_capacity - window;
+          auto const main_bytes = [this]
+            {
+              return this->_probation_bytes + this->_protection_bytes;
+            };
+          // Window entries compete with the least recently used main entry
+          // for admission.
+          while (this->_window_bytes > window)
+          {
+            auto candidate = this->_entries.find(this->_window.back());
+            this->_move(candidate->second, Segment::probation);
+            auto const frequency =
+              this->_sketch.frequency(this->_hash(candidate->first));
+            while (main_bytes() > main)
+            {
+              // The candidate is at the front of probation.
+              auto const victim =
+                this->_probation.size() > 1 ? &this->_probation.back()
+                : !this->_protection.empty() ? &this->_protection.back()
+                : nullptr;
+              if (!victim ||
+                  this->_sketch.frequency(this->_hash(*victim)) >= frequency)
+              {
+                this->_remove(candidate);
+                break;
+              }
+              this->_remove(this->_entries.find(*victim));
+            }
+          }
+          // Entries growing in place can overflow the main segments too.
+          while (main_bytes() > main)
+          {
+            auto& victims =
+              this->_probation.empty() ? this->_protection : this->_probation;
+            this->_remove(this->_entries.find(victims.back()));
+          }
+        }
+      }
+    }
+  }
+}
@@ -1,16 +1,20 @@
 #include <memo/model/doughnut/consensus/Paxos.hh>
 
 #include <functional>
+#include <map>
 #include <utility>
 
 #include <boost/algorithm/cxx11/any_of.hpp>
+#include <boost/crc.hpp>
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/range/algorithm/sort.hpp>
 
 #include <elle/algorithm.hh>
 #include <elle/bench.hh>
+#include <elle/finally.hh>
 #include <elle/find.hh>
+#include <elle/make-vector.hh>
 #include <elle/memory.hh>
 #include <elle/multi_index_container.hh>
 #include <elle/random.hh>
@@ -23,9 +27,11 @@
 #include <elle/das/serializer.hh>
 
 #include <elle/reactor/Backoff.hh>
+#include <elle/reactor/Barrier.hh>
 #include <elle/reactor/for-each.hh>
 
 #include <memo/RPC.hh>
+#include <memo/environ.hh>
 
 #include <memo/model/Conflict.hh>
 #include <memo/model/MissingBlock.hh>
@@ -37,6 +43,7 @@
 #include <memo/model/blocks/ImmutableBlock.hh>
 #include <memo/model/doughnut/OKB.hh>
 #include <memo/model/doughnut/ValidationFailed.hh>
+#include <memo/model/prometheus.hh>
 #include <memo/silo/MissingKey.hh>
 
 ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Paxos");
@@ -48,6 +55,76 @@ ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Paxos");
 ELLE_DAS_SERIALIZE(
   memo::model::doughnut::consensus::Paxos::PaxosServer::Response);
 
+namespace
+{
+  /// Steps logged before the acceptor state is stored whole again.
+  auto const max_steps = 16u;
+
+  /// Where the acceptor steps of @a address are logged, unless addresses
+  /// of @a version are not flagged or its flag byte is that of metadata
+  /// already.
+  boost::optional<memo::model::Address>
+  metadata_key(memo::model::Address const& address,
+               elle::Version const& version)
+  {
+    using memo::model::Address;
+    namespace flags = memo::model::flags;
+    if (version < elle::Version(0, 5, 0) ||
+        address.value()[Address::flag_byte] == flags::block_metadata)
+      return boost::none;
+    return Address(address.value(), flags::block_metadata, true);
+  }
+
+  uint32_t
+  checksum(elle::ConstWeakBuffer data)
+  {
+    auto crc = boost::crc_32_type{};
+    crc.process_bytes(data.contents(), data.size());
+    return crc.checksum();
+  }
+
+  /// Bytes stored by a replica per consensus round, relative to the size
+  /// of the block.
+  memo::prometheus::HistogramPtr&
+  write_amplification()
+  {
+    static auto const family = memo::prometheus::make_histogram_family(
+      "memo_paxos_write_amplification",
+      "Bytes stored per consensus round relative to the block size");
+    static auto res = memo::prometheus::make(
+      family, {}, {1, 1.1, 1.25, 1.5, 2, 3, 4, 8});
+    return res;
+  }
+
+  /// Reads of mutable blocks served under a lease, without a quorum.
+  memo::prometheus::CounterPtr&
+  leased_reads()
+  {
+    static auto const family = memo::prometheus::make_counter_family(
+      "memo_paxos_leased_reads",
+      "Mutable block reads served locally under a lease");
+    static auto res = memo::prometheus::make(family, {});
+    return res;
+  }
+
+  /// Drop the expired entries of @a leases once they reach @a threshold,
+  /// and push the threshold further as much as they hold live entries.
+  template <typename Leases>
+  void
+  prune(Leases& leases, std::size_t& threshold)
+  {
+    if (leases.size() < threshold)
+      return;
+    auto const now = std::chrono::steady_clock::now();
+    for (auto it = leases.begin(); it != leases.end();)
+      if (it->second.expiry <= now)
+        it = leases.erase(it);
+      else
+        ++it;
+    threshold = std::max<std::size_t>(2 * leases.size(), 64);
+  }
+}
+
 namespace memo
 {
   namespace model
@@ -164,13 +241,17 @@ namespace memo
                      bool lenient_fetch,
                      bool rebalance_auto_expand,
                      bool rebalance_inspect,
-                     std::chrono::system_clock::duration node_timeout)
+                     std::chrono::system_clock::duration node_timeout,
+                     std::chrono::system_clock::duration read_lease)
           : Super(doughnut)
           , _factor(factor)
           , _lenient_fetch(memo::getenv("PAXOS_LENIENT_FETCH", lenient_fetch))
           , _rebalance_auto_expand(rebalance_auto_expand)
           , _rebalance_inspect(rebalance_inspect)
           , _node_timeout(node_timeout)
+          , _read_lease(read_lease)
+          , _batch_window(memo::getenv("PAXOS_BATCH_WINDOW", 0))
+          , _leases_prune(64)
         {}
 
         /*--------.
@@ -188,6 +269,7 @@ namespace memo
             this->_rebalance_auto_expand,
             this->_rebalance_inspect,
             this->_node_timeout,
+            this->_read_lease,
             this->doughnut(),
             this->doughnut().id(),
             std::move(storage),
@@ -296,6 +378,20 @@ namespace memo
               [&]
               {
                 this->_missing = false;
+                if (auto prefetched = std::move(this->_prefetched))
+                {
+                  this->_prefetched.reset();
+                  if (!prefetched->second)
+                    return std::move(prefetched->first);
+                  else if (std::dynamic_pointer_cast<MissingBlock>(
+                             prefetched->second))
+                  {
+                    this->_missing = true;
+                    throw MissingBlock(this->_address);
+                  }
+                  // Other errors are reproduced by a plain get, which
+                  // preserves their type.
+                }
                 try
                 {
                   return member->get(q, this->_address, this->_local_version);
@@ -308,11 +404,19 @@ namespace memo
               });
           }
 
+          /// Answer the next get with a result fetched in a batch.
+          void
+          prefetch(Paxos::AcceptedOrError result)
+          {
+            this->_prefetched.emplace(std::move(result));
+          }
+
           ELLE_ATTRIBUTE_R(std::ambivalent_ptr<Paxos::Peer>, member);
           ELLE_ATTRIBUTE(Address, address);
           ELLE_ATTRIBUTE(boost::optional<int>, local_version);
           ELLE_ATTRIBUTE(bool, insert);
           ELLE_ATTRIBUTE_R(boost::optional<bool>, missing);
+          ELLE_ATTRIBUTE(boost::optional<Paxos::AcceptedOrError>, prefetched);
         };
 
         /*--------.
@@ -541,6 +645,85 @@ namespace memo
               }
           }
 
+          /// Run the quorum reads of mutable blocks in batches.
+          ///
+          /// Addresses are grouped by quorum and each member of a quorum is
+          /// sent a single get_many per batch. Answers are handed to the
+          /// matching PaxosPeer so the subsequent Paxos round does not
+          /// contact it again.
+          static
+          void
+          _get_many(
+            std::unordered_map<Address, Peers>& peers,
+            std::unordered_map<Address, boost::optional<int>> const& versions)
+          {
+            static auto const batch_size =
+              std::max(memo::getenv("MULTIFETCH_BATCH_SIZE", 256), 1);
+            auto groups = std::map<PaxosServer::Quorum, std::vector<Address>>{};
+            for (auto const& p: peers)
+              if (p.first.mutable_block() && !p.second.empty())
+              {
+                auto q = PaxosServer::Quorum{};
+                for (auto const& peer: p.second)
+                  q.insert(peer->id());
+                groups[q].emplace_back(p.first);
+              }
+            using Batch = std::pair<PaxosServer::Quorum, std::vector<Address>>;
+            auto batches = std::vector<Batch>{};
+            for (auto const& g: groups)
+            {
+              auto const& all = g.second;
+              for (auto it = all.begin(); it != all.end();)
+              {
+                auto const end =
+                  it + std::min<std::ptrdiff_t>(batch_size, all.end() - it);
+                batches.emplace_back(g.first, std::vector<Address>(it, end));
+                it = end;
+              }
+            }
+            auto const find = [&] (Address const& address, Address const& id)
+              -> PaxosPeer*
+              {
+                auto it = peers.find(address);
+                if (it != peers.end())
+                  for (auto& peer: it->second)
+                    if (peer->id() == id)
+                      return peer.get();
+                return nullptr;
+              };
+            elle::reactor::for_each_parallel(
+              batches,
+              [&] (Batch const& batch)
+              {
+                auto const local_versions = elle::make_vector(
+                  batch.second,
+                  [&] (Address const& a) { return versions.at(a); });
+                elle::reactor::for_each_parallel(
+                  batch.first,
+                  [&] (Address const& id)
+                  {
+                    auto peer = find(batch.second.front(), id);
+                    auto member = peer ? peer->member().lock() : nullptr;
+                    if (!member)
+                      return;
+                    try
+                    {
+                      auto res = member->get_many(
+                        batch.first, batch.second, local_versions);
+                      for (auto& r: res)
+                        if (auto target = find(r.first, id))
+                          target->prefetch(std::move(r.second));
+                    }
+                    catch (elle::Error const& e)
+                    {
+                      ELLE_TRACE("batched get of %s addresses from %f "
+                                 "failed: %s", batch.second.size(), id, e);
+                    }
+                  },
+                  elle::print("get_many"));
+              },
+              elle::print("multifetch get_many"));
+          }
 
           template <typename Quorum>
           static
@@ -611,6 +794,50 @@ namespace memo
           : Super(dht, id)
         {}
 
+        bool
+        Paxos::Peer::_stores_serialized() const
+        {
+          return false;
+        }
+
+        Paxos::GetMultiResult
+        Paxos::Peer::get_many(
+          PaxosServer::Quorum const& peers,
+          std::vector<Address> const& addresses,
+          std::vector<boost::optional<int>> const& local_versions)
+        {
+          ELLE_TRACE_SCOPE("%s: get %s addresses from %f",
+                           this, addresses.size(), peers);
+          if (addresses.size() != local_versions.size())
+            elle::err("get_many of %s addresses with %s versions",
+                      addresses.size(), local_versions.size());
+          auto res = GetMultiResult{};
+          for (auto i = 0u; i < addresses.size(); ++i)
+          {
+            auto const& address = addresses[i];
+            try
+            {
+              res.emplace(
+                address,
+                AcceptedOrError(
+                  this->get(peers, address, local_versions[i]), nullptr));
+            }
+            catch (MissingBlock const& e)
+            {
+              res.emplace(
+                address,
+                AcceptedOrError(boost::none, std::make_shared<MissingBlock>(e)));
+            }
+            catch (elle::Error const& e)
+            {
+              res.emplace(
+                address,
+                AcceptedOrError(boost::none, std::make_shared<elle::Error>(e)));
+            }
+          }
+          return res;
+        }
+
         /*-----------.
         | RemotePeer |
         `-----------*/
@@ -712,6 +939,26 @@ namespace memo
           return get(peers, address, local_version);
         }
 
+        Paxos::GetMultiResult
+        Paxos::RemotePeer::get_many(
+          PaxosServer::Quorum const& peers,
+          std::vector<Address> const& addresses,
+          std::vector<boost::optional<int>> const& local_versions)
+        {
+          if (this->_doughnut.version() >= elle::Version(0, 10, 0))
+          {
+            using GetMany =
+              auto (PaxosServer::Quorum,
+                    std::vector<Address> const&,
+                    std::vector<boost::optional<int>> const&)
+              -> GetMultiResult;
+            auto get_many = this->make_rpc<GetMany>("get_many");
+            get_many.set_context<Doughnut*>(&this->_doughnut);
+            return get_many(peers, addresses, local_versions);
+          }
+          return Paxos::Peer::get_many(peers, addresses, local_versions);
+        }
+
         bool
         Paxos::RemotePeer::reconcile(Address address)
         {
@@ -803,9 +1050,14 @@ namespace memo
                   {
                     ELLE_TRACE_SCOPE("%s: inspect disk blocks for rebalancing",
                                      this);
-                    for (auto const& address: this->storage()->list())
+                    auto const addresses = this->storage()->list();
+                    this->_to_inspect = addresses.size();
+                    for (auto const& address: addresses)
                     {
-                      elle::reactor::sleep(100ms);
+                      // Share the rebalancing budget rather than starve
+                      // repairs.
+                      this->_rebalancer.throttle();
+                      ++this->_inspected;
                       try
                       {
                         auto b = this->_load(address);
@@ -839,6 +1091,7 @@ namespace memo
           this->_cleaning_up = true;
           this->_rebalance_inspector.reset();
           this->_rebalance_thread.terminate_now();
+          this->_rebalancer.terminate();
           this->_evict_threads.clear();
           Super::_cleanup();
         }
@@ -865,6 +1118,11 @@ namespace memo
             auto stored =
               elle::serialization::binary::deserialize<BlockOrPaxos>(
                 buffer, true, context);
+            if (stored.paxos)
+            {
+              stored.paxos->base = checksum(buffer);
+              this->_replay(address, *stored.paxos);
+            }
             if (stored.block)
             {
               if (this->_rebalance_auto_expand)
@@ -1063,218 +1321,307 @@ namespace memo
           // FIXME: move the range.
           auto blocks = elle::make_vector(range,
             [] (NodeBlock const& nb) { return nb.block; });
+          // Blocks mostly share a few quorums: look their remaining members
+          // up once per quorum rather than once per block.
+          auto members = std::make_shared<
+            std::map<Quorum, std::vector<overlay::Overlay::WeakMember>>>();
           for (auto address: blocks)
           {
-            ELLE_TRACE_SCOPE("%s: evict %f from %f quorum",
-                             this, lost_id, address);
-            auto block = this->_load(address);
-            if (block.paxos)
+            auto const replicas = [&]
+              {
+                auto it = this->_quorums.find(address);
+                return it != this->_quorums.end()
+                  ? it->replication_factor() - 1 : 0;
+              }();
+            this->_rebalancer.schedule(
+              address, Rebalancer::Kind::evict, replicas,
+              [this, lost_id, address, members]
+              {
+                this->_evict(lost_id, address, *members);
+                return int64_t(0);
+              },
+              // Members of a quorum lost together are each evicted.
+              lost_id);
+          }
+        }
+
+        void
+        Paxos::LocalPeer::_evict(
+          Address lost_id,
+          Address address,
+          std::map<Quorum, std::vector<overlay::Overlay::WeakMember>>& members)
+        {
+          ELLE_LOG_COMPONENT(
+            "memo.model.doughnut.consensus.Paxos.rebalance");
+          ELLE_TRACE_SCOPE("%s: evict %f from %f quorum",
+                           this, lost_id, address);
+          auto block = this->_load(address);
+          if (block.paxos)
+          {
+            auto& decision = *block.paxos;
+            auto q = decision.paxos.current_quorum();
+            while (true)
             {
-              auto& decision = *block.paxos;
-              auto q = decision.paxos.current_quorum();
-              while (true)
+              try
               {
-                try
-                {
-                  Paxos::PaxosClient client(
-                    this->doughnut().id(),
-                    Details::lookup_nodes(this->_paxos.doughnut(), q, address));
-                  if (q.erase(lost_id))
-                  {
-                    client.choose(decision.paxos.current_version() + 1, q);
-                    ELLE_TRACE("%s: evicted %f from %f quorum",
-                               this, lost_id, address);
-                  }
+                if (!q.erase(lost_id))
                   break;
-                }
-                catch (Paxos::PaxosServer::WrongQuorum const& e)
+                auto it = members.find(q);
+                if (it == members.end())
                 {
-                  q = e.expected();
-                }
-                catch (elle::Error const& e)
-                {
-                  ELLE_TRACE("%s: eviction of %s failed: %s", this, address, e);
-                  break;
+                  auto found = std::vector<overlay::Overlay::WeakMember>{};
+                  for (auto member: this->doughnut().overlay()->lookup_nodes(
+                         PaxosServer::Quorum{begin(q), end(q)}))
+                    if (member.lock())
+                      found.emplace_back(std::move(member));
+                  it = members.emplace(q, std::move(found)).first;
                 }
+                auto peers = Details::Peers{};
+                for (auto const& member: it->second)
+                  if (member.lock())
+                    peers.emplace_back(std::make_unique<PaxosPeer>(
+                                         member, address, boost::none, false));
+                Paxos::PaxosClient client(
+                  this->doughnut().id(), std::move(peers));
+                client.choose(decision.paxos.current_version() + 1, q);
+                ELLE_TRACE("%s: evicted %f from %f quorum",
+                           this, lost_id, address);
+                break;
+              }
+              catch (Paxos::PaxosServer::WrongQuorum const& e)
+              {
+                q = e.expected();
               }
             }
-            else
+          }
+          else
+          {
+            auto const addr = block.block->address();
+            auto it = this->_quorums.find(addr);
+            ELLE_ASSERT(it != this->_quorums.end());
+            auto q = it->quorum;
+            if (q.erase(lost_id))
             {
-              auto const addr = block.block->address();
-              auto it = this->_quorums.find(addr);
-              ELLE_ASSERT(it != this->_quorums.end());
-              auto q = it->quorum;
-              if (q.erase(lost_id))
+              this->_cache(addr, true, q);
+              if (signed(q.size()) < this->_factor)
               {
-                this->_cache(addr, true, q);
-                if (signed(q.size()) < this->_factor)
-                {
-                  ELLE_DUMP("schedule %f for rebalancing after eviction",
-                            addr);
-                  this->_rebalancable.emplace(block.block->address(), false);
-                }
+                ELLE_DUMP("schedule %f for rebalancing after eviction",
+                          addr);
+                this->_rebalancable.emplace(block.block->address(), false);
               }
             }
           }
         }
 
+        namespace
+        {
+          /// The bytes replicating @a block transfers, as stored.
+          int64_t
+          payload_size(blocks::Block const& block)
+          {
+            return block.blocks::Block::data().size();
+          }
+
+          int64_t
+          payload_size(Paxos::LocalPeer::Decision const& decision)
+          {
+            if (auto value = decision.paxos.current_value())
+              if (auto block = value->value.template is<
+                    std::shared_ptr<blocks::Block>>())
+                return payload_size(**block);
+            return 0;
+          }
+        }
+
+        int
+        Paxos::LocalPeer::_replicas(Address address) const
+        {
+          auto it = this->_quorums.find(address);
+          return it != this->_quorums.end() ? it->replication_factor() : 0;
+        }
+
         void
         Paxos::LocalPeer::_rebalance()
         {
-          ELLE_LOG_COMPONENT(
-            "memo.model.doughnut.consensus.Paxos.rebalance");
           while (true)
           {
             auto elt = this->_rebalancable.get();
             auto address = elt.first;
             if (!elt.second)
+              this->_rebalancer.schedule(
+                address, Rebalancer::Kind::rebalance, this->_replicas(address),
+                [this, address] { return this->_rebalance_block(address); });
+            else
+              this->_rebalance_to(address);
+          }
+        }
+
+        int64_t
+        Paxos::LocalPeer::_rebalance_block(Address address)
+        {
+          ELLE_LOG_COMPONENT(
+            "memo.model.doughnut.consensus.Paxos.rebalance");
+          try
+          {
+            ELLE_TRACE_SCOPE("%s: rebalance %f", this, address);
+            auto block = this->_load(address);
+            if (block.paxos)
             {
-              try
-              {
-                ELLE_TRACE_SCOPE("%s: rebalance %f", this, address);
-                auto block = this->_load(address);
-                if (block.paxos)
-                {
-                  auto peers = Details::lookup_nodes(
-                    this->_paxos.doughnut(),
-                    block.paxos->paxos.current_quorum(),
-                    address);
-                  Paxos::PaxosClient client(
-                    this->doughnut().id(), std::move(peers));
-                  this->rebalance(client, address);
-                }
-                else
-                {
-                  auto it = this->_quorums.find(address);
-                  if (it == this->_quorums.end())
-                    // The block was deleted in the meantime.
-                    continue;
-                  auto q = it->quorum;
-                  auto new_q =
-                    this->_paxos._rebalance_extend_quorum(address, q);
-                  if (new_q == q)
-                  {
-                    ELLE_DEBUG("unable to find any new owner for %f", address);
-                    this->_under_replicated(address, q.size());
-                    continue;
-                  }
-                  else
-                    ELLE_DEBUG("rebalance from %f to %f", q, new_q);
-                  if (Details::send_immutable_block(
-                        this->paxos(),
-                        this->doughnut().overlay()->lookup_nodes(new_q),
-                        *block.block,
-                        q))
-                      this->_rebalanced(address);
-                }
-              }
-              catch (MissingBlock const&)
-              {
+              auto peers = Details::lookup_nodes(
+                this->_paxos.doughnut(),
+                block.paxos->paxos.current_quorum(),
+                address);
+              Paxos::PaxosClient client(
+                this->doughnut().id(), std::move(peers));
+              if (this->rebalance(client, address))
+                return payload_size(*block.paxos);
+            }
+            else
+            {
+              auto it = this->_quorums.find(address);
+              if (it == this->_quorums.end())
                 // The block was deleted in the meantime.
-                ELLE_TRACE("block %f was deleted while rebalancing", address);
+                return 0;
+              auto q = it->quorum;
+              auto new_q =
+                this->_paxos._rebalance_extend_quorum(address, q);
+              if (new_q == q)
+              {
+                ELLE_DEBUG("unable to find any new owner for %f", address);
+                this->_under_replicated(address, q.size());
+                return 0;
               }
-              catch (elle::Error const& e)
+              else
+                ELLE_DEBUG("rebalance from %f to %f", q, new_q);
+              if (Details::send_immutable_block(
+                    this->paxos(),
+                    this->doughnut().overlay()->lookup_nodes(new_q),
+                    *block.block,
+                    q))
               {
-                ELLE_WARN("rebalancing of %f failed: %s", address, e);
+                this->_rebalanced(address);
+                return payload_size(*block.block) * (new_q.size() - q.size());
               }
             }
-            else
+          }
+          catch (MissingBlock const&)
+          {
+            // The block was deleted in the meantime.
+            ELLE_TRACE("block %f was deleted while rebalancing", address);
+          }
+          return 0;
+        }
+
+        void
+        Paxos::LocalPeer::_rebalance_to(Address node)
+        {
+          ELLE_LOG_COMPONENT(
+            "memo.model.doughnut.consensus.Paxos.rebalance");
+          auto test = [this, node] (PaxosServer::Quorum const& q)
             {
-              auto test = [&] (PaxosServer::Quorum const& q)
-                {
-                  return signed(q.size()) < this->_factor &&
-                  q.find(address) == q.end();
-                };
-              std::unordered_set<BlockRepartition,
-                                 BlockRepartition::HashByAddress> targets;
-              for (auto const& r: this->_quorums.get<1>())
+              return signed(q.size()) < this->_factor &&
+                q.find(node) == q.end();
+            };
+          std::unordered_set<BlockRepartition,
+                             BlockRepartition::HashByAddress> targets;
+          for (auto const& r: this->_quorums.get<1>())
+          {
+            if (r.replication_factor() >= this->_factor)
+              break;
+            if (test(r.quorum))
+              targets.emplace(r);
+          }
+          if (targets.empty())
+            return;
+          ELLE_TRACE_SCOPE(
+            "%s: rebalance %s blocks to newly discovered peer %f",
+            this, targets.size(), node);
+          for (auto const& target: targets)
+            this->_rebalancer.schedule(
+              target.address, Rebalancer::Kind::extend,
+              target.replication_factor(),
+              [this, node, test, address = target.address]
               {
-                if (r.replication_factor() >= this->_factor)
-                  break;
-                if (test(r.quorum))
-                  targets.emplace(r);
-              }
-              if (targets.empty())
-                continue;
-              ELLE_TRACE_SCOPE(
-                "%s: rebalance %s blocks to newly discovered peer %f",
-                this, targets.size(), address);
-              for (auto target: targets)
+                return this->_rebalance_to(node, address, test);
+              },
+              node);
+        }
+
+        int64_t
+        Paxos::LocalPeer::_rebalance_to(
+          Address node,
+          Address address,
+          std::function<bool (PaxosServer::Quorum const&)> const& test)
+        {
+          ELLE_LOG_COMPONENT(
+            "memo.model.doughnut.consensus.Paxos.rebalance");
+          if (!elle::find(this->_nodes, node) ||
+              elle::find(this->_node_timeouts, node))
+          {
+            ELLE_TRACE("%s: peer %f disappeared, stop rebalancing to it",
+                       this, node);
+            return 0;
+          }
+          auto const repartition = elle::find(this->_quorums, address);
+          if (!repartition)
+            // The block was deleted in the meantime.
+            return 0;
+          if (repartition->immutable)
+          {
+            auto const quorum_current = repartition->quorum;
+            auto const quorum_new = [&]
               {
-                if (!elle::find(this->_nodes, address) ||
-                    elle::find(this->_node_timeouts, address))
-                {
-                  ELLE_TRACE("%s: peer %f disappeared, stop rebalancing to it",
-                             this, address);
-                  break;
-                }
-                try
+                auto q = quorum_current;
+                q.insert(node);
+                return q;
+              }();
+            auto b = this->_load(address);
+            ELLE_ASSERT(b.block);
+            if (Details::send_immutable_block(
+                  this->paxos(),
+                  this->doughnut().overlay()->lookup_nodes(quorum_new),
+                  *b.block,
+                  quorum_current))
+            {
+              ELLE_TRACE("successfully duplicated %f to %f", address, node);
+              this->_rebalanced(address);
+              return payload_size(*b.block);
+            }
+          }
+          else
+          {
+            auto it = this->_addresses.find(address);
+            if (it == this->_addresses.end())
+              // The block was deleted in the meantime.
+              return 0;
+            auto decision = it->decision;
+            auto quorum = decision->paxos.current_quorum();
+            // We can't actually rebalance this block, under_represented
+            // was wrong. Don't think this can happen but better safe
+            // than sorry.
+            if (!test(quorum))
+              return 0;
+            ELLE_DEBUG("elect new quorum")
+            {
+              PaxosClient c(
+                this->doughnut().id(),
+                Details::lookup_nodes(this->doughnut(), quorum, address));
+              auto latest = this->paxos()._latest(c, address);
+              auto new_q = [node, quorum, factor = this->_factor]
+                (PaxosServer::Quorum q)
                 {
-                  if (target.immutable)
-                  {
-                    auto const quorum_current =
-                      ELLE_ENFORCE(elle::find(this->_quorums,
-                                              target.address))->quorum;
-                    auto const quorum_new = [&]
-                      {
-                        auto q = quorum_current;
-                        q.insert(address);
-                        return q;
-                      }();
-                    auto b = this->_load(target.address);
-                    ELLE_ASSERT(b.block);
-                    if (Details::send_immutable_block(
-                          this->paxos(),
-                          this->doughnut().overlay()->lookup_nodes(quorum_new),
-                          *b.block,
-                          quorum_current))
-                    {
-                      ELLE_TRACE("successfully duplicated %f to %f",
-                                 target.address, address);
-                      this->_rebalanced(target.address);
-                    }
-                  }
+                  if (signed(quorum.size()) == factor)
+                    ELLE_TRACE(
+                      "someone else rebalanced to a sufficient quorum");
                   else
-                  {
-                    auto it = this->_addresses.find(target.address);
-                    if (it == this->_addresses.end())
-                      // The block was deleted in the meantime.
-                      continue;
-                    auto quorum = it->decision->paxos.current_quorum();
-                    // We can't actually rebalance this block, under_represented
-                    // was wrong. Don't think this can happen but better safe
-                    // than sorry.
-                    if (!test(quorum))
-                      continue;
-                    ELLE_DEBUG("elect new quorum")
-                    {
-                      PaxosClient c(
-                        this->doughnut().id(),
-                        Details::lookup_nodes(
-                          this->doughnut(), quorum, target.address));
-                      auto latest = this->paxos()._latest(c, address);
-                      auto new_q = [address, quorum, factor = this->_factor]
-                        (PaxosServer::Quorum q)
-                        {
-                          if (signed(quorum.size()) == factor)
-                            ELLE_TRACE(
-                              "someone else rebalanced to a sufficient quorum");
-                          else
-                            q.insert(address);
-                          return q;
-                        };
-                      this->paxos()._rebalance(
-                        c, target.address, new_q, latest);
-                    }
-                  }
-                }
-                catch (elle::Error const& e)
-                {
-                  ELLE_WARN("rebalancing of %f failed: %s", target.address, e);
-                }
-              }
+                    q.insert(node);
+                  return q;
+                };
+              if (this->paxos()._rebalance(c, address, new_q, latest))
+                return payload_size(*decision);
             }
           }
+          return 0;
         }
 
         bool
@@ -1291,16 +1638,12 @@ namespace memo
         {
           ELLE_TRACE_SCOPE("%s: get proposal at %f: %s%s",
                            *this, address, p, insert ? " (insert)" : "");
+          this->_wait_grant(address, p.sender);
           auto decision = this->_load_paxos(
             address, insert ? boost::optional<PaxosServer::Quorum>(peers)
                             : boost::optional<PaxosServer::Quorum>());
           auto res = decision->paxos.propose(peers, p);
-          BlockOrPaxos data(decision.get());
-          this->storage()->set(
-            address,
-            elle::serialization::binary::serialize(data,
-                                                   this->doughnut().version()),
-            true, true);
+          this->_log(address, *decision, Step(peers, p));
           return res;
         }
 
@@ -1376,15 +1719,9 @@ namespace memo
                 throw Conflict("peer validation failed", block->clone());
             }
           auto res = paxos.accept(std::move(peers), p, value);
-          {
-            ELLE_DEBUG_SCOPE("store accepted paxos");
-            BlockOrPaxos data(decision.get());
-            this->storage()->set(
-              address,
-              elle::serialization::binary::serialize(
-                data, this->doughnut().version()),
-              true, true);
-          }
+          ELLE_DEBUG("store accepted paxos")
+            this->_store(address, *decision);
+          this->_grant(address, p.sender);
           if (block)
             this->on_store()(*block);
           return res;
@@ -1413,18 +1750,23 @@ namespace memo
             auto& decision = *block.paxos;
             bool had_value = bool(decision.paxos.current_value());
             decision.paxos.confirm(peers, p);
-            ELLE_DEBUG("store confirmed paxos")
+            // The value was written on accept, only log the confirmation.
+            // It is folded in the whole state by the next accept.
+            ELLE_DEBUG("log confirmed paxos")
             {
-              BlockOrPaxos data(&decision);
-              auto ser = [&]
-              {
-                BENCH("confirm.storage");
-                auto res = elle::serialization::binary::serialize(
-                  data, this->doughnut().version());
-                return res;
-              }();
-              this->storage()->set(address, ser, true, true);
+              BENCH("confirm.storage");
+              this->_log(address, decision, Step(peers, p, true));
             }
+            if (auto value = decision.paxos.current_value())
+              if (auto block = value->value.template is<
+                    std::shared_ptr<blocks::Block>>())
+              {
+                auto const size = std::max<std::size_t>(
+                  (*block)->data().size(), 1);
+                prometheus::observe(write_amplification(),
+                                    double(decision.written) / size);
+              }
+            decision.written = 0;
             if (auto quorum = [&] () -> boost::optional<Quorum>
               {
                 if (!had_value)
@@ -1506,12 +1848,7 @@ namespace memo
             decision->paxos.propose(q, p);
             decision->paxos.accept(q, p, q);
             decision->paxos.confirm(q, p);
-            BlockOrPaxos data(decision.get());
-            this->storage()->set(
-              block->address(),
-              elle::serialization::binary::serialize(
-                data, this->doughnut().version()),
-              true, true);
+            this->_store(block->address(), *decision);
             this->on_store()(*block);
           }
           else
@@ -1581,6 +1918,15 @@ namespace memo
             {
               return this->get(q, a, v);
             });
+          if (this->doughnut().version() >= elle::Version(0, 10, 0))
+            rpcs.add(
+              "get_many",
+              [this](PaxosServer::Quorum q,
+                     std::vector<Address> const& addresses,
+                     std::vector<boost::optional<int>> const& versions)
+              {
+                return this->get_many(q, addresses, versions);
+              });
             rpcs.add(
               "reconcile",
               [this, &rpcs] (Address a)
@@ -1599,6 +1945,12 @@ namespace memo
                 return this->propagate(
                   std::move(q), std::move(block), std::move(p));
               });
+          // Rounds of other peers wait on consensus requests, rebalancing
+          // can wait.
+          for (auto name: {"propose", "accept", "confirm", "get", "get_many"})
+            rpcs.priority(name, RPCPriority::consensus);
+          for (auto name: {"reconcile", "propagate"})
+            rpcs.priority(name, RPCPriority::bulk);
         }
 
         std::unique_ptr<blocks::Block>
@@ -1712,6 +2064,9 @@ namespace memo
               throw MissingBlock(k.key());
             }
           }
+          // Whoever removes the block, the holder of a lease would keep
+          // serving it.
+          this->_wait_grant(address, boost::none);
           this->_remove(address);
         }
 
@@ -1726,6 +2081,13 @@ namespace memo
           {
             throw MissingBlock(k.key());
           }
+          if (auto key = metadata_key(address, this->doughnut().version()))
+            try
+            {
+              this->storage()->erase(*key);
+            }
+            catch (silo::MissingKey const&)
+            {}
           this->_node_blocks.get<by_block>().erase(address);
           this->on_remove()(address);
           this->_addresses.erase(address);
@@ -1768,6 +2130,22 @@ namespace memo
           }
         }
 
+        overlay::Overlay::MemberGenerator
+        Paxos::_owners(Address address, StoreMode mode)
+        {
+          switch (mode)
+          {
+            case STORE_INSERT:
+              return this->doughnut().overlay()->allocate(
+                address, this->_factor);
+            case STORE_UPDATE:
+              return this->doughnut().overlay()->lookup(
+                address, this->_factor, false);
+            default:
+              elle::unreachable();
+          }
+        }
+
         void
         Paxos::_store(std::unique_ptr<blocks::Block> inblock,
                       StoreMode mode,
@@ -1776,107 +2154,325 @@ namespace memo
           ELLE_TRACE_SCOPE("%s: store %f", *this, *inblock);
           std::shared_ptr<blocks::Block> b(inblock.release());
           ELLE_ASSERT(b);
-          auto owners = [&]
+          if (dynamic_cast<blocks::MutableBlock*>(b.get()))
+          {
+            // Updates that can be resolved can be merged with concurrent
+            // ones.
+            if (mode == STORE_UPDATE && resolver)
+              this->_store_batched(std::move(b), std::move(resolver));
+            else
+              this->_store_mutable(std::move(b), mode, resolver.get());
+          }
+          else if (!Details::send_immutable_block(
+                     *this,
+                     this->_owners(b->address(), mode),
+                     *b,
+                     PaxosClient::Quorum()))
+            elle::err("no peer available for insertion of %f", b->address());
+        }
+
+        void
+        Paxos::_store_mutable(std::shared_ptr<blocks::Block> b,
+                              StoreMode mode,
+                              ConflictResolver* resolver)
+        {
+          auto peers = Details::Peers();
+          PaxosServer::Quorum peers_id;
+          // FIXME: This void the "query on the fly" optimization as it forces
+          // resolution of all peers to get their id. Any other way ?
+          for (auto wpeer: this->_owners(b->address(), mode))
           {
-            switch (mode)
+            auto peer = wpeer.lock();
+            if (!peer)
+              ELLE_WARN("%s: peer was deleted while storing", this);
+            else
             {
-              case STORE_INSERT:
-                return this->doughnut().overlay()->allocate(
-                  b->address(), this->_factor);
-              case STORE_UPDATE:
-                return this->doughnut().overlay()->lookup(
-                  b->address(), this->_factor, false);
-              default:
-              elle::unreachable();
+              peers_id.insert(peer->id());
+              peers.emplace_back(
+                std::make_unique<PaxosPeer>(
+                  wpeer, b->address(), boost::none, mode == STORE_INSERT));
             }
-          }();
-          if (dynamic_cast<blocks::MutableBlock*>(b.get()))
+          }
+          if (peers.empty())
+            elle::err("no peer available for %s of %f",
+                      mode == STORE_INSERT ? "insertion" : "update",
+                      b->address());
+          ELLE_DEBUG("owners: %f", peers);
+          // FIXME: client is persisted on conflict resolution, hence the
+          // round number is kept and won't start at 0.
+          // Keep retrying with new quorums
+          while (true)
           {
-            auto peers = Details::Peers();
-            PaxosServer::Quorum peers_id;
-            // FIXME: This void the "query on the fly" optimization as it forces
-            // resolution of all peers to get their id. Any other way ?
-            for (auto wpeer: owners)
+            try
             {
-              auto peer = wpeer.lock();
-              if (!peer)
-                ELLE_WARN("%s: peer was deleted while storing", this);
-              else
+              Paxos::PaxosClient client(
+                this->doughnut().id(), std::move(peers));
+              // Keep resolving conflicts and retrying
+              while (true)
               {
-                peers_id.insert(peer->id());
-                peers.emplace_back(
-                  std::make_unique<PaxosPeer>(
-                    wpeer, b->address(), boost::none, mode == STORE_INSERT));
+                auto mb = dynamic_cast<blocks::MutableBlock*>(b.get());
+                auto version = mb->version();
+                // Acceptors grant the lease once they accept, after this.
+                auto const start = LeaseClock::now();
+                auto const chosen = [&]
+                  {
+                    ELLE_DEBUG("run Paxos for version %s", version)
+                      return client.choose(version, b);
+                  }();
+                if (chosen)
+                {
+                  if (chosen->is<PaxosServer::Quorum>())
+                  {
+                    auto const& q = chosen->get<PaxosServer::Quorum>();
+                    ELLE_DEBUG_SCOPE("Paxos elected another quorum: %f", q);
+                    b->seal(chosen.proposal().version + 1);
+                    throw Paxos::PaxosServer::WrongQuorum(
+                      q, peers_id, chosen.proposal());
+                  }
+                  else
+                  {
+                    auto block =
+                      chosen->get<std::shared_ptr<blocks::Block>>();
+                    if (auto* mb = dynamic_cast<blocks::MutableBlock*>(block.get()))
+                      mb->seal_version(chosen.proposal().version + 1);
+                    if (auto* mb = dynamic_cast<blocks::MutableBlock*>(b.get()))
+                      mb->seal_version(chosen.proposal().version + 1);
+                    this->_leases.erase(b->address());
+                    if (!(b = resolve(*b, *block, resolver)))
+                      break;
+                    ELLE_DEBUG("seal resolved block")
+                      b->seal();
+                  }
+                }
+                else
+                {
+                  if (this->_read_lease.count() &&
+                      this->doughnut().version() >= elle::Version(0, 10, 0))
+                  {
+                    // Expire before the acceptors do, even if their clocks
+                    // run up to 10% faster than ours.
+                    prune(this->_leases, this->_leases_prune);
+                    this->_leases[b->address()] = Lease{
+                      b, start + this->_read_lease * 9 / 10};
+                  }
+                  break;
+                }
               }
             }
-            if (peers.empty())
-              elle::err("no peer available for %s of %f",
-                        mode == STORE_INSERT ? "insertion" : "update",
-                        b->address());
-            ELLE_DEBUG("owners: %f", peers);
-            // FIXME: client is persisted on conflict resolution, hence the
-            // round number is kept and won't start at 0.
-            // Keep retrying with new quorums
-            while (true)
+            catch (Paxos::PaxosServer::WrongQuorum const& e)
             {
-              try
+              ELLE_TRACE("%s", e.what());
+              this->_leases.erase(b->address());
+              peers = Details::lookup_nodes(
+                this->doughnut(), e.expected(), b->address());
+              peers_id.clear();
+              for (auto const& peer: peers)
+                peers_id.insert(static_cast<PaxosPeer&>(*peer).id());
+              continue;
+            }
+            break;
+          }
+        }
+
+        /*---------.
+        | Batching |
+        `---------*/
+
+        /// Concurrent updates of an address, committed in a single round.
+        struct Paxos::Batch
+        {
+          struct Update
+          {
+            std::shared_ptr<blocks::Block> block;
+            std::unique_ptr<ConflictResolver> resolver;
+            std::exception_ptr error;
+          };
+          std::vector<Update> updates;
+          elle::reactor::Barrier done;
+        };
+
+        namespace
+        {
+          /// The update was left uncommitted by the batch leader, which was
+          /// terminated, and must be retried.
+          class BatchAborted
+            : public elle::Error
+          {
+          public:
+            BatchAborted()
+              : elle::Error("batch leader aborted")
+            {}
+          };
+
+          /// Replay the updates of a batch, in order, on top of a block.
+          ///
+          /// Updates whose resolution fails are left out and get the error.
+          /// Never leaves this node, hence never serialized.
+          class BatchResolver
+            : public ConflictResolver
+          {
+          public:
+            BatchResolver(Paxos::Batch& batch, std::size_t first)
+              : _batch(batch)
+              , _first(first)
+            {}
+
+            std::unique_ptr<blocks::Block>
+            operator () (blocks::Block&, blocks::Block& current) override
+            {
+              auto res = std::unique_ptr<blocks::Block>{};
+              for (auto i = this->_first; i < this->_batch.updates.size(); ++i)
               {
-                Paxos::PaxosClient client(
-                  this->doughnut().id(), std::move(peers));
-                // Keep resolving conflicts and retrying
-                while (true)
+                auto& update = this->_batch.updates[i];
+                auto& base = res ? *res : current;
+                update.error = nullptr;
+                try
                 {
-                  auto mb = dynamic_cast<blocks::MutableBlock*>(b.get());
-                  auto version = mb->version();
-                  auto const chosen = [&]
-                    {
-                      ELLE_DEBUG("run Paxos for version %s", version)
-                        return client.choose(version, b);
-                    }();
-                  if (chosen)
-                  {
-                    if (chosen->is<PaxosServer::Quorum>())
-                    {
-                      auto const& q = chosen->get<PaxosServer::Quorum>();
-                      ELLE_DEBUG_SCOPE("Paxos elected another quorum: %f", q);
-                      b->seal(chosen.proposal().version + 1);
-                      throw Paxos::PaxosServer::WrongQuorum(
-                        q, peers_id, chosen.proposal());
-                    }
-                    else
-                    {
-                      auto block =
-                        chosen->get<std::shared_ptr<blocks::Block>>();
-                      if (auto* mb = dynamic_cast<blocks::MutableBlock*>(block.get()))
-                        mb->seal_version(chosen.proposal().version + 1);
-                      if (auto* mb = dynamic_cast<blocks::MutableBlock*>(b.get()))
-                        mb->seal_version(chosen.proposal().version + 1);
-                      if (!(b = resolve(*b, *block, resolver.get())))
-                        break;
-                      ELLE_DEBUG("seal resolved block")
-                        b->seal();
-                    }
-                  }
+                  if (auto resolved = (*update.resolver)(*update.block, base))
+                    res = std::move(resolved);
                   else
-                    break;
+                    update.error = std::make_exception_ptr(
+                      Conflict("unable to merge concurrent updates",
+                               base.clone()));
+                }
+                catch (elle::Error const&)
+                {
+                  update.error = std::current_exception();
                 }
               }
-              catch (Paxos::PaxosServer::WrongQuorum const& e)
+              return res;
+            }
+
+            void
+            serialize(elle::serialization::Serializer&,
+                      elle::Version const&) override
+            {
+              elle::unreachable();
+            }
+
+            std::string
+            description() const override
+            {
+              return elle::sprintf("%s concurrent updates",
+                                   this->_batch.updates.size() - this->_first);
+            }
+
+          private:
+            Paxos::Batch& _batch;
+            std::size_t _first;
+          };
+
+          /// Updates committed per Paxos round.
+          memo::prometheus::HistogramPtr&
+          batch_size()
+          {
+            static auto const family = memo::prometheus::make_histogram_family(
+              "memo_paxos_batch_size",
+              "Updates of an address committed in a single Paxos round");
+            static auto res = memo::prometheus::make(
+              family, {}, {1, 2, 4, 8, 16, 32, 64});
+            return res;
+          }
+        }
+
+        void
+        Paxos::_store_batched(std::shared_ptr<blocks::Block> b,
+                              std::unique_ptr<ConflictResolver> resolver)
+        {
+          auto const address = b->address();
+          if (auto batch = elle::find(this->_batches, address))
+          {
+            // A batch is waiting for its round, hop in.
+            auto const self = batch->second;
+            auto const index = self->updates.size();
+            ELLE_DEBUG("%s: join batch of %s updates on %f",
+                       this, index, address);
+            self->updates.push_back(
+              Batch::Update{std::move(b), std::move(resolver), nullptr});
+            elle::reactor::wait(self->done);
+            auto& update = self->updates[index];
+            if (update.error)
+              try
               {
-                ELLE_TRACE("%s", e.what());
-                peers = Details::lookup_nodes(
-                  this->doughnut(), e.expected(), b->address());
-                peers_id.clear();
-                for (auto const& peer: peers)
-                  peers_id.insert(static_cast<PaxosPeer&>(*peer).id());
-                continue;
+                std::rethrow_exception(update.error);
+              }
+              catch (BatchAborted const&)
+              {
+                ELLE_TRACE("%s: batch leader on %f aborted, retry",
+                           this, address);
+                return this->_store_batched(std::move(update.block),
+                                            std::move(update.resolver));
+              }
+            return;
+          }
+          auto const self = std::make_shared<Batch>();
+          self->updates.push_back(
+            Batch::Update{std::move(b), std::move(resolver), nullptr});
+          this->_batches.emplace(address, self);
+          auto round = std::shared_ptr<elle::reactor::Barrier>{};
+          auto committed = false;
+          elle::SafeFinally done([&]
+            {
+              // Terminated before the round ended: let joiners retry.
+              if (!committed)
+                for (auto i = 1u; i < self->updates.size(); ++i)
+                  if (!self->updates[i].error)
+                    self->updates[i].error =
+                      std::make_exception_ptr(BatchAborted());
+              // Another batch may have started since our round did.
+              auto it = this->_batches.find(address);
+              if (it != this->_batches.end() && it->second == self)
+                this->_batches.erase(it);
+              if (round)
+              {
+                this->_rounds.erase(address);
+                round->open();
+              }
+              self->done.open();
+            });
+          try
+          {
+            // Collect updates while our previous round, if any, runs.
+            if (this->_batch_window.count())
+              elle::reactor::sleep(this->_batch_window);
+            while (auto previous = elle::find(this->_rounds, address))
+            {
+              auto const barrier = previous->second;
+              elle::reactor::wait(*barrier);
+            }
+            this->_batches.erase(address);
+            round = std::make_shared<elle::reactor::Barrier>();
+            this->_rounds.emplace(address, round);
+            auto& updates = self->updates;
+            ELLE_TRACE_SCOPE("%s: commit %s updates of %f in one round",
+                             this, updates.size(), address);
+            prometheus::observe(batch_size(), updates.size());
+            auto merged = updates.front().block;
+            if (updates.size() > 1)
+            {
+              auto const version =
+                dynamic_cast<blocks::MutableBlock&>(*merged).version();
+              if (auto res = BatchResolver(*self, 1)(*merged, *merged))
+              {
+                merged.reset(res.release());
+                ELLE_DEBUG("seal merged block at version %s", version)
+                  merged->seal(version);
               }
-              break;
             }
+            // Should Paxos choose another value, replay every update on it.
+            auto all = BatchResolver(*self, 0);
+            this->_store_mutable(std::move(merged), STORE_UPDATE, &all);
+            committed = true;
           }
-          else if (!Details::send_immutable_block(
-                     *this, owners, *b, PaxosClient::Quorum()))
-            elle::err("no peer available for insertion of %f", b->address());
+          catch (elle::Error const&)
+          {
+            // Termination is not an elle::Error and leaves the round.
+            committed = true;
+            for (auto& update: self->updates)
+              update.error = std::current_exception();
+          }
+          if (auto error = self->updates.front().error)
+            std::rethrow_exception(error);
         }
 
         class Hit
@@ -1936,19 +2532,26 @@ namespace memo
             }
             return;
           }
-          ELLE_DEBUG("querying %s addresses", addresses.size());
-          auto hits = this->doughnut().overlay()->lookup(
-            elle::make_vector(addresses,
-                              [](auto const& a){ return a.first; }),
-            this->_factor);
           auto versions = std::unordered_map<Address, boost::optional<int>>{};
+          auto queried = std::vector<Address>{};
           for (auto a: addresses)
-            versions[a.first] = a.second;
+            if (auto leased = this->_leased(a.first, a.second))
+              res(a.first, std::move(*leased), {});
+            else
+            {
+              versions[a.first] = a.second;
+              queried.emplace_back(a.first);
+            }
+          if (queried.empty())
+            return;
+          ELLE_DEBUG("querying %s addresses", queried.size());
+          auto hits = this->doughnut().overlay()->lookup(queried, this->_factor);
           auto peers = std::unordered_map<Address, Details::Peers>();
           for (auto r: hits)
             peers[r.first].emplace_back(
               std::make_unique<PaxosPeer>(
                 r.second, r.first, versions.at(r.first), false));
+          Details::_get_many(peers, versions);
           elle::reactor::for_each_parallel(
             peers,
             [&] (std::pair<Address const, Details::Peers>& p)
@@ -1976,6 +2579,8 @@ namespace memo
               this->doughnut().overlay()->lookup(address, this->_factor);
             return fetch_from_members(peers, address, std::move(local_version));
           }
+          if (auto leased = this->_leased(address, local_version))
+            return std::move(*leased);
           auto peers = Details::_peers(*this, address, local_version);
           return Details::_fetch(
             *this, address, std::move(peers), local_version);
@@ -2227,18 +2832,51 @@ namespace memo
         void
         Paxos::_remove(Address address, blocks::RemoveSignature rs)
         {
+          this->_leases.erase(address);
           this->remove_many(address, std::move(rs), this->_factor);
         }
 
+        /*------------.
+        | Read leases |
+        `------------*/
+
+        boost::optional<std::unique_ptr<blocks::Block>>
+        Paxos::_leased(Address address, boost::optional<int> local_version)
+        {
+          auto it = this->_leases.find(address);
+          if (it == this->_leases.end())
+            return boost::none;
+          if (it->second.expiry <= LeaseClock::now())
+          {
+            this->_leases.erase(it);
+            return boost::none;
+          }
+          prometheus::increment(leased_reads());
+          auto const& block = it->second.block;
+          auto const mb = dynamic_cast<blocks::MutableBlock*>(block.get());
+          if (local_version && mb && *local_version == mb->version())
+          {
+            ELLE_DEBUG("%s: local version of leased %f is the most recent",
+                       this, address);
+            return std::unique_ptr<blocks::Block>();
+          }
+          ELLE_DEBUG("%s: read leased %f", this, address);
+          return block->clone();
+        }
+
         Paxos::LocalPeer::Decision::Decision(PaxosServer paxos)
           : chosen(-1)
           , paxos(std::move(paxos))
+          , base(0)
+          , written(0)
         {}
 
         Paxos::LocalPeer::Decision::Decision(
           elle::serialization::SerializerIn& s)
           : chosen(s.deserialize<int>("chosen"))
           , paxos(s.deserialize<PaxosServer>("paxos"))
+          , base(0)
+          , written(0)
         {}
 
         void
@@ -2249,6 +2887,175 @@ namespace memo
           s.serialize("paxos", this->paxos);
         }
 
+        /*-------------.
+        | Acceptor log |
+        `-------------*/
+
+        Paxos::LocalPeer::Step::Step(PaxosServer::Quorum peers,
+                                     PaxosClient::Proposal proposal,
+                                     bool confirm)
+          : peers(std::move(peers))
+          , proposal(std::move(proposal))
+          , confirm(confirm)
+        {}
+
+        Paxos::LocalPeer::Step::Step(elle::serialization::SerializerIn& s)
+          : peers(s.deserialize<PaxosServer::Quorum>("peers"))
+          , proposal(s.deserialize<PaxosClient::Proposal>("proposal"))
+          , confirm(s.deserialize<bool>("confirm"))
+        {}
+
+        void
+        Paxos::LocalPeer::Step::serialize(elle::serialization::Serializer& s)
+        {
+          s.serialize("peers", this->peers);
+          s.serialize("proposal", this->proposal);
+          s.serialize("confirm", this->confirm);
+        }
+
+        Paxos::LocalPeer::StepLog::StepLog(uint32_t base,
+                                           std::vector<Step> steps)
+          : base(base)
+          , steps(std::move(steps))
+        {}
+
+        Paxos::LocalPeer::StepLog::StepLog(
+          elle::serialization::SerializerIn& s)
+          : base(s.deserialize<uint32_t>("base"))
+          , steps(s.deserialize<std::vector<Step>>("steps"))
+        {}
+
+        void
+        Paxos::LocalPeer::StepLog::serialize(
+          elle::serialization::Serializer& s)
+        {
+          s.serialize("base", this->base);
+          s.serialize("steps", this->steps);
+        }
+
+        void
+        Paxos::LocalPeer::_store(Address address, Decision& decision)
+        {
+          BlockOrPaxos data(&decision);
+          auto const buffer =
+            elle::serialization::binary::serialize(data,
+                                                   this->doughnut().version());
+          this->storage()->set(address, buffer, true, true);
+          decision.base = checksum(buffer);
+          decision.written += buffer.size();
+          // The log no longer applies, but is harmless until removed.
+          if (!decision.steps.empty())
+          {
+            decision.steps.clear();
+            try
+            {
+              this->storage()->erase(
+                *metadata_key(address, this->doughnut().version()));
+            }
+            catch (silo::MissingKey const&)
+            {}
+          }
+        }
+
+        void
+        Paxos::LocalPeer::_log(Address address, Decision& decision, Step step)
+        {
+          auto const key = metadata_key(address, this->doughnut().version());
+          // The state may never have been stored whole, when inserting.
+          if (!key || !decision.base || decision.steps.size() >= max_steps)
+            return this->_store(address, decision);
+          decision.steps.emplace_back(std::move(step));
+          auto log = StepLog(decision.base, decision.steps);
+          auto const buffer = elle::serialization::binary::serialize(
+            log, this->doughnut().version());
+          this->storage()->set(*key, buffer, true, true);
+          decision.written += buffer.size();
+        }
+
+        void
+        Paxos::LocalPeer::_replay(Address address, Decision& decision)
+        {
+          auto const key = metadata_key(address, this->doughnut().version());
+          // Logs only live during a round, most blocks have none.  Silos
+          // that index their keys answer this without reaching storage.
+          if (!key ||
+              this->storage()->status(*key) == silo::BlockStatus::missing)
+            return;
+          auto buffer = elle::Buffer{};
+          try
+          {
+            buffer = this->storage()->get(*key);
+          }
+          catch (silo::MissingKey const&)
+          {
+            return;
+          }
+          elle::serialization::Context context;
+          context.set<Doughnut*>(&this->doughnut());
+          context.set<elle::Version>(
+            elle_serialization_version(this->doughnut().version()));
+          auto log = elle::serialization::binary::deserialize<StepLog>(
+            buffer, true, context);
+          // Steps logged before the state was last stored whole are stale.
+          if (log.base != decision.base)
+          {
+            ELLE_DEBUG("%s: ignore stale acceptor log for %f", this, address);
+            return;
+          }
+          ELLE_DEBUG_SCOPE("%s: replay %s acceptor steps on %f",
+                           this, log.steps.size(), address);
+          for (auto const& step: log.steps)
+            if (step.confirm)
+              decision.paxos.confirm(step.peers, step.proposal);
+            else
+              decision.paxos.propose(step.peers, step.proposal);
+          decision.steps = std::move(log.steps);
+        }
+
+        /*------------.
+        | Read leases |
+        `------------*/
+
+        void
+        Paxos::LocalPeer::_grant(Address address, Address holder)
+        {
+          if (!this->_read_lease.count() ||
+              this->doughnut().version() < elle::Version(0, 10, 0))
+            return;
+          prune(this->_grants, this->_grants_prune);
+          this->_grants[address] =
+            Grant{holder, LeaseClock::now() + this->_read_lease};
+        }
+
+        void
+        Paxos::LocalPeer::_wait_grant(Address address,
+                                      boost::optional<Address> proposer)
+        {
+          // Older peers neither hold leases nor wait for them.
+          if (!this->_read_lease.count() ||
+              this->doughnut().version() < elle::Version(0, 10, 0))
+            return;
+          // Grants made before we started are forgotten, assume any of them
+          // may still be running.
+          auto expiry = this->_grants_since + this->_read_lease;
+          auto it = this->_grants.find(address);
+          if (it != this->_grants.end() &&
+              !(proposer && it->second.holder == *proposer))
+            expiry = std::max(expiry, it->second.expiry);
+          auto const now = LeaseClock::now();
+          if (expiry <= now)
+            return;
+          ELLE_TRACE_SCOPE("%s: wait for the read lease on %f to expire",
+                           this, address);
+          // Do not hold up other requests of the connection meanwhile.
+          RPCAdmission::suspend([&]
+            {
+              elle::reactor::sleep(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                  expiry - now) + 1ms);
+            });
+        }
+
         /*-----.
         | Stat |
         `-----*/
@@ -2309,10 +3116,21 @@ namespace memo
         elle::json::Object
         Paxos::stats()
         {
-          return {
+          auto res = elle::json::Object{
             {"type", "paxos"},
             {"node_timeout", elle::sprintf("%s", this->node_timeout())},
+            {"read_lease", elle::sprintf("%s", this->read_lease())},
+            {"leases", this->_leases.size()},
           };
+          if (auto local = std::dynamic_pointer_cast<LocalPeer>(
+                this->doughnut().local()))
+          {
+            auto rebalancing = local->rebalancer().stats();
+            rebalancing["inspected"] = local->inspected();
+            rebalancing["to_inspect"] = local->to_inspect();
+            res["rebalancing"] = std::move(rebalancing);
+          }
+          return res;
         }
 
         /*--------------.
@@ -2325,6 +3143,7 @@ namespace memo
           : consensus::Configuration()
           , _replication_factor(replication_factor)
           , _node_timeout(node_timeout)
+          , _read_lease(0)
           , _rebalance_auto_expand(true)
           , _rebalance_inspect(true)
         {}
@@ -2336,13 +3155,15 @@ namespace memo
             dht,
             consensus::replication_factor = this->_replication_factor,
             consensus::node_timeout = this->_node_timeout,
+            consensus::read_lease = this->_read_lease,
             consensus::rebalance_auto_expand = this->_rebalance_auto_expand,
             consensus::rebalance_inspect = this->_rebalance_inspect);
         }
 
         Paxos::Configuration::Configuration(
           elle::serialization::SerializerIn& s)
-          : _rebalance_auto_expand(true)
+          : _read_lease(0)
+          , _rebalance_auto_expand(true)
           , _rebalance_inspect(true)
         {
           this->serialize(s);
@@ -2362,6 +3183,17 @@ namespace memo
             ELLE_ASSERT(s.in());
             this->_node_timeout = 10min;
           }
+          // Every node must agree on the lease duration, it is thus part of
+          // the network configuration.
+          try
+          {
+            s.serialize("read-lease", this->_read_lease);
+          }
+          catch (elle::serialization::MissingKey const&)
+          {
+            ELLE_ASSERT(s.in());
+            this->_read_lease = {};
+          }
         }
 
         static const elle::serialization::Hierarchy<Configuration>::
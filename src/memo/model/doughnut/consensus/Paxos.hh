@@ -8,12 +8,14 @@
 #include <elle/Error.hh>
 #include <elle/athena/paxos/Client.hh>
 #include <elle/das/tuple.hh>
+#include <elle/reactor/Barrier.hh>
 #include <elle/reactor/duration.hh>
 #include <elle/unordered_map.hh>
 
 #include <memo/model/doughnut/Consensus.hh>
 #include <memo/model/doughnut/Local.hh>
 #include <memo/model/doughnut/Remote.hh>
+#include <memo/model/doughnut/consensus/Rebalancer.hh>
 
 namespace memo
 {
@@ -34,6 +36,7 @@ namespace memo
         ELLE_DAS_SYMBOL(rebalance_inspect);
         ELLE_DAS_SYMBOL(node);
         ELLE_DAS_SYMBOL(node_timeout);
+        ELLE_DAS_SYMBOL(read_lease);
 
         struct BlockOrPaxos;
 
@@ -62,7 +65,8 @@ namespace memo
                 bool lenient_fetch,
                 bool rebalance_auto_expand,
                 bool rebalance_inspect,
-                std::chrono::system_clock::duration node_timeout);
+                std::chrono::system_clock::duration node_timeout,
+                std::chrono::system_clock::duration read_lease);
           template <typename ... Args>
           Paxos(Args&& ... args);
           ELLE_ATTRIBUTE_R(int, factor);
@@ -70,6 +74,9 @@ namespace memo
           ELLE_ATTRIBUTE_R(bool, rebalance_auto_expand);
           ELLE_ATTRIBUTE_R(bool, rebalance_inspect);
           ELLE_ATTRIBUTE_R(std::chrono::system_clock::duration, node_timeout);
+          /// How long the last node to successfully write a mutable block
+          /// may read it back without a quorum, zero to disable.
+          ELLE_ATTRIBUTE_R(std::chrono::system_clock::duration, read_lease);
         private:
           struct _Details;
           friend struct _Details;
@@ -111,6 +118,59 @@ namespace memo
           _client(Address const& addr);
           PaxosClient::State
           _latest(PaxosClient& client, Address address);
+          overlay::Overlay::MemberGenerator
+          _owners(Address address, StoreMode mode);
+          /// Run Paxos until @a b, or its resolution, is chosen.
+          void
+          _store_mutable(std::shared_ptr<blocks::Block> b,
+                         StoreMode mode,
+                         ConflictResolver* resolver);
+
+        /*---------.
+        | Batching |
+        `---------*/
+        public:
+          struct Batch;
+        private:
+          /// Commit @a b along with the concurrent updates of its address.
+          ///
+          /// A single Paxos round per address runs at once from this node.
+          /// Updates arriving meanwhile, or within $MEMO_PAXOS_BATCH_WINDOW
+          /// milliseconds, are resolved in order on top of one another and
+          /// committed together by the next round.
+          void
+          _store_batched(std::shared_ptr<blocks::Block> b,
+                         std::unique_ptr<ConflictResolver> resolver);
+          /// Updates waiting for a round, by address.
+          ELLE_ATTRIBUTE((std::unordered_map<Address, std::shared_ptr<Batch>>),
+                         batches);
+          /// Rounds running, by address, opened once done.
+          ELLE_ATTRIBUTE((std::unordered_map<
+                            Address, std::shared_ptr<elle::reactor::Barrier>>),
+                         rounds);
+          ELLE_ATTRIBUTE(std::chrono::milliseconds, batch_window);
+
+        /*------------.
+        | Read leases |
+        `------------*/
+        public:
+          using LeaseClock = std::chrono::steady_clock;
+          /// A block this node wrote and may serve without a quorum until
+          /// `expiry`.
+          struct Lease
+          {
+            std::shared_ptr<blocks::Block> block;
+            LeaseClock::time_point expiry;
+          };
+          using Leases = std::unordered_map<Address, Lease>;
+        private:
+          /// The block leased at @a address, none if we hold no lease, null
+          /// if it is @a local_version.
+          boost::optional<std::unique_ptr<blocks::Block>>
+          _leased(Address address, boost::optional<int> local_version);
+          ELLE_ATTRIBUTE(Leases, leases);
+          /// Size from which expired leases are pruned.
+          ELLE_ATTRIBUTE(std::size_t, leases_prune);
 
         /*--------.
         | Factory |
@@ -161,6 +221,15 @@ namespace memo
             get(PaxosServer::Quorum const& peers,
                 Address address,
                 boost::optional<int> local_version) = 0;
+            /// Get several addresses sharing the same quorum at once.
+            ///
+            /// @a local_versions holds the local version of each of
+            /// @a addresses, errors are reported per address.
+            virtual
+            GetMultiResult
+            get_many(PaxosServer::Quorum const& peers,
+                     std::vector<Address> const& addresses,
+                     std::vector<boost::optional<int>> const& local_versions);
             virtual
             bool
             reconcile(Address address) = 0;
@@ -169,6 +238,10 @@ namespace memo
             propagate(PaxosServer::Quorum  q,
                       std::shared_ptr<blocks::Block> block,
                       Paxos::PaxosClient::Proposal p) = 0;
+          protected:
+            /// Blocks are stored along with their Paxos state.
+            bool
+            _stores_serialized() const override;
           };
 
         /*------------------.
@@ -205,6 +278,11 @@ namespace memo
             get(PaxosServer::Quorum const& peers,
                 Address address,
                 boost::optional<int> local_version) override;
+            GetMultiResult
+            get_many(PaxosServer::Quorum const& peers,
+                     std::vector<Address> const& addresses,
+                     std::vector<boost::optional<int>> const& local_versions)
+              override;
             bool
             reconcile(Address address) override;
             void
@@ -233,12 +311,14 @@ namespace memo
             using PaxosServer = Paxos::PaxosServer;
             using Value = Paxos::Value;
             using Quorum = PaxosServer::Quorum;
+            using LeaseClock = Paxos::LeaseClock;
             template <typename ... Args>
             LocalPeer(Paxos& paxos,
                       int factor,
                       bool rebalance_auto_expand,
                       bool rebalance_inspect,
                       std::chrono::system_clock::duration node_timeout,
+                      std::chrono::system_clock::duration read_lease,
                       Doughnut& dht,
                       Address id,
                       Args&& ... args);
@@ -252,6 +332,7 @@ namespace memo
             ELLE_ATTRIBUTE_R(elle::reactor::Thread::unique_ptr,
                              rebalance_inspector);
             ELLE_ATTRIBUTE_R(std::chrono::system_clock::duration, node_timeout);
+            ELLE_ATTRIBUTE_R(std::chrono::system_clock::duration, read_lease);
             ELLE_ATTRIBUTE(std::vector<elle::reactor::Thread::unique_ptr>,
                            evict_threads);
             ELLE_ATTRIBUTE_R(bool, cleaning_up);
@@ -294,6 +375,33 @@ namespace memo
             store(blocks::Block const& block, StoreMode mode) override;
             void
             remove(Address address, blocks::RemoveSignature rs) override;
+            /// A proposal or a confirmation, logged apart from the whole
+            /// state so the value is only written when accepted.
+            struct Step
+            {
+              Step(PaxosServer::Quorum peers,
+                   PaxosClient::Proposal proposal,
+                   bool confirm = false);
+              Step(elle::serialization::SerializerIn& s);
+              void
+              serialize(elle::serialization::Serializer& s);
+              using serialization_tag = memo::serialization_tag;
+              PaxosServer::Quorum peers;
+              PaxosClient::Proposal proposal;
+              bool confirm;
+            };
+            /// The steps logged on top of a whole state.
+            struct StepLog
+            {
+              StepLog(uint32_t base, std::vector<Step> steps);
+              StepLog(elle::serialization::SerializerIn& s);
+              void
+              serialize(elle::serialization::Serializer& s);
+              using serialization_tag = memo::serialization_tag;
+              /// Checksum of the whole state the steps apply to.
+              uint32_t base;
+              std::vector<Step> steps;
+            };
             struct Decision
             {
               Decision(PaxosServer paxos);
@@ -303,6 +411,13 @@ namespace memo
               using serialization_tag = memo::serialization_tag;
               int chosen;
               PaxosServer paxos;
+              /// Steps logged since the state was stored whole.
+              std::vector<Step> steps;
+              /// Checksum of the state stored whole, which the logged steps
+              /// apply to.
+              uint32_t base;
+              /// Bytes stored for the current round.
+              int64_t written;
             };
             bool
             rebalance(PaxosClient& client, Address address);
@@ -346,6 +461,35 @@ namespace memo
               std::shared_ptr<blocks::Block> value = nullptr);
             std::shared_ptr<Decision>
             _load_paxos(Address address, Decision decision);
+            /// Store @a decision whole, value included, and reset its log.
+            void
+            _store(Address address, Decision& decision);
+            /// Log @a step, already applied to @a decision.
+            void
+            _log(Address address, Decision& decision, Step step);
+            /// Apply the steps logged for @a address to @a decision.
+            void
+            _replay(Address address, Decision& decision);
+            /// A read lease the proposer of an accepted value may hold, which
+            /// other proposers must wait out.
+            struct Grant
+            {
+              Address holder;
+              LeaseClock::time_point expiry;
+            };
+            using Grants = std::unordered_map<Address, Grant>;
+            /// Record that @a holder may hold a read lease on @a address.
+            void
+            _grant(Address address, Address holder);
+            /// Wait until nobody but @a proposer, if any, may hold a read
+            /// lease on @a address.
+            void
+            _wait_grant(Address address, boost::optional<Address> proposer);
+            ELLE_ATTRIBUTE(Grants, grants);
+            /// Size from which expired grants are pruned.
+            ELLE_ATTRIBUTE(std::size_t, grants_prune);
+            /// When grants started being recorded.
+            ELLE_ATTRIBUTE(LeaseClock::time_point, grants_since);
             void
             _cache(Address address, bool immutable, Quorum quorum);
             void
@@ -356,11 +500,35 @@ namespace memo
             void
             _disappeared_schedule_eviction(model::Address id);
           protected:
+            /// Schedule the eviction of @a id from the quorums it is part of.
             void
             _disappeared_evict(Address id);
           private:
+            /// Evict @a lost_id from the quorum of @a address, looking the
+            /// remaining members up in @a members first.
+            void
+            _evict(Address lost_id,
+                   Address address,
+                   std::map<Quorum,
+                            std::vector<overlay::Overlay::WeakMember>>& members);
+            /// Replicas of @a address, as far as we know.
+            int
+            _replicas(Address address) const;
+            /// Feed the rebalancer from the rebalancing requests.
             void
             _rebalance();
+            /// Bring the replication of @a address up, returning the bytes
+            /// transferred.
+            int64_t
+            _rebalance_block(Address address);
+            /// Schedule the replication of under-replicated blocks on @a node.
+            void
+            _rebalance_to(Address node);
+            int64_t
+            _rebalance_to(
+              Address node,
+              Address address,
+              std::function<bool (PaxosServer::Quorum const&)> const& test);
             ELLE_ATTRIBUTE((elle::reactor::Channel<std::pair<Address, bool>>),
                            rebalancable);
             ELLE_ATTRIBUTE_X(boost::signals2::signal<void(Address)>,
@@ -370,6 +538,10 @@ namespace memo
             /// yet.
             ELLE_ATTRIBUTE_X(boost::signals2::signal<void(Address, int)>,
                              under_replicated);
+            ELLE_ATTRIBUTE_R(Rebalancer, rebalancer);
+            /// Blocks checked by the inspector, out of those stored.
+            ELLE_ATTRIBUTE_R(int64_t, inspected);
+            ELLE_ATTRIBUTE_R(int64_t, to_inspect);
             ELLE_ATTRIBUTE(elle::reactor::Thread, rebalance_thread);
             struct BlockRepartition
             {
@@ -477,6 +649,7 @@ namespace memo
             make(model::doughnut::Doughnut& dht) override;
             ELLE_ATTRIBUTE_RW(int, replication_factor);
             ELLE_ATTRIBUTE_RW(std::chrono::system_clock::duration, node_timeout);
+            ELLE_ATTRIBUTE_RW(std::chrono::system_clock::duration, read_lease);
             ELLE_ATTRIBUTE_RW(bool, rebalance_auto_expand);
             ELLE_ATTRIBUTE_RW(bool, rebalance_inspect);
           public:
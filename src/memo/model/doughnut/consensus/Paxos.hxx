@@ -13,6 +13,7 @@ namespace memo
           bool rebalance_auto_expand,
           bool rebalance_inspect,
           std::chrono::system_clock::duration node_timeout,
+          std::chrono::system_clock::duration read_lease,
           Doughnut& dht,
           Address id,
           Args&& ... args)
@@ -24,10 +25,20 @@ namespace memo
           , _rebalance_auto_expand(rebalance_auto_expand)
           , _rebalance_inspect(rebalance_inspect)
           , _node_timeout(node_timeout)
+          , _read_lease(read_lease)
           , _cleaning_up(false)
           , _max_addresses_size(elle::os::getenv("MEMO_PAXOS_CACHE_SIZE", 100))
+          , _grants_prune(64)
+          , _grants_since(LeaseClock::now())
           , _rebalancable()
           , _rebalanced()
+          , _rebalancer(
+            elle::sprintf("%s", this),
+            elle::os::getenv("MEMO_PAXOS_REBALANCE_PARALLELISM", 8),
+            elle::os::getenv("MEMO_PAXOS_REBALANCE_OPERATIONS", 100.),
+            elle::os::getenv("MEMO_PAXOS_REBALANCE_BANDWIDTH", 0.))
+          , _inspected(0)
+          , _to_inspect(0)
           , _rebalance_thread(elle::sprintf("%s: rebalance", this),
                               [this] () { this->_rebalance(); })
         {}
@@ -45,14 +56,16 @@ namespace memo
               consensus::lenient_fetch = false,
               consensus::rebalance_auto_expand = true,
               consensus::rebalance_inspect = true,
-              consensus::node_timeout = default_node_timeout
+              consensus::node_timeout = default_node_timeout,
+              consensus::read_lease = std::chrono::system_clock::duration(0)
               ).call(
                 [] (Doughnut& doughnut,
                     int factor,
                     bool lenient_fetch,
                     bool rebalance_auto_expand,
                     bool rebalance_inspect,
-                    std::chrono::system_clock::duration node_timeout
+                    std::chrono::system_clock::duration node_timeout,
+                    std::chrono::system_clock::duration read_lease
                   ) -> Paxos
                 {
                   return Paxos(doughnut,
@@ -60,7 +73,8 @@ namespace memo
                                lenient_fetch,
                                rebalance_auto_expand,
                                rebalance_inspect,
-                               node_timeout
+                               node_timeout,
+                               read_lease
                     );
                 }, std::forward<Args>(args)...))
         {}
@@ -0,0 +1,320 @@
+#include <memo/model/doughnut/consensus/Rebalancer.hh>
+
+#include <algorithm>
+#include <cmath>
+
+#include <elle/Error.hh>
+#include <elle/log.hh>
+
+#include <elle/reactor/exception.hh>
+#include <elle/reactor/scheduler.hh>
+
+#include <memo/model/prometheus.hh>
+
+ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Paxos.rebalance");
+
+namespace
+{
+  template <typename Metric>
+  memo::prometheus::UniquePtr<Metric>
+  metric(memo::prometheus::Family<Metric>* family)
+  {
+    return memo::prometheus::make(family, {});
+  }
+
+  memo::prometheus::GaugePtr&
+  pending_gauge()
+  {
+    static auto res = metric(memo::prometheus::make_gauge_family(
+      "memo_paxos_rebalance_pending",
+      "Replication repairs waiting or running"));
+    return res;
+  }
+
+  memo::prometheus::GaugePtr&
+  eta_gauge()
+  {
+    static auto res = metric(memo::prometheus::make_gauge_family(
+      "memo_paxos_rebalance_eta_seconds",
+      "Estimated time to complete pending replication repairs"));
+    return res;
+  }
+
+  memo::prometheus::CounterPtr&
+  done_counter()
+  {
+    static auto res = metric(memo::prometheus::make_counter_family(
+      "memo_paxos_rebalance_done_total",
+      "Replication repairs completed"));
+    return res;
+  }
+
+  memo::prometheus::CounterPtr&
+  failed_counter()
+  {
+    static auto res = metric(memo::prometheus::make_counter_family(
+      "memo_paxos_rebalance_failed_total",
+      "Replication repairs that failed"));
+    return res;
+  }
+
+  memo::prometheus::CounterPtr&
+  bytes_counter()
+  {
+    static auto res = metric(memo::prometheus::make_counter_family(
+      "memo_paxos_rebalance_bytes_total",
+      "Bytes transferred by replication repairs"));
+    return res;
+  }
+
+  std::string
+  kind_string(memo::model::doughnut::consensus::Rebalancer::Kind kind)
+  {
+    using Kind = memo::model::doughnut::consensus::Rebalancer::Kind;
+    switch (kind)
+    {
+      case Kind::rebalance:
+        return "rebalance";
+      case Kind::evict:
+        return "evict";
+      case Kind::extend:
+        return "extend";
+    }
+    return "unknown";
+  }
+}
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        Rebalancer::Rebalancer(std::string const& name,
+                               int parallelism,
+                               double operations,
+                               double bandwidth)
+          : _parallelism(std::max(parallelism, 1))
+          , _operations(std::max(operations, 0.))
+          , _bandwidth(std::max(bandwidth, 0.))
+          , _done(0)
+          , _failed(0)
+          , _transferred(0)
+          , _running(0)
+          , _sequence(0)
+          , _operation_tokens(0)
+          , _bandwidth_tokens(0)
+          , _refilled(Clock::now())
+          , _busy_since(Clock::now())
+          , _busy_done(0)
+        {
+          for (int i = 0; i < this->_parallelism; ++i)
+            this->_workers.emplace_back(
+              new elle::reactor::Thread(
+                elle::sprintf("%s: rebalance worker %s", name, i),
+                [this] { this->_work(); }));
+        }
+
+        Rebalancer::~Rebalancer()
+        {
+          this->terminate();
+        }
+
+        void
+        Rebalancer::schedule(Address address, Kind kind, int replicas, Job job,
+                             Address node)
+        {
+          if (!this->_queued.emplace(address, kind, node).second)
+          {
+            ELLE_DUMP("%s: %s of %f already scheduled",
+                      this, kind_string(kind), address);
+            return;
+          }
+          ELLE_DEBUG("%s: schedule %s of %f with %s replicas",
+                     this, kind_string(kind), address, replicas);
+          if (!this->pending())
+          {
+            this->_busy_since = Clock::now();
+            this->_busy_done = 0;
+          }
+          this->_queue.emplace(
+            std::make_pair(replicas, this->_sequence++),
+            Pending{address, kind, node, std::move(job)});
+          prometheus::increment(pending_gauge());
+          this->_available.open();
+        }
+
+        void
+        Rebalancer::throttle()
+        {
+          while (true)
+          {
+            this->_refill();
+            auto wait = 0.;
+            if (this->_operations && this->_operation_tokens < 1)
+              wait = (1 - this->_operation_tokens) / this->_operations;
+            if (this->_bandwidth && this->_bandwidth_tokens < 0)
+              wait = std::max(
+                wait, -this->_bandwidth_tokens / this->_bandwidth);
+            if (wait <= 0)
+              break;
+            elle::reactor::sleep(
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::duration<double>(wait)) +
+              std::chrono::milliseconds(1));
+          }
+          if (this->_operations)
+            this->_operation_tokens -= 1;
+        }
+
+        void
+        Rebalancer::charge(int64_t bytes)
+        {
+          if (bytes <= 0)
+            return;
+          this->_refill();
+          if (this->_bandwidth)
+            this->_bandwidth_tokens -= bytes;
+          this->_transferred += bytes;
+          prometheus::increment(bytes_counter(), bytes);
+        }
+
+        void
+        Rebalancer::terminate()
+        {
+          for (auto& worker: this->_workers)
+            if (worker)
+              worker->terminate_now();
+          this->_workers.clear();
+          for (auto i = this->pending(); i > 0; --i)
+            prometheus::decrement(pending_gauge());
+          this->_running = 0;
+          this->_queue.clear();
+          this->_queued.clear();
+          this->_available.close();
+        }
+
+        std::size_t
+        Rebalancer::pending() const
+        {
+          return this->_queue.size() + this->_running;
+        }
+
+        double
+        Rebalancer::rate() const
+        {
+          auto const elapsed = std::chrono::duration<double>(
+            Clock::now() - this->_busy_since).count();
+          return elapsed > 0 ? this->_busy_done / elapsed : 0;
+        }
+
+        boost::optional<std::chrono::seconds>
+        Rebalancer::eta() const
+        {
+          if (!this->pending())
+            return std::chrono::seconds(0);
+          auto const rate = this->rate();
+          if (!rate)
+            return boost::none;
+          return std::chrono::seconds(
+            static_cast<int64_t>(std::ceil(this->pending() / rate)));
+        }
+
+        elle::json::Object
+        Rebalancer::stats() const
+        {
+          auto res = elle::json::Object{
+            {"parallelism", this->_parallelism},
+            {"operations", this->_operations},
+            {"bandwidth", this->_bandwidth},
+            {"pending", this->pending()},
+            {"running", this->_running},
+            {"done", this->_done},
+            {"failed", this->_failed},
+            {"transferred", this->_transferred},
+            {"rate", this->rate()},
+          };
+          if (auto eta = this->eta())
+            res["eta"] = eta->count();
+          return res;
+        }
+
+        void
+        Rebalancer::_work()
+        {
+          while (true)
+          {
+            elle::reactor::wait(this->_available);
+            // Another worker may have emptied the queue meanwhile.
+            if (this->_queue.empty())
+              continue;
+            auto it = this->_queue.begin();
+            auto pending = std::move(it->second);
+            this->_queue.erase(it);
+            this->_queued.erase(
+              std::make_tuple(pending.address, pending.kind, pending.node));
+            if (this->_queue.empty())
+              this->_available.close();
+            ++this->_running;
+            try
+            {
+              this->throttle();
+              ELLE_TRACE_SCOPE("%s: %s %f",
+                               this, kind_string(pending.kind), pending.address);
+              this->charge(pending.job());
+            }
+            catch (elle::reactor::Terminate const&)
+            {
+              // terminate() accounts for the running jobs.
+              throw;
+            }
+            catch (elle::Error const& e)
+            {
+              // One bad block must not take a worker down.
+              ELLE_WARN("%s of %f failed: %s",
+                        kind_string(pending.kind), pending.address, e);
+              ++this->_failed;
+              prometheus::increment(failed_counter());
+            }
+            --this->_running;
+            ++this->_done;
+            ++this->_busy_done;
+            prometheus::increment(done_counter());
+            prometheus::decrement(pending_gauge());
+            this->_progress();
+          }
+        }
+
+        void
+        Rebalancer::_refill()
+        {
+          auto const now = Clock::now();
+          auto const elapsed =
+            std::chrono::duration<double>(now - this->_refilled).count();
+          this->_refilled = now;
+          // Allow bursts of up to a second worth of budget.
+          if (this->_operations)
+            this->_operation_tokens = std::min(
+              this->_operation_tokens + elapsed * this->_operations,
+              this->_operations);
+          if (this->_bandwidth)
+            this->_bandwidth_tokens = std::min(
+              this->_bandwidth_tokens + elapsed * this->_bandwidth,
+              this->_bandwidth);
+        }
+
+        void
+        Rebalancer::_progress()
+        {
+          if (auto eta = this->eta())
+            prometheus::set(eta_gauge(), eta->count());
+          if (!this->pending())
+            ELLE_TRACE("%s: backlog cleared, %s jobs done, %s failed",
+                       this, this->_done, this->_failed);
+        }
+      }
+    }
+  }
+}
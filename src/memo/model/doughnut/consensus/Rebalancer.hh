@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <elle/attribute.hh>
+#include <elle/json/json.hh>
+
+#include <elle/reactor/Barrier.hh>
+#include <elle/reactor/Thread.hh>
+
+#include <memo/model/Address.hh>
+
+namespace memo
+{
+  namespace model
+  {
+    namespace doughnut
+    {
+      namespace consensus
+      {
+        /// Repairs of block replication, run by a pool of threads within an
+        /// operation and a bandwidth budget.
+        ///
+        /// Jobs on the least replicated blocks run first, in the order they
+        /// were scheduled otherwise.  A job scheduled again for an address
+        /// and node before it started is dropped.  Progress and an estimate of the
+        /// time left are reported by `stats` and exported to Prometheus.
+        class Rebalancer
+        {
+        public:
+          enum class Kind
+          {
+            /// Bring the replication of a block back up.
+            rebalance,
+            /// Remove a lost node from the quorum of a block.
+            evict,
+            /// Replicate a block on a new node.
+            extend,
+          };
+          /// Run a repair, returning the number of bytes it transferred.
+          using Job = std::function<int64_t ()>;
+          using Clock = std::chrono::steady_clock;
+          /// Start @a parallelism workers, running at most @a operations
+          /// jobs and transferring at most @a bandwidth bytes per second,
+          /// zero meaning unlimited.
+          Rebalancer(std::string const& name,
+                     int parallelism,
+                     double operations,
+                     double bandwidth);
+          ~Rebalancer();
+          /// Run @a job on @a address, whose block has @a replicas replicas,
+          /// on behalf of @a node: the one evicted or extended to, if any.
+          void
+          schedule(Address address, Kind kind, int replicas, Job job,
+                   Address node = Address::null);
+          /// Wait until the budget allows one more operation.
+          void
+          throttle();
+          /// Account for @a bytes transferred.
+          void
+          charge(int64_t bytes);
+          /// Stop the workers and forget pending jobs.
+          void
+          terminate();
+          /// Jobs waiting or running.
+          std::size_t
+          pending() const;
+          /// Jobs completed per second since the backlog last formed.
+          double
+          rate() const;
+          /// Estimated time to complete pending jobs.
+          boost::optional<std::chrono::seconds>
+          eta() const;
+          elle::json::Object
+          stats() const;
+          ELLE_ATTRIBUTE_R(int, parallelism);
+          ELLE_ATTRIBUTE_R(double, operations);
+          ELLE_ATTRIBUTE_R(double, bandwidth);
+          /// Jobs completed, successfully or not.
+          ELLE_ATTRIBUTE_R(int64_t, done);
+          ELLE_ATTRIBUTE_R(int64_t, failed);
+          ELLE_ATTRIBUTE_R(int64_t, transferred);
+          ELLE_ATTRIBUTE_R(int, running);
+
+        private:
+          void
+          _work();
+          void
+          _refill();
+          void
+          _progress();
+          struct Pending
+          {
+            Address address;
+            Kind kind;
+            Address node;
+            Job job;
+          };
+          /// Pending jobs, by replicas then scheduling order.
+          using Queue = std::map<std::pair<int, uint64_t>, Pending>;
+          ELLE_ATTRIBUTE(Queue, queue);
+          ELLE_ATTRIBUTE((std::set<std::tuple<Address, Kind, Address>>),
+                         queued);
+          ELLE_ATTRIBUTE(uint64_t, sequence);
+          /// Opened while jobs are queued.
+          ELLE_ATTRIBUTE(elle::reactor::Barrier, available);
+          ELLE_ATTRIBUTE(double, operation_tokens);
+          ELLE_ATTRIBUTE(double, bandwidth_tokens);
+          ELLE_ATTRIBUTE(Clock::time_point, refilled);
+          /// When the backlog last formed, and jobs completed since.
+          ELLE_ATTRIBUTE(Clock::time_point, busy_since);
+          ELLE_ATTRIBUTE(int64_t, busy_done);
+          ELLE_ATTRIBUTE(std::vector<elle::reactor::Thread::unique_ptr>,
+                         workers);
+        };
+      }
+    }
+  }
+}
@@ -1,6 +1,8 @@
 #if MEMO_ENABLE_PROMETHEUS
 # include <memo/model/prometheus.hh>
 
+# include <boost/algorithm/string/classification.hpp>
+# include <boost/algorithm/string/split.hpp>
 # include <boost/exception/diagnostic_information.hpp>
 
 # include <elle/Error.hh>
@@ -143,6 +145,24 @@ namespace memo
         return {};
     }
 
+    auto
+    Prometheus::make_histogram_family(std::string const& name,
+                                      std::string const& help)
+      -> Family<Histogram>*
+    {
+      if (auto reg = registry())
+      {
+        ELLE_TRACE("creating histogram family %s", name);
+        auto& res = ::prometheus::BuildHistogram()
+          .Name(name)
+          .Help(help)
+          .Register(*reg);
+        return &res;
+      }
+      else
+        return {};
+    }
+
     auto
     Prometheus::make(Family<Counter>* family, Labels const& labels)
       -> UniquePtr<Counter>
@@ -168,6 +188,51 @@ namespace memo
       else
         return {};
     }
+
+    auto
+    Prometheus::make(Family<Histogram>* family,
+                     Labels const& labels,
+                     Buckets const& buckets)
+      -> UniquePtr<Histogram>
+    {
+      if (family)
+      {
+        ELLE_TRACE("creating %s histogram: %s", family->name(), labels);
+        return {&family->Add(labels, buckets), Deleter<Histogram>{family}};
+      }
+      else
+        return {};
+    }
+
+    Buckets const&
+    latency_buckets()
+    {
+      static auto const res = []
+      {
+        auto const spec = memo::getenv("PROMETHEUS_LATENCY_BUCKETS", ""s);
+        if (spec.empty())
+          // From half a millisecond to ten seconds.
+          return Buckets{0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                         0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+        auto res = Buckets{};
+        auto bounds = std::vector<std::string>{};
+        boost::algorithm::split(bounds, spec, boost::is_any_of(","));
+        for (auto const& b: bounds)
+          try
+          {
+            res.emplace_back(std::stod(b));
+            if (1 < res.size() && res.back() <= res[res.size() - 2])
+              elle::err("bounds must be increasing");
+          }
+          catch (std::exception const&)
+          {
+            elle::err("invalid $MEMO_PROMETHEUS_LATENCY_BUCKETS %s: %s",
+                      spec, elle::exception_string());
+          }
+        return res;
+      }();
+      return res;
+    }
   }
 }
 #endif
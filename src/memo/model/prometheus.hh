@@ -1,12 +1,16 @@
 #pragma once
 
+#include <vector>
+
 #if MEMO_ENABLE_PROMETHEUS
+# include <chrono>
 # include <memory>
 # include <string>
 
 # include <prometheus/counter.h>
 # include <prometheus/family.h>
 # include <prometheus/gauge.h>
+# include <prometheus/histogram.h>
 
 namespace prometheus
 {
@@ -26,6 +30,10 @@ namespace memo
     using Counter = ::prometheus::Counter;
     /// A non-monotonic (i.e., increasing/decreasing) counter.
     using Gauge = ::prometheus::Gauge;
+    /// A distribution of observations, counted in buckets.
+    using Histogram = ::prometheus::Histogram;
+    /// The upper bounds of histogram buckets.
+    using Buckets = Histogram::BucketBoundaries;
 
     /// Delete a metric, i.e. remove it from its family.
     template <typename Metric>
@@ -46,6 +54,8 @@ namespace memo
     using CounterPtr = UniquePtr<Counter>;
     /// A managed gauge.
     using GaugePtr = UniquePtr<Gauge>;
+    /// A managed histogram.
+    using HistogramPtr = UniquePtr<Histogram>;
 
     class Prometheus
     {
@@ -62,12 +72,19 @@ namespace memo
       /// Create a family of counters.
       Family<Counter>*
       make_counter_family(std::string const& name, std::string const& help);
+      /// Create a family of histograms.
+      Family<Histogram>*
+      make_histogram_family(std::string const& name, std::string const& help);
       /// Create a new member to a family.
       /// Should be removed eventually.
       UniquePtr<Gauge>
       make(Family<Gauge>* family, Labels const& labels);
       UniquePtr<Counter>
       make(Family<Counter>* family, Labels const& labels);
+      UniquePtr<Histogram>
+      make(Family<Histogram>* family,
+           Labels const& labels,
+           Buckets const& buckets);
 
       /// The http exposer.
       std::unique_ptr<::prometheus::Exposer> _exposer;
@@ -98,6 +115,14 @@ namespace memo
       return instance().make_counter_family(name, help);
     }
 
+    /// Create a family of histograms.
+    inline
+    Family<Histogram>*
+    make_histogram_family(std::string const& name, std::string const& help)
+    {
+      return instance().make_histogram_family(name, help);
+    }
+
     /// Create a metric.
     template <typename Metric>
     UniquePtr<Metric>
@@ -106,6 +131,23 @@ namespace memo
       return instance().make(family, labels);
     }
 
+    /// Create a histogram.
+    inline
+    UniquePtr<Histogram>
+    make(Family<Histogram>* family,
+         Labels const& labels,
+         Buckets const& buckets)
+    {
+      return instance().make(family, labels, buckets);
+    }
+
+    /// Bucket bounds for latencies, in seconds.
+    ///
+    /// Overridden by $MEMO_PROMETHEUS_LATENCY_BUCKETS, a comma-separated
+    /// list of increasing bounds.
+    Buckets const&
+    latency_buckets();
+
     /// Increment a counter or a gauge, if they are defined.
     template <typename Metric>
     void increment(UniquePtr<Metric>& p)
@@ -121,6 +163,56 @@ namespace memo
       if (p)
         p->Decrement();
     }
+
+    /// Increment a counter by @a value, if it is defined.
+    inline
+    void increment(UniquePtr<Counter>& p, double value)
+    {
+      if (p)
+        p->Increment(value);
+    }
+
+    /// Set a gauge, if it is defined.
+    inline
+    void set(UniquePtr<Gauge>& p, double value)
+    {
+      if (p)
+        p->Set(value);
+    }
+
+    /// Add an observation to a histogram, if it is defined.
+    inline
+    void observe(UniquePtr<Histogram>& p, double value)
+    {
+      if (p)
+        p->Observe(value);
+    }
+
+    /// Observe the time spent in a scope, in seconds.
+    class Timer
+    {
+    public:
+      Timer(UniquePtr<Histogram> const& histogram)
+        : _histogram(histogram.get())
+        , _start(this->_histogram
+                 ? std::chrono::steady_clock::now()
+                 : std::chrono::steady_clock::time_point())
+      {}
+
+      Timer(Timer const&) = delete;
+
+      ~Timer()
+      {
+        if (this->_histogram)
+          this->_histogram->Observe(
+            std::chrono::duration<double>(
+              std::chrono::steady_clock::now() - this->_start).count());
+      }
+
+    private:
+      Histogram* _histogram;
+      std::chrono::steady_clock::time_point _start;
+    };
   }
 }
 #else // !MEMOy_ENABLE_PROMETHEUS
@@ -140,11 +232,15 @@ namespace memo
 
     struct Counter {};
     struct Gauge {};
+    struct Histogram {};
+    using Buckets = std::vector<double>;
 
     /// A managed counter.
     using CounterPtr = UniquePtr<Counter>;
     /// A managed gauge.
     using GaugePtr = UniquePtr<Gauge>;
+    /// A managed histogram.
+    using HistogramPtr = UniquePtr<Histogram>;
 
     /// Set the Prometheus publishing address.
     inline
@@ -169,6 +265,14 @@ namespace memo
       return nullptr;
     }
 
+    /// Create a family of histograms.
+    inline
+    Family<Histogram>*
+    make_histogram_family(std::string const& name, std::string const& help)
+    {
+      return nullptr;
+    }
+
     /// Create a metric.
     template <typename Metric>
     UniquePtr<Metric>
@@ -177,6 +281,25 @@ namespace memo
       return nullptr;
     }
 
+    /// Create a histogram.
+    inline
+    UniquePtr<Histogram>
+    make(Family<Histogram>* family,
+         Labels const& labels,
+         Buckets const& buckets)
+    {
+      return nullptr;
+    }
+
+    /// Bucket bounds for latencies, in seconds.
+    inline
+    Buckets const&
+    latency_buckets()
+    {
+      static auto const res = Buckets{};
+      return res;
+    }
+
     /// Increment a counter or a gauge, if they are defined.
     template <typename Metric>
     void increment(UniquePtr<Metric>&)
@@ -186,6 +309,31 @@ namespace memo
     inline
     void decrement(UniquePtr<Gauge>&)
     {}
+
+    /// Increment a counter by @a value, if it is defined.
+    inline
+    void increment(UniquePtr<Counter>&, double)
+    {}
+
+    /// Set a gauge, if it is defined.
+    inline
+    void set(UniquePtr<Gauge>&, double)
+    {}
+
+    /// Add an observation to a histogram, if it is defined.
+    inline
+    void observe(UniquePtr<Histogram>&, double)
+    {}
+
+    /// Observe the time spent in a scope, in seconds.
+    class Timer
+    {
+    public:
+      Timer(UniquePtr<Histogram> const&)
+      {}
+
+      Timer(Timer const&) = delete;
+    };
   }
 }
 #endif
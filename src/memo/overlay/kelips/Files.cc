@@ -0,0 +1,195 @@
+#include <memo/overlay/kelips/Files.hh>
+
+#include <elle/assert.hh>
+
+namespace memo
+{
+  namespace overlay
+  {
+    namespace kelips
+    {
+      Files::Files(Address self, int threshold)
+        : _self(self)
+        , _threshold(threshold)
+      {}
+
+      std::pair<File const*, bool>
+      Files::insert(File file)
+      {
+        if (auto res = this->_find(file.address, file.home_node))
+          return {res, false};
+        auto address = file.address;
+        auto& res =
+          this->_entries.emplace(std::move(address), std::move(file))->second;
+        this->_index(&res);
+        return {&res, true};
+      }
+
+      File const*
+      Files::find(Address const& address, Address const& home) const
+      {
+        auto const range = this->_entries.equal_range(address);
+        for (auto it = range.first; it != range.second; ++it)
+          if (it->second.home_node == home)
+            return &it->second;
+        return nullptr;
+      }
+
+      File*
+      Files::_find(Address const& address, Address const& home)
+      {
+        return const_cast<File*>(
+          static_cast<Files const*>(this)->find(address, home));
+      }
+
+      bool
+      Files::erase(Address const& address, Address const& home)
+      {
+        auto const range = this->_entries.equal_range(address);
+        for (auto it = range.first; it != range.second; ++it)
+          if (it->second.home_node == home)
+          {
+            this->_unindex(&it->second);
+            this->_entries.erase(it);
+            return true;
+          }
+        return false;
+      }
+
+      void
+      Files::seen(File const& file, Time time)
+      {
+        auto f = this->_find(file.address, file.home_node);
+        ELLE_ASSERT(f);
+        if (time <= f->last_seen)
+          return;
+        this->_unindex(f);
+        f->last_seen = time;
+        this->_index(f);
+      }
+
+      void
+      Files::gossiped(File const& file, Time time)
+      {
+        auto f = this->_find(file.address, file.home_node);
+        ELLE_ASSERT(f);
+        this->_unindex(f);
+        f->last_gossip = time;
+        ++f->gossip_count;
+        this->_index(f);
+      }
+
+      std::vector<File const*>
+      Files::fresh(int n) const
+      {
+        auto res = std::vector<File const*>{};
+        for (auto it = this->_fresh.begin();
+             it != this->_fresh.end() && signed(res.size()) < n; ++it)
+          res.emplace_back(std::get<2>(*it));
+        return res;
+      }
+
+      std::vector<File const*>
+      Files::stale(Time before, int n) const
+      {
+        auto res = std::vector<File const*>{};
+        for (auto it = this->_own.begin();
+             it != this->_own.end() && it->first < before &&
+               signed(res.size()) < n;
+             ++it)
+          res.emplace_back(it->second);
+        return res;
+      }
+
+      std::vector<File const*>
+      Files::rotation(int n) const
+      {
+        auto res = std::vector<File const*>{};
+        for (auto it = this->_gossip.begin();
+             it != this->_gossip.end() && signed(res.size()) < n; ++it)
+          res.emplace_back(it->second);
+        return res;
+      }
+
+      int
+      Files::expire(Time before)
+      {
+        auto res = 0;
+        while (!this->_seen.empty() && this->_seen.begin()->first < before)
+        {
+          auto const f = this->_seen.begin()->second;
+          auto const erased = this->erase(f->address, f->home_node);
+          ELLE_ASSERT(erased);
+          ++res;
+        }
+        return res;
+      }
+
+      std::pair<Files::const_iterator, Files::const_iterator>
+      Files::equal_range(Address const& address) const
+      {
+        return this->_entries.equal_range(address);
+      }
+
+      Files::const_iterator
+      Files::begin() const
+      {
+        return this->_entries.begin();
+      }
+
+      Files::const_iterator
+      Files::end() const
+      {
+        return this->_entries.end();
+      }
+
+      std::size_t
+      Files::size() const
+      {
+        return this->_entries.size();
+      }
+
+      std::size_t
+      Files::own_count() const
+      {
+        return this->_own.size();
+      }
+
+      std::size_t
+      Files::fresh_count() const
+      {
+        return this->_fresh.size();
+      }
+
+      bool
+      Files::empty() const
+      {
+        return this->_entries.empty();
+      }
+
+      void
+      Files::_index(File* f)
+      {
+        if (f->gossip_count < this->_threshold)
+          this->_fresh.emplace(f->gossip_count, f->last_gossip, f);
+        this->_gossip.emplace(f->last_gossip, f);
+        if (f->home_node == this->_self)
+          this->_own.emplace(f->last_gossip, f);
+        else
+          this->_seen.emplace(f->last_seen, f);
+      }
+
+      void
+      Files::_unindex(File* f)
+      {
+        if (f->gossip_count < this->_threshold)
+          this->_fresh.erase(std::make_tuple(f->gossip_count, f->last_gossip, f));
+        this->_gossip.erase(std::make_pair(f->last_gossip, f));
+        if (f->home_node == this->_self)
+          this->_own.erase(std::make_pair(f->last_gossip, f));
+        else
+          this->_seen.erase(std::make_pair(f->last_seen, f));
+      }
+    }
+  }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <elle/Duration.hh>
+#include <elle/attribute.hh>
+
+#include <memo/model/Address.hh>
+
+namespace memo
+{
+  namespace overlay
+  {
+    namespace kelips
+    {
+      struct File
+      {
+        model::Address address;
+        model::Address home_node;
+        elle::Time last_seen;
+        elle::Time last_gossip;
+        int gossip_count;
+      };
+
+      /// The file table of a node: which nodes of our group hold which
+      /// files.
+      ///
+      /// Besides looking up files by address, the table keeps the orders in
+      /// which to gossip about files and to expire them, updated as entries
+      /// change, so picking a gossip packet or clearing timed out entries
+      /// only costs the number of entries involved.  Entries must thus be
+      /// modified through the table.
+      class Files
+      {
+      public:
+        using Address = model::Address;
+        using Time = elle::Time;
+        using Entries = std::unordered_multimap<Address, File>;
+        using value_type = Entries::value_type;
+        using const_iterator = Entries::const_iterator;
+        /// A table for node @a self, where entries are new until gossiped
+        /// about @a threshold times.
+        Files(Address self = Address::null, int threshold = 0);
+        /// The indexes point into the entries, which survive moves only.
+        Files(Files const&) = delete;
+        Files(Files&&) = default;
+        Files&
+        operator =(Files&&) = default;
+        /// Add @a file, unless its home node is known to hold it already.
+        ///
+        /// @return The entry and whether it was inserted.
+        std::pair<File const*, bool>
+        insert(File file);
+        /// The entry for @a home holding @a address, if any.
+        File const*
+        find(Address const& address, Address const& home) const;
+        /// Forget that @a home holds @a address.
+        ///
+        /// @return Whether it was known.
+        bool
+        erase(Address const& address, Address const& home);
+        /// Record that @a file was announced alive at @a time.
+        void
+        seen(File const& file, Time time);
+        /// Record that we gossiped about @a file at @a time.
+        void
+        gossiped(File const& file, Time time);
+        /// Up to @a n new entries, least gossiped about first.
+        std::vector<File const*>
+        fresh(int n) const;
+        /// Up to @a n of our own entries not gossiped about since @a before,
+        /// oldest first.
+        std::vector<File const*>
+        stale(Time before, int n) const;
+        /// Up to @a n entries, least recently gossiped about first.
+        std::vector<File const*>
+        rotation(int n) const;
+        /// Forget the entries of other nodes not seen since @a before.
+        ///
+        /// @return How many entries were forgotten.
+        int
+        expire(Time before);
+        std::pair<const_iterator, const_iterator>
+        equal_range(Address const& address) const;
+        const_iterator
+        begin() const;
+        const_iterator
+        end() const;
+        std::size_t
+        size() const;
+        /// Number of our own entries.
+        std::size_t
+        own_count() const;
+        /// Number of new entries.
+        std::size_t
+        fresh_count() const;
+        bool
+        empty() const;
+        ELLE_ATTRIBUTE_R(Address, self);
+        ELLE_ATTRIBUTE_R(int, threshold);
+
+      private:
+        using Entry = File*;
+        using ByTime = std::set<std::pair<Time, Entry>>;
+        File*
+        _find(Address const& address, Address const& home);
+        void
+        _index(File* file);
+        void
+        _unindex(File* file);
+        ELLE_ATTRIBUTE(Entries, entries);
+        /// New entries, by gossip count then last gossip.
+        ELLE_ATTRIBUTE((std::set<std::tuple<int, Time, Entry>>), fresh);
+        /// All entries by last gossip.
+        ELLE_ATTRIBUTE(ByTime, gossip);
+        /// Our own entries by last gossip.
+        ELLE_ATTRIBUTE(ByTime, own);
+        /// Entries of other nodes by last seen.
+        ELLE_ATTRIBUTE(ByTime, seen);
+      };
+    }
+  }
+}
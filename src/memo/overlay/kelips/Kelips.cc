@@ -128,6 +128,11 @@ namespace memo
           return elle::Clock::now();
         }
 
+        /// Room left in gossip datagrams for the encryption envelope.
+        auto const gossip_envelope = 128;
+        /// Shortest interval between gossip packets, in seconds.
+        auto const gossip_shortest_interval = 0.05;
+
         void
         endpoints_update(std::vector<TimedEndpoint>& endpoints, Endpoint entry,
                          Time t = now())
@@ -212,6 +217,8 @@ namespace memo
       {
         static auto compression = memo::getenv("KELIPS_COMPRESSION", true);
         struct CompressPeerLocations{};
+        /// Gossiped files are sent sorted, with addresses delta encoded.
+        struct DeltaFiles{};
 
         template<typename T>
         elle::Buffer
@@ -224,6 +231,8 @@ namespace memo
           output.set_context(&dn);
           if (dn.version() >= elle::Version(0, 7, 0) && compression)
             output.set_context(CompressPeerLocations{});
+          if (dn.version() >= elle::Version(0, 10, 0) && compression)
+            output.set_context(DeltaFiles{});
           auto ptr = &(packet::Packet&)packet;
           output.serialize_forward(ptr);
           return buf;
@@ -274,6 +283,8 @@ namespace memo
             Serializer::SerializerIn input(stream, false);
             if (dn.version() >= elle::Version(0, 7, 0) && compression)
               input.set_context(CompressPeerLocations{});
+            if (dn.version() >= elle::Version(0, 10, 0) && compression)
+              input.set_context(DeltaFiles{});
             input.set_context(&dn);
             auto res = std::unique_ptr<packet::Packet>{};
             input.serialize_forward(res);
@@ -425,6 +436,119 @@ namespace memo
           return s.context().has<CompressPeerLocations>();
         }
 
+        static bool serialize_deltas(elle::serialization::Serializer& s)
+        {
+          return s.context().has<DeltaFiles>();
+        }
+
+        using GossipFiles =
+          std::unordered_multimap<Address, std::pair<Time, Address>>;
+
+        static
+        void
+        varint_out(elle::Buffer& buffer, uint64_t value)
+        {
+          for (; value >= 0x80; value >>= 7)
+          {
+            auto const byte = uint8_t(value | 0x80);
+            buffer.append(&byte, 1);
+          }
+          auto const byte = uint8_t(value);
+          buffer.append(&byte, 1);
+        }
+
+        /// Encode @a files sorted by address, each address as the length of
+        /// the prefix it shares with the previous one followed by the
+        /// remaining bytes, then the index of its home node and its age in
+        /// milliseconds, which unlike a date does not depend on clocks being
+        /// in sync.
+        static
+        void
+        files_out(elle::serialization::Serializer& s, GossipFiles const& files)
+        {
+          auto sorted = elle::make_vector(
+            files, [] (auto const& f) { return &f; });
+          boost::sort(sorted,
+                      [] (auto const* a, auto const* b)
+                      {
+                        return a->first < b->first;
+                      });
+          auto homes = std::vector<Address>{};
+          auto index = std::unordered_map<Address, int>{};
+          auto entries = elle::Buffer{};
+          auto const t = now();
+          auto prev = Address::null;
+          for (auto const* f: sorted)
+          {
+            auto const& value = f->first.value();
+            auto p = uint8_t(0);
+            while (p < 32 && value[p] == prev.value()[p])
+              ++p;
+            entries.append(&p, 1);
+            entries.append(value + p, 32 - p);
+            auto const home =
+              index.emplace(f->second.second, signed(homes.size()));
+            if (home.second)
+              homes.emplace_back(f->second.second);
+            varint_out(entries, home.first->second);
+            varint_out(
+              entries,
+              std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                  t - f->second.first).count(),
+                0));
+            prev = f->first;
+          }
+          s.serialize("file_homes", homes);
+          s.serialize("file_entries", entries);
+        }
+
+        static
+        GossipFiles
+        files_in(elle::serialization::SerializerIn& s)
+        {
+          auto const homes = s.deserialize<std::vector<Address>>("file_homes");
+          auto const entries = s.deserialize<elle::Buffer>("file_entries");
+          auto const invalid = []
+            {
+              elle::err<elle::serialization::Error>(
+                "invalid gossiped file entries");
+            };
+          auto pos = std::size_t(0);
+          auto const varint_in = [&]
+            {
+              auto res = uint64_t(0);
+              for (auto shift = 0; ; shift += 7)
+              {
+                if (pos >= entries.size() || shift > 63)
+                  invalid();
+                auto const byte = entries[pos++];
+                res |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                  return res;
+              }
+            };
+          auto res = GossipFiles{};
+          auto const t = now();
+          Address::Value value = {};
+          while (pos < entries.size())
+          {
+            auto const p = entries[pos++];
+            if (p > 32 || entries.size() - pos < 32u - p)
+              invalid();
+            std::copy(entries.contents() + pos,
+                      entries.contents() + pos + 32 - p,
+                      value + p);
+            pos += 32 - p;
+            auto const home = varint_in();
+            if (home >= homes.size())
+              invalid();
+            auto const age = std::chrono::milliseconds(varint_in());
+            res.emplace(Address(value), std::make_pair(t - age, homes[home]));
+          }
+          return res;
+        }
+
         struct Gossip: public Packet
         {
           Gossip() = default;
@@ -443,6 +567,14 @@ namespace memo
             s.serialize("contacts", contacts);
             if (!serialize_compress(s))
               s.serialize("files", files);
+            else if (serialize_deltas(s))
+            {
+              if (s.out())
+                files_out(s, files);
+              else
+                files = files_in(
+                  static_cast<elle::serialization::SerializerIn&>(s));
+            }
             else if (s.out())
             { // out
               std::vector<Address> addresses;
@@ -812,6 +944,12 @@ namespace memo
         , _dropped_gets(0)
         , _failed_puts(0)
         , _terminating(false)
+        , _gossip_mtu(memo::getenv("KELIPS_GOSSIP_MTU", 1200))
+        , _gossip_bandwidth(memo::getenv("KELIPS_GOSSIP_BANDWIDTH", 65536))
+        , _gossip_files(config.gossip.files)
+        , _gossip_interval(config.gossip.interval)
+        // A delta encoded address, home index and age.
+        , _gossip_entry_size(40)
       {
         if (!doughnut->encrypt_options().encrypt_rpc)
         {
@@ -822,6 +960,7 @@ namespace memo
         bool v6 = memo::getenv("IPV6", true)
           && doughnut->version() >= elle::Version(0, 7, 0);
         this->_self = Address(this->doughnut()->id());
+        this->_state.files = Files(this->_self, this->_config.gossip.new_threshold);
         if (!local)
           ELLE_LOG("Running in observer mode");
         start();
@@ -1345,6 +1484,8 @@ namespace memo
         input.set_context(this->doughnut());
         if (this->doughnut()->version() >= elle::Version(0, 7, 0) && packet::compression)
           input.set_context(packet::CompressPeerLocations{});
+        if (this->doughnut()->version() >= elle::Version(0, 10, 0) && packet::compression)
+          input.set_context(packet::DeltaFiles{});
         try
         {
           input.serialize_forward(packet);
@@ -1595,29 +1736,6 @@ namespace memo
 #undef CASE
       }
 
-      template <typename T, typename C, typename U>
-      void
-      filterAndInsert(std::vector<Address> files, int target_count,
-                      std::unordered_map<Address, std::pair<Time, T>>& res,
-                      C& data,
-                      T U::*access)
-      {
-        if (signed(files.size()) > target_count)
-        {
-          if (target_count < signed(files.size()) - target_count)
-            files = pick_n(files, target_count);
-          else
-            files = remove_n(files, files.size() - target_count);
-        }
-        for (auto const& f: files)
-        {
-          auto& fd = data.find(f)->second;
-          res.emplace(f, std::make_pair(fd.last_seen, fd.*access));
-          fd.last_gossip = now();
-          fd.gossip_count++;
-        }
-      }
-
       void
       Node::filterAndInsert(
         std::vector<Address> files, int target_count, int group,
@@ -1639,15 +1757,6 @@ namespace memo
         }
       }
 
-      void
-      Node::filterAndInsert(
-        std::vector<Address> files, int target_count,
-        std::unordered_map<Address, std::pair<Time, Address>>& res)
-      {
-        kelips::filterAndInsert(files, target_count, res, _state.files,
-                                &File::home_node);
-      }
-
       void
       filterAndInsert2(
         std::vector<Contact*> new_contacts, unsigned int max_new,
@@ -1747,192 +1856,150 @@ namespace memo
         return res;
       }
 
-      template<typename C, typename K, typename V>
-      bool
-      has(C const& c, K const& k, V const& v)
-      {
-        auto its = c.equal_range(k);
-        return boost::find_if(its,
-          [&](auto const& e) { return e.second.second == v;}) != its.second;
-      }
-
-      std::unordered_multimap<Address, std::pair<Time, Address>>
-      Node::pickFiles()
+      std::vector<File const*>
+      Node::pickFiles(int n)
       {
-        using Res = std::unordered_multimap<Address, std::pair<Time, Address>>;
         static auto bencher = elle::Bench<>{"kelips.pickFiles", 10s};
         auto bench_scope = bencher.scoped();
-        auto current_time = now();
-        int max_new = _config.gossip.files / 2;
-        int max_old = _config.gossip.files / 2 + (_config.gossip.files % 2);
-        ELLE_ASSERT_EQ(max_new + max_old, _config.gossip.files);
+        int max_new = n / 2;
+        int max_old = n / 2 + (n % 2);
         auto const timeout = _config.gossip.old_threshold;
-        // update self file last seen, this will avoid us some ifs at other places
-        int new_candidates = 0;
-        int old_candidates = 0;
-        for (auto& f: _state.files)
-        {
-          if (f.second.home_node == _self)
-            f.second.last_seen = current_time;
-          if (f.second.gossip_count < _config.gossip.new_threshold)
-            new_candidates++;
-          if (f.second.home_node == _self
-              && current_time - f.second.last_gossip > timeout)
-            old_candidates++;
-        }
-        {
-          static auto bench_new_candidates
-            = elle::Bench<double>{"kelips.newCandidates", 10s};
-          static auto bench_old_candidates
-            = elle::Bench<double>{"kelips.oldCandidates", 10s};
-          bench_new_candidates.add(new_candidates);
-          bench_old_candidates.add(old_candidates);
-        }
-        auto res = Res{};
-        if (new_candidates  >= max_new * 2)
-        {
-          // pick max_new indexes in 0..new_candidates
-          auto indexes = elle::pick_n(max_new, new_candidates);
-          int ipos = 0;
-          int idx = 0;
-          for (auto& f: _state.files)
-          {
-            if (ipos >= signed(indexes.size()))
-              break;
-            if (f.second.gossip_count < _config.gossip.new_threshold)
-            {
-              if (idx == indexes[ipos])
-              {
-                res.emplace(f.first,
-                            std::make_pair(f.second.last_seen, f.second.home_node));
-                ipos++;
-              }
-              ++idx;
-            }
-          }
-          ELLE_ASSERT_EQ(max_new, signed(res.size()));
-        }
-        else
-        {
-          // insert new files
-          auto new_files = std::vector<std::pair<Address, std::pair<Time, Address>>>{};
-          for (auto const& f: _state.files)
-          {
-            if (f.second.gossip_count < _config.gossip.new_threshold)
-            new_files.emplace_back(f.first,
-              std::make_pair(f.second.last_seen, f.second.home_node));
-          }
-          if (signed(new_files.size()) > max_new)
+        auto const& files = this->_state.files;
+        auto res = std::vector<File const*>{};
+        auto const pick = [&] (std::vector<File const*> const& candidates)
           {
-            if (max_new < signed(new_files.size()) - max_new)
-              new_files = pick_n(new_files, max_new);
-            else
-              new_files = remove_n(new_files, new_files.size() - max_new);
-          }
-          for (auto const& nf: new_files)
-            res.insert(nf);
-        }
-        if (old_candidates >= max_old * 2)
-        {
-          // pick max_new indexes in 0..new_candidates
-          auto indexes = elle::pick_n(max_old, old_candidates);
-          int ipos = 0;
-          int idx = 0;
-          for (auto& f: _state.files)
-          {
-            if (ipos >= signed(indexes.size()))
-              break;
-            if (f.second.home_node == _self
-                && current_time - f.second.last_gossip > timeout)
-            {
-              if (idx == indexes[ipos])
-              {
-                res.emplace(f.first,
-                            std::make_pair(f.second.last_seen, f.second.home_node));
-                ipos++;
-              }
-              ++idx;
-            }
-          }
-        }
-        else
-        {
-          // insert old files, only our own for which we can update the last_seen value
-          auto old_files = std::vector<std::pair<Address, std::pair<Time, Address>>>{};
-          for (auto& f: _state.files)
-            if (f.second.home_node == _self
-                && (current_time - f.second.last_gossip > timeout)
-                && !has(res, f.first, f.second.home_node))
-              old_files.emplace_back(f.first, std::make_pair(f.second.last_seen, f.second.home_node));
-          if (signed(old_files.size()) > max_old)
-          {
-            if (max_old < signed(old_files.size()) - max_old)
-              old_files = pick_n(old_files, max_old);
-            else
-              old_files = remove_n(old_files, old_files.size() - max_old);
-          }
-          for (auto const& nf: old_files)
-            res.insert(nf);
-        }
-        // Check if we have room for more files
-        if (res.size() < (unsigned)_config.gossip.files)
+            for (auto f: candidates)
+              if (signed(res.size()) < n && boost::range::find(res, f) == res.end())
+                res.emplace_back(f);
+          };
+        // insert new files
+        pick(files.fresh(max_new));
+        // insert old files, only our own for which we can update the
+        // last_seen value
+        pick(files.stale(now() - timeout, max_old));
+        // If there is still room, the files we gossiped about least recently
+        if (signed(res.size()) < n)
+          pick(files.rotation(n));
+        return res;
+      }
+
+      void
+      Node::packFiles(packet::Gossip& p, std::vector<File const*> const& files)
+      {
+        auto const current_time = now();
+        p.files.clear();
+        auto const base = signed(serialize(p, *this->doughnut()).size());
+        auto const room = this->_gossip_mtu - gossip_envelope;
+        auto n = signed(files.size());
+        auto size = base;
+        while (n)
         {
-          int n = _config.gossip.files - res.size();
-          // Pick at random
-          std::vector<std::pair<Address, std::pair<Time, Address>>> available;
-          for (auto const& f: _state.files)
-          {
-            if (!has(res, f.first, f.second.home_node))
-              available.emplace_back(f.first, std::make_pair(f.second.last_seen, f.second.home_node));
-          }
-          if (available.size() > unsigned(n))
-          {
-            if (n < signed(available.size()) - n)
-              available = pick_n(available, n);
-            else
-              available = remove_n(available, available.size() - n);
-          }
-          for (auto const& nf: available)
-          {
-            res.insert(nf);
-          }
+          p.files.clear();
+          for (int i = 0; i < n; ++i)
+            // Our own files are alive as long as we are.
+            p.files.emplace(
+              files[i]->address,
+              std::make_pair(
+                files[i]->home_node == _self ? current_time : files[i]->last_seen,
+                files[i]->home_node));
+          size = signed(serialize(p, *this->doughnut()).size());
+          if (size <= room || n == 1)
+            break;
+          // Shrink in proportion, at least by one.
+          n = std::max(1, std::min(n - 1, n * (room - base) / (size - base)));
         }
-        for (auto const& r: res)
+        if (n)
+          this->_gossip_entry_size +=
+            (double(size - base) / n - this->_gossip_entry_size) / 16;
+        for (int i = 0; i < n; ++i)
+          this->_state.files.gossiped(*files[i], current_time);
+        static auto bench_packed = elle::Bench<double>{"kelips.packedFiles", 10s};
+        bench_packed.add(n);
+      }
+
+      void
+      Node::adaptGossip()
+      {
+        // Others keep the files we hold alive as long as we gossip about
+        // them, and new files must spread.  Leave others time to hear about
+        // each more than once before it expires.
+        auto const files = double(
+          this->_state.files.own_count() + this->_state.files.fresh_count());
+        auto const period = std::chrono::duration<double>(
+          this->_config.file_timeout / 4).count();
+        auto const longest = std::chrono::duration<double>(
+          this->_config.gossip.interval).count();
+        auto const capacity = std::max(
+          1, int((this->_gossip_mtu - gossip_envelope) /
+                 std::max(this->_gossip_entry_size, 1.)));
+        // Full packets to every group target must fit the budget.
+        auto const shortest = std::max(
+          gossip_shortest_interval,
+          this->_gossip_bandwidth
+          ? double(this->_gossip_mtu) *
+            std::max(this->_config.gossip.group_target, 1) /
+            this->_gossip_bandwidth
+          : 0.);
+        auto const needed = files * longest / period;
+        auto interval = longest;
+        auto n = std::max(this->_config.gossip.files, int(std::ceil(needed)));
+        if (n > capacity)
+        {
+          n = capacity;
+          interval = std::min(longest, period * capacity / files);
+        }
+        if (interval < shortest)
+          interval = shortest;
+        if (files * interval / n > period)
         {
-          auto its = _state.files.equal_range(r.first);
-          auto it = boost::find_if(its,
-            [&](auto const& e) { return r.second.second == e.second.home_node;});
-          it->second.gossip_count++;
-          it->second.last_gossip = current_time;
-        }
-        assert(res.size() == unsigned(_config.gossip.files) || res.size() == _state.files.size());
-        return res;
+          ELLE_TRACE_SCOPE(
+            "%s: too many files for configuration: "
+            "files=%s, per packet=%s, interval=%ss, timeout=%s",
+            *this, files, n, interval,
+            this->_config.file_timeout);
+          // We're assuming each node has roughly the same number of files,
+          // so others will increase their timeout as we do.
+          this->_config.file_timeout = std::max(
+            this->_config.file_timeout,
+            std::chrono::duration_cast<Duration>(
+              std::chrono::duration<double>(4 * files * interval / n)));
+          ELLE_DEBUG("Increasing timeout to %s", this->_config.file_timeout);
+        }
+        auto const gossip_interval = std::chrono::duration_cast<Duration>(
+          std::chrono::duration<double>(interval));
+        if (n != this->_gossip_files || gossip_interval != this->_gossip_interval)
+          ELLE_DEBUG("%s: gossip %s files every %s for %s files",
+                     *this, n, gossip_interval, files);
+        this->_gossip_files = n;
+        this->_gossip_interval = gossip_interval;
       }
 
       void
       Node::gossipEmitter()
       {
-        elle::reactor::sleep(elle::pick_one(_config.gossip.interval));
+        elle::reactor::sleep(elle::pick_one(this->_gossip_interval));
         packet::Gossip p;
         p.sender = _self;
         p.observer = _observer;
         while (true)
         {
-          elle::reactor::sleep(_config.gossip.interval);
+          elle::reactor::sleep(this->_gossip_interval);
           p.contacts.clear();
           p.files.clear();
           p.contacts = pickContacts();
-          elle::Buffer buf = serialize(p, *this->doughnut());
           auto targets = pickOutsideTargets();
           for (auto const& a: targets)
             if (auto it = elle::find(_state.contacts[group_of(a)], a))
               send(p, it->second);
           // Add some files, just for group targets
-          p.files = pickFiles();
-          buf = serialize(p, *this->doughnut());
           targets = pickGroupTargets();
-          if (p.files.size() && targets.empty())
-            ELLE_TRACE("%s: have files but no group member known", *this);
+          if (targets.empty())
+          {
+            if (!this->_state.files.empty())
+              ELLE_TRACE("%s: have files but no group member known", *this);
+            continue;
+          }
+          this->packFiles(p, this->pickFiles(this->_gossip_files));
           for (auto const& a: targets)
           {
             if (!p.files.empty())
@@ -2041,25 +2108,22 @@ namespace memo
           bool changed = false;
           for (auto const& f: p->files)
           {
-            auto its = _state.files.equal_range(f.first);
-            auto it = boost::find_if(its, [&](auto const& i) {
-                return i.second.home_node == f.second.second;});
-            if (it == its.second)
+            auto const it = _state.files.insert(
+              File{f.first, f.second.second, f.second.first, Time(), 0});
+            if (it.second)
             {
               changed = true;
-              _state.files.emplace(f.first,
-                                   File{f.first, f.second.second, f.second.first, Time(), 0});
               ELLE_DUMP("%s: registering %f live since %s", *this,
                          f.first, now() - f.second.first);
             }
             else
             {
               ELLE_DUMP("%s: %s %s %s %x", *this,
-                       it->second.last_seen < f.second.first,
-                       it->second.last_seen,
+                       it.first->last_seen < f.second.first,
+                       it.first->last_seen,
                        f.second.first,
                        f.first);
-              it->second.last_seen = std::max(it->second.last_seen, f.second.first);
+              _state.files.seen(*it.first, f.second.first);
             }
           }
           if (changed)
@@ -2072,7 +2136,8 @@ namespace memo
       {
         packet::Gossip res;
         res.sender = _self;
-        res.files = pickFiles();
+        res.observer = _observer;
+        this->packFiles(res, this->pickFiles(this->_gossip_files));
         send(res, p->endpoint, p->sender);
       }
 
@@ -2715,16 +2780,9 @@ namespace memo
               {
                 if (fg == _group && !query_node)
                 { // oportunistically add the entry to our tables
-                  auto its = _state.files.equal_range(file);
-                  auto it_r = boost::find_if(its,
-                    [&](std::pair<const memo::model::Address, File> const& f) {
-                      return f.second.home_node == e.id();
-                    });
-                  if (it_r == its.second)
-                  {
-                    _state.files.emplace(file, File{file, e.id(), now(), Time(), 0});
+                  if (_state.files.insert(
+                        File{file, e.id(), now(), Time(), 0}).second)
                     this->_update_reachable_blocks();
-                  }
                 }
                 if (result_set.insert(e.id()).second)
                   yield(e);
@@ -2996,22 +3054,7 @@ namespace memo
       Node::cleanup()
       {
         static auto bench = elle::Bench<int>{"kelips.cleared_files", 10s};
-        auto it = _state.files.begin();
-        auto t = now();
-        auto file_timeout = _config.file_timeout;
-        int cleared = 0;
-        while (it != _state.files.end())
-        {
-          if (it->second.home_node != _self
-              && t - it->second.last_seen > file_timeout)
-          {
-            ELLE_DUMP("%s: erase file %x", *this, it->first);
-            it = _state.files.erase(it);
-            ++cleared;
-          }
-          else
-            ++it;
-        }
+        auto const cleared = _state.files.expire(now() - _config.file_timeout);
         if (cleared)
           this->_update_reachable_blocks();
         bench.add(cleared);
@@ -3066,36 +3109,7 @@ namespace memo
           else
             ++it;
         }
-        auto time_send_all
-          = _state.files.size() / (_config.gossip.files/2) *  _config.gossip.interval;
-        ELLE_DUMP("time_send_all is %s", time_send_all);
-        if (time_send_all >= _config.file_timeout / 4)
-        {
-          ELLE_TRACE_SCOPE(
-            "%s: too many files for configuration: "
-            "files=%s, per packet=%s, interval=%s, timeout=%s",
-            *this, _state.files.size(), _config.gossip.files,
-            _config.gossip.interval, _config.file_timeout);
-          if (_config.gossip.files < 20)
-          {
-            // Keep it so it fits in 'standard' MTU of +/- 1k
-            _config.gossip.files = std::min(20, _config.gossip.files * 3 / 2);
-            ELLE_DEBUG("Increasing files/packet to %s", _config.gossip.files);
-          }
-          else if (_config.gossip.interval > 400ms)
-          {
-            _config.gossip.interval =
-              std::max(elle::Duration{400ms}, _config.gossip.interval * 2 / 3);
-            ELLE_DEBUG("Decreasing interval to %s", _config.gossip.interval);
-          }
-          else
-          {
-            // We're assuming each node has roughly the same number of files, so
-            // others will increase their timeout as we do.
-            _config.file_timeout =  _config.file_timeout * 3 / 2;
-            ELLE_DEBUG("Increasing timeout to %s", _config.file_timeout);
-          }
-        }
+        this->adaptGossip();
       }
 
       void
@@ -3106,15 +3120,9 @@ namespace memo
       void
       Node::store(memo::model::blocks::Block const& block)
       {
-        if (none_of(elle::as_range(_state.files.equal_range(block.address())),
-                    [&](Files::value_type const& f) {
-                      return f.second.home_node == _self;
-                    }))
-        {
-          _state.files.emplace(block.address(),
-                               File{block.address(), _self, now(), Time(), 0});
+        if (_state.files.insert(
+              File{block.address(), _self, now(), Time(), 0}).second)
           this->_update_reachable_blocks();
-        }
         auto itp = boost::range::find(_promised_files, block.address());
         if (itp != _promised_files.end())
         {
@@ -3126,16 +3134,8 @@ namespace memo
       void
       Node::remove(Address address)
       {
-        auto its = _state.files.equal_range(address);
-        for (auto it = its.first; it != its.second; ++it)
-        {
-          if (it->second.home_node == _self)
-          {
-            _state.files.erase(it);
-            this->_update_reachable_blocks();
-            break;
-          }
-        }
+        if (_state.files.erase(address, _self))
+          this->_update_reachable_blocks();
       }
 
       Overlay::WeakMember
@@ -3258,7 +3258,7 @@ namespace memo
         auto keys = l.storage()->list();
         for (auto const& k: keys)
         {
-          _state.files.emplace(k,
+          _state.files.insert(
             File{k, _self, now(), now(), _config.gossip.new_threshold + 1});
           //ELLE_DUMP("%s: reloaded %x", *this, k);
         }
@@ -3323,13 +3323,8 @@ namespace memo
           if (group_of(f.first) == _group
               && f.second != _self)
           {
-            auto its = _state.files.equal_range(f.first);
-            auto it = boost::find_if(its, [&](auto const& i) {
-                return i.second.home_node == f.second;});
-            if (it == its.second)
-              _state.files.emplace(f.first,
-                                   File{f.first, f.second, now(), now(),
-                                       this->_config.gossip.new_threshold + 1});
+            _state.files.insert(File{f.first, f.second, now(), now(),
+                                     this->_config.gossip.new_threshold + 1});
           }
         this->_update_reachable_blocks();
       }
@@ -3678,11 +3673,12 @@ namespace memo
             _config.gossip.files = std::stol(fpp);
             _config.gossip.interval = std::chrono::milliseconds(std::stol(interval));
             _config.file_timeout = std::chrono::milliseconds(std::stol(timeout));
+            this->adaptGossip();
           }
           else
             // FIXME: why not a Json object in res?
             return elle::sprintf("files per packet: %s,  interval: %s ms, timeout: %s",
-              _config.gossip.files, _config.gossip.interval, _config.file_timeout);
+              this->_gossip_files, this->_gossip_interval, _config.file_timeout);
         }
         else if (auto const t = elle::tail(k, "node."))
         {
@@ -3754,6 +3750,14 @@ namespace memo
             {"group", this->_group},
             {"statistics", elle::json::Object{
                 { "files", this->_state.files.size() },
+                { "gossip", elle::json::Object{
+                    { "files", this->_gossip_files },
+                    { "interval",
+                      std::chrono::duration_cast<std::chrono::milliseconds>(
+                        this->_gossip_interval).count() },
+                    { "entry_size", this->_gossip_entry_size },
+                  }
+                },
                 { "dropped_puts", this->_dropped_puts },
                 { "dropped_gets", this->_dropped_gets },
                 { "failed_puts", this->_failed_puts },
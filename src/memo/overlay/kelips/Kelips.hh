@@ -15,6 +15,7 @@
 #include <memo/model/doughnut/Local.hh>
 #include <memo/model/doughnut/Remote.hh>
 #include <memo/overlay/Overlay.hh>
+#include <memo/overlay/kelips/Files.hh>
 #include <memo/silo/Silo.hh>
 
 namespace std
@@ -61,16 +62,6 @@ namespace memo
       std::ostream&
       operator << (std::ostream& output, Contact const& contact);
 
-      struct File
-      {
-        Address address;
-        Address home_node;
-        Time last_seen;
-        Time last_gossip;
-        int gossip_count;
-      };
-
-      using Files = std::unordered_multimap<Address, File>;
       using Contacts = std::unordered_map<Address, Contact>;
       struct State
       {
@@ -271,10 +262,6 @@ namespace memo
         void
         onPutFileReply(packet::PutFileReply*);
         void
-        filterAndInsert(
-          std::vector<Address> files, int target_count,
-          std::unordered_map<Address, std::pair<Time, Address>>& p);
-        void
         filterAndInsert(
           std::vector<Address> files, int target_count, int group,
           std::unordered_map<Address, std::vector<TimedEndpoint>>& p);
@@ -301,8 +288,17 @@ namespace memo
           bool ignore_local_cache = false);
         std::vector<NodeLocation>
         kelipsPut(Address file, int n);
-        std::unordered_multimap<Address, std::pair<Time, Address>>
-        pickFiles();
+        /// Up to @a n files to gossip about, most urgent first.
+        std::vector<File const*>
+        pickFiles(int n);
+        /// Fill @a p with as many of @a files as fit in a datagram.
+        void
+        packFiles(packet::Gossip& p, std::vector<File const*> const& files);
+        /// Pick the number of files per packet and the gossip interval so
+        /// that the whole file table is gossiped about within the file
+        /// timeout, under the bandwidth budget.
+        void
+        adaptGossip();
         std::unordered_map<Address, std::vector<TimedEndpoint>>
         pickContacts();
         std::vector<Address>
@@ -381,6 +377,15 @@ namespace memo
           _bootstraper_threads;
         elle::reactor::MultiLockBarrier _in_use;
         bool _terminating;
+        /// Largest gossip datagram, in bytes.
+        ELLE_ATTRIBUTE_R(int, gossip_mtu);
+        /// Gossip bandwidth budget in bytes per second, zero for unlimited.
+        ELLE_ATTRIBUTE_R(int64_t, gossip_bandwidth);
+        /// Current files per packet and interval between packets.
+        ELLE_ATTRIBUTE_R(int, gossip_files);
+        ELLE_ATTRIBUTE_R(Duration, gossip_interval);
+        /// Average bytes a file takes in a gossip packet.
+        ELLE_ATTRIBUTE_R(double, gossip_entry_size);
       };
     }
   }
@@ -0,0 +1,671 @@
+#include <memo/overlay/kouncil/AddressBook.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include <elle/assert.hh>
+#include <elle/log.hh>
+
+ELLE_LOG_COMPONENT("memo.overlay.kouncil.AddressBook")
+
+namespace memo
+{
+  namespace overlay
+  {
+    namespace kouncil
+    {
+      namespace
+      {
+        auto const word_bits = 64u;
+
+        bool
+        test(std::vector<uint64_t> const& bitmap, uint32_t bit)
+        {
+          auto const word = bit / word_bits;
+          return word < bitmap.size() &&
+            (bitmap[word] >> (bit % word_bits)) & 1;
+        }
+
+        template <typename F>
+        void
+        each_bit(std::vector<uint64_t> const& bitmap, F const& f)
+        {
+          for (auto word = 0u; word < bitmap.size(); ++word)
+            for (auto bits = bitmap[word]; bits; bits &= bits - 1)
+              f(uint32_t(word * word_bits + __builtin_ctzll(bits)));
+        }
+
+        /// Ranges under which digests are kept up to date, by first byte.
+        auto const buckets = 256;
+
+        int
+        nibble(model::Address const& address, int i)
+        {
+          return (address.value()[i / 2] >> (i % 2 ? 0 : 4)) & 0xf;
+        }
+
+        int
+        digit(char c)
+        {
+          return c <= '9' ? c - '0' : c - 'a' + 10;
+        }
+
+        /// Compare the beginning of @a address to @a prefix.
+        int
+        compare(model::Address const& address, std::string const& prefix)
+        {
+          for (auto i = 0u; i < prefix.size(); ++i)
+            if (auto const d = nibble(address, i) - digit(prefix[i]))
+              return d;
+          return 0;
+        }
+
+        /// Hash of a block, the same on every host.
+        uint64_t
+        mix(model::Address const& address)
+        {
+          auto res = uint64_t(0);
+          for (auto word = 0; word < 4; ++word)
+          {
+            auto z = res;
+            for (auto i = 0; i < 8; ++i)
+              z ^= uint64_t(address.value()[word * 8 + i]) << (8 * i);
+            // SplitMix64 finalizer.
+            z += 0x9e3779b97f4a7c15;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            res = z ^ (z >> 31);
+          }
+          return res;
+        }
+
+        void
+        add(AddressBook::Digest& digest, uint64_t hash, int count)
+        {
+          digest.hash = int64_t(uint64_t(digest.hash) + hash * count);
+          digest.count += count;
+        }
+
+        void
+        add(AddressBook::Digest& digest, AddressBook::Digest const& other)
+        {
+          digest.hash = int64_t(uint64_t(digest.hash) + uint64_t(other.hash));
+          digest.count += other.count;
+        }
+      }
+
+      /*-------.
+      | Digest |
+      `-------*/
+
+      AddressBook::Digest::Digest()
+        : hash(0)
+        , count(0)
+      {}
+
+      AddressBook::Digest::Digest(elle::serialization::SerializerIn& s)
+        : Digest()
+      {
+        this->serialize(s);
+      }
+
+      void
+      AddressBook::Digest::serialize(elle::serialization::Serializer& s)
+      {
+        s.serialize("hash", this->hash);
+        s.serialize("count", this->count);
+      }
+
+      bool
+      AddressBook::Digest::operator ==(Digest const& other) const
+      {
+        return this->hash == other.hash && this->count == other.count;
+      }
+
+      bool
+      AddressBook::Digest::operator !=(Digest const& other) const
+      {
+        return !(*this == other);
+      }
+
+      /*-------------.
+      | Construction |
+      `-------------*/
+
+      std::string const AddressBook::digits = "0123456789abcdef";
+
+      AddressBook::AddressBook()
+        : _size(0)
+        , _dead(0)
+      {}
+
+      /*----------.
+      | Modifying |
+      `----------*/
+
+      bool
+      AddressBook::insert(Address const& node, Address const& block)
+      {
+        auto const id = this->_intern(node);
+        if (auto slot = this->_find(block))
+          return this->_hold(id, *slot);
+        this->_hold(id, this->_remember(block));
+        this->_maintain();
+        return true;
+      }
+
+      bool
+      AddressBook::erase(Address const& node, Address const& block)
+      {
+        auto const id = this->_node(node);
+        if (!id)
+          return false;
+        auto const slot = this->_find(block);
+        if (!slot || !this->_release(*id, *slot))
+          return false;
+        this->_maintain();
+        return true;
+      }
+
+      int
+      AddressBook::erase(Address const& node)
+      {
+        auto const id = this->_node(node);
+        if (!id)
+          return 0;
+        auto res = 0;
+        each_bit(
+          this->_bitmaps[*id],
+          [&] (Slot slot)
+          {
+            if (!--this->_holders[slot])
+              ++this->_dead;
+            ++res;
+          });
+        ELLE_DEBUG("%s: forget %s blocks of %f", this, res, node);
+        this->_size -= res;
+        Bitmap().swap(this->_bitmaps[*id]);
+        std::vector<Digest>().swap(this->_buckets[*id]);
+        this->_available[*id] = true;
+        this->_node_ids.erase(node);
+        this->_free_nodes.emplace_back(*id);
+        this->_maintain();
+        return res;
+      }
+
+      /*--------.
+      | Reading |
+      `--------*/
+
+      bool
+      AddressBook::contains(Address const& node, Address const& block) const
+      {
+        auto const id = this->_node(node);
+        auto const slot = this->_find(block);
+        return id && slot && test(this->_bitmaps[*id], *slot);
+      }
+
+      auto
+      AddressBook::blocks(Address const& node) const
+        -> std::vector<Address>
+      {
+        auto res = std::vector<Address>{};
+        if (auto id = this->_node(node))
+          each_bit(this->_bitmaps[*id],
+                   [&] (Slot slot)
+                   {
+                     res.emplace_back(this->_addresses[slot]);
+                   });
+        return res;
+      }
+
+      auto
+      AddressBook::nodes(Address const& block) const
+        -> std::vector<Address>
+      {
+        auto res = std::vector<Address>{};
+        auto const slot = this->_find(block);
+        if (!slot || !this->_holders[*slot])
+          return res;
+        // Freed nodes have empty bitmaps, and are skipped.
+        auto seen = 0;
+        for (auto id = Node(0); id < this->_bitmaps.size(); ++id)
+          if (test(this->_bitmaps[id], *slot))
+          {
+            if (this->_available[id])
+              res.emplace_back(this->_nodes[id]);
+            if (++seen == this->_holders[*slot])
+              break;
+          }
+        return res;
+      }
+
+      std::size_t
+      AddressBook::block_count() const
+      {
+        return this->_index.size() + this->_recent.size() - this->_dead;
+      }
+
+      std::size_t
+      AddressBook::node_count() const
+      {
+        return this->_node_ids.size();
+      }
+
+      std::size_t
+      AddressBook::memory() const
+      {
+        // Count a hash map entry as its value plus a node and bucket pointer.
+        auto res =
+          this->_nodes.capacity() * sizeof(Address) +
+          this->_node_ids.size() *
+            (sizeof(Address) + sizeof(Node) + 2 * sizeof(void*)) +
+          this->_node_ids.bucket_count() * sizeof(void*) +
+          this->_free_nodes.capacity() * sizeof(Node) +
+          this->_bitmaps.capacity() * sizeof(Bitmap) +
+          this->_addresses.capacity() * sizeof(Address) +
+          this->_holders.capacity() * sizeof(uint16_t) +
+          (this->_free.capacity() +
+           this->_index.capacity() +
+           this->_recent.capacity()) * sizeof(Slot);
+        for (auto const& bitmap: this->_bitmaps)
+          res += bitmap.capacity() * sizeof(uint64_t);
+        for (auto const& buckets: this->_buckets)
+          res += buckets.capacity() * sizeof(Digest);
+        return res;
+      }
+
+      elle::json::Object
+      AddressBook::stats() const
+      {
+        auto const memory = this->memory();
+        return {
+          {"entries", this->_size},
+          {"blocks", this->block_count()},
+          {"nodes", this->node_count()},
+          {"bytes", memory},
+          {"bytes_per_entry",
+           this->_size ? double(memory) / this->_size : 0.},
+        };
+      }
+
+      /*--------------.
+      | Anti-entropy |
+      `--------------*/
+
+      void
+      AddressBook::available(Address const& node, bool available)
+      {
+        if (auto id = this->_node(node))
+          this->_available[*id] = available;
+      }
+
+      auto
+      AddressBook::digest(Address const& node, std::string const& prefix) const
+        -> Digest
+      {
+        auto res = Digest();
+        auto const id = this->_node(node);
+        if (!id)
+          return res;
+        if (prefix.size() <= 2)
+        {
+          auto const& buckets = this->_buckets[*id];
+          for (auto b = 0; b < int(buckets.size()); ++b)
+            if (prefix.empty() ||
+                (b >> 4 == digit(prefix[0]) &&
+                 (prefix.size() == 1 || (b & 0xf) == digit(prefix[1]))))
+              add(res, buckets[b]);
+          return res;
+        }
+        auto const& bitmap = this->_bitmaps[*id];
+        this->_range(prefix, [&] (Slot slot)
+                     {
+                       if (test(bitmap, slot))
+                         add(res, mix(this->_addresses[slot]), 1);
+                     });
+        return res;
+      }
+
+      auto
+      AddressBook::digests(Address const& node, std::string const& prefix) const
+        -> std::vector<Digest>
+      {
+        auto res = std::vector<Digest>(AddressBook::digits.size());
+        auto const id = this->_node(node);
+        if (!id)
+          return res;
+        if (prefix.size() < 2)
+        {
+          auto const& buckets = this->_buckets[*id];
+          for (auto b = 0; b < int(buckets.size()); ++b)
+            if (prefix.empty())
+              add(res[b >> 4], buckets[b]);
+            else if (b >> 4 == digit(prefix[0]))
+              add(res[b & 0xf], buckets[b]);
+          return res;
+        }
+        auto const& bitmap = this->_bitmaps[*id];
+        this->_range(prefix, [&] (Slot slot)
+                     {
+                       auto const& address = this->_addresses[slot];
+                       if (test(bitmap, slot))
+                         add(res[nibble(address, prefix.size())],
+                             mix(address), 1);
+                     });
+        return res;
+      }
+
+      auto
+      AddressBook::blocks(Address const& node, std::string const& prefix) const
+        -> std::vector<Address>
+      {
+        auto res = std::vector<Address>{};
+        if (auto id = this->_node(node))
+        {
+          auto const& bitmap = this->_bitmaps[*id];
+          this->_range(prefix, [&] (Slot slot)
+                       {
+                         if (test(bitmap, slot))
+                           res.emplace_back(this->_addresses[slot]);
+                       });
+        }
+        return res;
+      }
+
+      std::pair<int, int>
+      AddressBook::assign(Address const& node,
+                          std::string const& prefix,
+                          std::vector<Address> blocks)
+      {
+        blocks.erase(
+          std::remove_if(blocks.begin(), blocks.end(),
+                         [&] (Address const& b)
+                         {
+                           return compare(b, prefix) != 0;
+                         }),
+          blocks.end());
+        std::sort(blocks.begin(), blocks.end());
+        blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+        auto current = this->blocks(node, prefix);
+        std::sort(current.begin(), current.end());
+        auto removed = std::vector<Address>{};
+        std::set_difference(current.begin(), current.end(),
+                            blocks.begin(), blocks.end(),
+                            std::back_inserter(removed));
+        auto added = std::vector<Address>{};
+        std::set_difference(blocks.begin(), blocks.end(),
+                            current.begin(), current.end(),
+                            std::back_inserter(added));
+        auto const id = this->_intern(node);
+        for (auto const& block: removed)
+          this->_release(id, *this->_find(block));
+        this->insert(node, added);
+        this->_maintain();
+        ELLE_DEBUG("%s: %f holds %s blocks under \"%s\": %s added, %s removed",
+                   this, node, blocks.size(), prefix,
+                   added.size(), removed.size());
+        return {int(added.size()), int(removed.size())};
+      }
+
+      bool
+      AddressBook::valid(std::string const& prefix)
+      {
+        return prefix.size() < 2 * sizeof(Address::Value) &&
+          prefix.find_first_not_of(AddressBook::digits) == std::string::npos;
+      }
+
+      /*--------.
+      | Details |
+      `--------*/
+
+      auto
+      AddressBook::_intern(Address const& node)
+        -> Node
+      {
+        if (auto id = this->_node(node))
+          return *id;
+        auto id = Node(this->_nodes.size());
+        if (this->_free_nodes.empty())
+        {
+          this->_nodes.emplace_back(node);
+          this->_bitmaps.emplace_back();
+          this->_buckets.emplace_back();
+          this->_available.emplace_back(true);
+        }
+        else
+        {
+          id = this->_free_nodes.back();
+          this->_free_nodes.pop_back();
+          this->_nodes[id] = node;
+        }
+        this->_buckets[id].resize(buckets);
+        this->_node_ids.emplace(node, id);
+        return id;
+      }
+
+      auto
+      AddressBook::_node(Address const& node) const
+        -> boost::optional<Node>
+      {
+        auto it = this->_node_ids.find(node);
+        if (it == this->_node_ids.end())
+          return boost::none;
+        return it->second;
+      }
+
+      auto
+      AddressBook::_find(Address const& block) const
+        -> boost::optional<Slot>
+      {
+        auto const lookup = [&] (std::vector<Slot> const& run)
+          -> boost::optional<Slot>
+          {
+            auto it = std::lower_bound(
+              run.begin(), run.end(), block,
+              [this] (Slot s, Address const& a)
+              {
+                return this->_addresses[s] < a;
+              });
+            if (it != run.end() && this->_addresses[*it] == block)
+              return *it;
+            return boost::none;
+          };
+        if (auto res = lookup(this->_index))
+          return res;
+        return lookup(this->_recent);
+      }
+
+      auto
+      AddressBook::_allocate(Address const& block)
+        -> Slot
+      {
+        auto slot = Slot(this->_addresses.size());
+        if (this->_free.empty())
+        {
+          ELLE_ASSERT_LT(this->_addresses.size(),
+                         std::numeric_limits<Slot>::max());
+          this->_addresses.emplace_back(block);
+          this->_holders.emplace_back(0);
+        }
+        else
+        {
+          slot = this->_free.back();
+          this->_free.pop_back();
+          this->_addresses[slot] = block;
+        }
+        ++this->_dead;
+        return slot;
+      }
+
+      auto
+      AddressBook::_remember(Address const& block)
+        -> Slot
+      {
+        auto const slot = this->_allocate(block);
+        this->_recent.insert(
+          std::upper_bound(
+            this->_recent.begin(), this->_recent.end(), block,
+            [this] (Address const& a, Slot s)
+            {
+              return a < this->_addresses[s];
+            }),
+          slot);
+        return slot;
+      }
+
+      bool
+      AddressBook::_hold(Node node, Slot slot)
+      {
+        auto& bitmap = this->_bitmaps[node];
+        auto const word = slot / word_bits;
+        auto const bit = uint64_t(1) << (slot % word_bits);
+        if (word >= bitmap.size())
+          bitmap.resize(word + 1, 0);
+        else if (bitmap[word] & bit)
+          return false;
+        bitmap[word] |= bit;
+        ELLE_ASSERT_LT(this->_holders[slot],
+                       std::numeric_limits<uint16_t>::max());
+        if (!this->_holders[slot]++)
+          --this->_dead;
+        ++this->_size;
+        auto const& address = this->_addresses[slot];
+        add(this->_buckets[node][address.value()[0]], mix(address), 1);
+        return true;
+      }
+
+      bool
+      AddressBook::_release(Node node, Slot slot)
+      {
+        if (!test(this->_bitmaps[node], slot))
+          return false;
+        this->_bitmaps[node][slot / word_bits] &=
+          ~(uint64_t(1) << (slot % word_bits));
+        if (!--this->_holders[slot])
+          ++this->_dead;
+        --this->_size;
+        auto const& address = this->_addresses[slot];
+        add(this->_buckets[node][address.value()[0]], mix(address), -1);
+        return true;
+      }
+
+      int
+      AddressBook::_insert_unknown(Node node, std::vector<Address> blocks)
+      {
+        if (blocks.empty())
+          return 0;
+        std::sort(blocks.begin(), blocks.end());
+        blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+        if (this->_recent.size() + blocks.size() <= this->_recent_limit())
+        {
+          for (auto const& block: blocks)
+            this->_hold(node, this->_remember(block));
+          this->_maintain();
+          return int(blocks.size());
+        }
+        auto slots = std::vector<Slot>{};
+        slots.reserve(blocks.size());
+        for (auto const& block: blocks)
+        {
+          slots.emplace_back(this->_allocate(block));
+          this->_hold(node, slots.back());
+        }
+        ELLE_DEBUG("%s: merge %s new blocks", this, slots.size());
+        this->_merge(slots);
+        return int(blocks.size());
+      }
+
+      void
+      AddressBook::_merge(std::vector<Slot> const& slots)
+      {
+        auto const by_address = [this] (Slot a, Slot b)
+          {
+            return this->_addresses[a] < this->_addresses[b];
+          };
+        auto runs = std::vector<Slot>{};
+        runs.reserve(this->_recent.size() + slots.size());
+        std::merge(this->_recent.begin(), this->_recent.end(),
+                   slots.begin(), slots.end(),
+                   std::back_inserter(runs), by_address);
+        auto index = std::vector<Slot>{};
+        index.reserve(this->_index.size() + runs.size() - this->_dead);
+        auto const keep = [&] (Slot slot)
+          {
+            if (this->_holders[slot])
+              index.emplace_back(slot);
+            else
+              this->_free.emplace_back(slot);
+          };
+        auto i = this->_index.begin();
+        auto r = runs.begin();
+        while (i != this->_index.end() || r != runs.end())
+          if (r == runs.end() || (i != this->_index.end() && by_address(*i, *r)))
+            keep(*i++);
+          else
+            keep(*r++);
+        ELLE_DUMP("%s: merged %s slots, freed %s",
+                  this, runs.size(), this->_dead);
+        this->_index = std::move(index);
+        this->_recent.clear();
+        this->_dead = 0;
+      }
+
+      template <typename F>
+      void
+      AddressBook::_range(std::string const& prefix, F const& f) const
+      {
+        for (auto const* run: {&this->_index, &this->_recent})
+        {
+          auto begin = std::lower_bound(
+            run->begin(), run->end(), prefix,
+            [this] (Slot s, std::string const& p)
+            {
+              return compare(this->_addresses[s], p) < 0;
+            });
+          auto end = std::upper_bound(
+            begin, run->end(), prefix,
+            [this] (std::string const& p, Slot s)
+            {
+              return compare(this->_addresses[s], p) > 0;
+            });
+          for (auto it = begin; it != end; ++it)
+            f(*it);
+        }
+      }
+
+      std::vector<uint16_t>
+      AddressBook::_unavailable_holders() const
+      {
+        auto res = std::vector<uint16_t>{};
+        for (auto id = Node(0); id < this->_available.size(); ++id)
+          if (!this->_available[id])
+          {
+            if (res.empty())
+              res.resize(this->_addresses.size(), 0);
+            each_bit(this->_bitmaps[id], [&] (Slot slot) { ++res[slot]; });
+          }
+        return res;
+      }
+
+      std::size_t
+      AddressBook::_recent_limit() const
+      {
+        // Inserting in the recent run is linear in its size, merging it in
+        // the index linear in the size of the index: balance the two.
+        return std::max<std::size_t>(
+          256, std::size_t(std::sqrt(this->_index.size())));
+      }
+
+      void
+      AddressBook::_maintain()
+      {
+        if (this->_recent.size() > this->_recent_limit() ||
+            this->_dead > std::max<std::size_t>(256, this->_index.size() / 8))
+          this->_merge({});
+      }
+    }
+  }
+}
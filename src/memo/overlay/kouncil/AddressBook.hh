@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <elle/attribute.hh>
+#include <elle/json/json.hh>
+#include <elle/serialization/Serializer.hh>
+
+#include <memo/model/Address.hh>
+
+namespace memo
+{
+  namespace overlay
+  {
+    namespace kouncil
+    {
+      /// Which blocks every node of the network holds.
+      ///
+      /// Every node keeps the whole book, so entries are kept compact: node
+      /// addresses are interned into small integers, block addresses are
+      /// stored once in slots, and each node has a bitmap of the slots it
+      /// holds.  Slots are looked up through an array sorted by address.
+      /// New blocks go to a small sorted run, and blocks no one holds
+      /// anymore stay as tombstones, until both are merged in the array in
+      /// a single pass.
+      ///
+      /// The blocks a node holds can be summed up by range, ranges being
+      /// hexadecimal prefixes of block addresses, so that two books can be
+      /// reconciled by comparing digests and transferring only the ranges
+      /// that differ.
+      class AddressBook
+      {
+      public:
+        using Address = model::Address;
+        /// Summary of a set of blocks.
+        struct Digest
+        {
+          Digest();
+          Digest(elle::serialization::SerializerIn& s);
+          void
+          serialize(elle::serialization::Serializer& s);
+          bool
+          operator ==(Digest const& other) const;
+          bool
+          operator !=(Digest const& other) const;
+          /// Sum of the hashes of the blocks.
+          int64_t hash;
+          int64_t count;
+        };
+        AddressBook();
+        /// Record that @a node holds @a block.
+        ///
+        /// @return Whether it was not known already.
+        bool
+        insert(Address const& node, Address const& block);
+        /// Record that @a node holds all @a blocks.
+        ///
+        /// @return How many entries were not known already.
+        template <typename Blocks>
+        int
+        insert(Address const& node, Blocks const& blocks);
+        /// Record that @a node no longer holds @a block.
+        ///
+        /// @return Whether it was known.
+        bool
+        erase(Address const& node, Address const& block);
+        /// Forget all blocks @a node holds.
+        ///
+        /// @return How many entries were removed.
+        int
+        erase(Address const& node);
+        bool
+        contains(Address const& node, Address const& block) const;
+        /// Blocks @a node holds.
+        std::vector<Address>
+        blocks(Address const& node) const;
+        /// Reachable nodes holding @a block.
+        std::vector<Address>
+        nodes(Address const& block) const;
+        /// Mark @a node as reachable or not.  The blocks of unreachable
+        /// nodes are kept, but they do not count as holders.
+        void
+        available(Address const& node, bool available);
+        /// Digest of the blocks @a node holds under @a prefix.
+        Digest
+        digest(Address const& node, std::string const& prefix) const;
+        /// Digests of the blocks @a node holds under each of the sixteen
+        /// ranges extending @a prefix by one digit.
+        std::vector<Digest>
+        digests(Address const& node, std::string const& prefix) const;
+        /// Blocks @a node holds under @a prefix.
+        std::vector<Address>
+        blocks(Address const& node, std::string const& prefix) const;
+        /// Record that the blocks @a node holds under @a prefix are exactly
+        /// @a blocks.
+        ///
+        /// @return How many entries were added and removed.
+        std::pair<int, int>
+        assign(Address const& node,
+               std::string const& prefix,
+               std::vector<Address> blocks);
+        /// Digits of ranges, one per half byte of the block addresses.
+        static std::string const digits;
+        /// Whether @a prefix is a valid range.
+        static
+        bool
+        valid(std::string const& prefix);
+        /// Call @a f with every block held by reachable nodes and their
+        /// number.
+        template <typename F>
+        void
+        each(F const& f) const;
+        /// Number of distinct blocks held.
+        std::size_t
+        block_count() const;
+        /// Number of nodes holding blocks.
+        std::size_t
+        node_count() const;
+        /// Approximate memory used, in bytes.
+        std::size_t
+        memory() const;
+        elle::json::Object
+        stats() const;
+        /// Number of (node, block) entries.
+        ELLE_ATTRIBUTE_R(std::size_t, size);
+
+      private:
+        using Slot = uint32_t;
+        using Node = uint32_t;
+        using Bitmap = std::vector<uint64_t>;
+        Node
+        _intern(Address const& node);
+        boost::optional<Node>
+        _node(Address const& node) const;
+        boost::optional<Slot>
+        _find(Address const& block) const;
+        /// A slot for @a block, counted as a tombstone until held.
+        Slot
+        _allocate(Address const& block);
+        /// A slot for @a block, in the recent run.
+        Slot
+        _remember(Address const& block);
+        bool
+        _hold(Node node, Slot slot);
+        bool
+        _release(Node node, Slot slot);
+        /// Record that @a node holds @a blocks, none of which have a slot.
+        int
+        _insert_unknown(Node node, std::vector<Address> blocks);
+        /// Merge the recent run and sorted @a slots in the index, dropping
+        /// tombstones.
+        void
+        _merge(std::vector<Slot> const& slots);
+        std::size_t
+        _recent_limit() const;
+        /// Merge when the recent run or tombstones grew too large.
+        void
+        _maintain();
+        /// Call @a f with the slots under @a prefix.
+        template <typename F>
+        void
+        _range(std::string const& prefix, F const& f) const;
+        /// Holders of each slot that are unreachable, if any.
+        std::vector<uint16_t>
+        _unavailable_holders() const;
+        /// Interned node addresses.
+        ELLE_ATTRIBUTE(std::vector<Address>, nodes);
+        ELLE_ATTRIBUTE((std::unordered_map<Address, Node>), node_ids);
+        ELLE_ATTRIBUTE(std::vector<Node>, free_nodes);
+        /// Slots held, by node.
+        ELLE_ATTRIBUTE(std::vector<Bitmap>, bitmaps);
+        /// Digests of the blocks held by each node, by first address byte.
+        ELLE_ATTRIBUTE(std::vector<std::vector<Digest>>, buckets);
+        /// Whether each node is reachable.
+        ELLE_ATTRIBUTE(std::vector<bool>, available);
+        /// Block addresses and number of holders, by slot.
+        ELLE_ATTRIBUTE(std::vector<Address>, addresses);
+        ELLE_ATTRIBUTE(std::vector<uint16_t>, holders);
+        ELLE_ATTRIBUTE(std::vector<Slot>, free);
+        /// Slots sorted by address.
+        ELLE_ATTRIBUTE(std::vector<Slot>, index);
+        /// Slots sorted by address, not merged in the index yet.
+        ELLE_ATTRIBUTE(std::vector<Slot>, recent);
+        /// Slots in the index or the recent run that no one holds.
+        ELLE_ATTRIBUTE(std::size_t, dead);
+      };
+
+      template <typename Blocks>
+      int
+      AddressBook::insert(Address const& node, Blocks const& blocks)
+      {
+        auto const id = this->_intern(node);
+        auto res = 0;
+        auto unknown = std::vector<Address>{};
+        for (auto const& block: blocks)
+          if (auto slot = this->_find(block))
+            res += this->_hold(id, *slot);
+          else
+            unknown.emplace_back(block);
+        res += this->_insert_unknown(id, std::move(unknown));
+        return res;
+      }
+
+      template <typename F>
+      void
+      AddressBook::each(F const& f) const
+      {
+        auto const unavailable = this->_unavailable_holders();
+        for (auto slot = Slot(0); slot < this->_addresses.size(); ++slot)
+          if (auto const holders = this->_holders[slot] -
+              (unavailable.empty() ? 0 : unavailable[slot]))
+            f(this->_addresses[slot], int(holders));
+      }
+    }
+  }
+}
@@ -3,6 +3,7 @@
 #include <boost/range/algorithm/sort.hpp>
 #include <boost/range/algorithm_ext/iota.hpp>
 
+#include <elle/err.hh>
 #include <elle/find.hh>
 #include <elle/log.hh>
 #include <elle/make-vector.hh>
@@ -13,6 +14,8 @@
 
 #include <elle/reactor/network/Error.hh>
 
+#include <memo/RPC.hh>
+#include <memo/environ.hh>
 // FIXME: can be avoided with a `Dock` accessor in `Overlay`
 #include <memo/model/doughnut/Doughnut.hh>
 #include <memo/model/doughnut/Local.hh>
@@ -36,6 +39,9 @@ namespace memo
       using Configuration = elle::das::tuple<
         decltype(symbols::storing)::Formal<bool>>;
 
+      /// Ranges compared at once, and fetched at once.
+      using Ranges = std::vector<std::string>;
+
       namespace
       {
         int64_t
@@ -44,44 +50,13 @@ namespace memo
           return std::chrono::duration_cast<std::chrono::milliseconds>(
                 t.time_since_epoch()).count();
         }
-      }
-
-      /*------.
-      | Entry |
-      `------*/
-
-      Kouncil::Entry::Entry(Address node, Address block)
-        : _node(std::move(node))
-        , _block(std::move(block))
-      {}
-
-      static
-      std::size_t
-      hash_value(Kouncil::Entry const& entry)
-      {
-        std::size_t seed = 0;
-        boost::hash_combine(seed, entry.node());
-        boost::hash_combine(seed, entry.block());
-        return seed;
-      }
 
-      static
-      bool
-      operator ==(Kouncil::Entry const& lhs, Kouncil::Entry const& rhs)
-      {
-        return lhs.node() == rhs.node() && lhs.block() == rhs.block();
-      }
-
-// This is unused, but could prove useful while debugging.
-#if 0
-      static
-      std::ostream&
-      operator <<(std::ostream& os, Kouncil::Entry const& e)
-      {
-        return elle::fprintf(os, is_fixed(os) ? "%f @ %f" : "%s @ %s",
-                             e.block(), e.node());
+        /// Ranges with at most that many blocks are fetched rather than
+        /// split further.
+        auto const sync_leaf = 64;
+        /// Ranges are never split beyond that many digits.
+        auto const sync_depth = 16u;
       }
-#endif
 
       /*-------------.
       | Construction |
@@ -95,6 +70,11 @@ namespace memo
         , _broadcast_thread(new elle::reactor::Thread(
                               elle::sprintf("%s: broadcast", this),
                               [this] { this->_broadcast(); }))
+        , _sync_interval(std::chrono::seconds(
+                           memo::getenv("KOUNCIL_SYNC_INTERVAL", 60)))
+        , _synced_probes(0)
+        , _synced_ranges(0)
+        , _synced_entries(0)
         , _eviction_delay(eviction_delay.value_or(200min))
       {
         ELLE_TRACE_SCOPE("%s: construct", this);
@@ -104,6 +84,12 @@ namespace memo
                     " before any reconnection attempt");
         if (local)
           _register_local(local);
+        if (this->_sync_interval > 0s &&
+            this->doughnut()->version() >= elle::Version(0, 10, 0))
+          this->_sync_thread.reset(
+            new elle::reactor::Thread(
+              elle::sprintf("%s: anti-entropy", this),
+              [this] { this->_anti_entropy(); }));
         // Add client-side Kouncil RPCs.
         this->_connections.emplace_back(
           this->doughnut()->dock().on_connection().connect(
@@ -130,14 +116,13 @@ namespace memo
                   "kouncil_change_entries",
                   [this, &r] (EntryChangeSet const& entries)
                   {
+                    auto inserted = std::vector<Address>{};
                     for (auto const& entry: entries)
                       if (entry.second)
-                        this->_address_book.emplace(r.id(), entry.first);
+                        inserted.emplace_back(entry.first);
                       else
-                      {
-                        Entry e(r.id(), entry.first);
-                        this->_address_book.get<2>().erase(e);
-                      }
+                        this->_address_book.erase(r.id(), entry.first);
+                    this->_address_book.insert(r.id(), inserted);
                     ELLE_TRACE("%s: added/removed %s entries from %f",
                                this, entries.size(), r.id());
                     this->_update_reachable_blocks();
@@ -147,8 +132,7 @@ namespace memo
                   "kouncil_add_entries",
                   [this, &r] (AddressSet const& entries)
                   {
-                    for (auto const& addr: entries)
-                      this->_address_book.emplace(r.id(), addr);
+                    this->_address_book.insert(r.id(), entries);
                     ELLE_TRACE("%s: added %s entries from %f",
                                this, entries.size(), r.id());
                     this->_update_reachable_blocks();
@@ -195,8 +179,7 @@ namespace memo
        ELLE_DEBUG("local endpoints: %s", local_endpoints);
        this->_infos.emplace(local->id(), local_endpoints, Clock::now(),
                             LamportAge(), this->storing());
-       for (auto const& key: local->storage()->list())
-         this->_address_book.emplace(this->id(), key);
+       this->_address_book.insert(this->id(), local->storage()->list());
        this->_update_reachable_blocks();
        ELLE_DEBUG("loaded %s entries from storage",
                   this->_address_book.size());
@@ -204,7 +187,7 @@ namespace memo
          [this] (model::blocks::Block const& b)
          {
            ELLE_DEBUG("%s: register new block %f", this, b.address());
-           this->_address_book.emplace(this->id(), b.address());
+           this->_address_book.insert(this->id(), b.address());
            this->_new_entries.emplace(b.address(), true);
            this->_update_reachable_blocks();
          }));
@@ -212,8 +195,7 @@ namespace memo
          [this] (model::blocks::Block const& b)
          {
            ELLE_DEBUG("%s: unregister block %f", this, b.address());
-           auto entry = Entry(this->id(), b.address());
-           ELLE_ENFORCE_EQ(this->_address_book.get<2>().erase(entry), 1u);
+           ELLE_ENFORCE(this->_address_book.erase(this->id(), b.address()));
            this->_new_entries.emplace(b.address(), false);
            this->_update_reachable_blocks();
          }));
@@ -226,20 +208,47 @@ namespace memo
              "kouncil_fetch_entries",
              [this] ()
              {
-               auto res = AddressSet{};
-               for (auto const& e: elle::equal_range(this->_address_book, this->id()))
-                 res.emplace(e.block());
-               return res;
+               auto const blocks = this->_address_book.blocks(this->id());
+               return AddressSet(blocks.begin(), blocks.end());
              });
+           if (this->doughnut()->version() >= elle::Version(0, 10, 0))
+           {
+             // Digest ranges of the blocks owned by this node.
+             rpcs.add(
+               "kouncil_digests",
+               [this] (Ranges const& ranges)
+               {
+                 return elle::make_vector(
+                   ranges,
+                   [this] (std::string const& range)
+                   {
+                     if (!AddressBook::valid(range))
+                       elle::err("invalid address range: %s", range);
+                     return this->_address_book.digests(this->id(), range);
+                   });
+               });
+             // List ranges of the blocks owned by this node.
+             rpcs.add(
+               "kouncil_fetch_ranges",
+               [this] (Ranges const& ranges)
+               {
+                 return elle::make_vector(
+                   ranges,
+                   [this] (std::string const& range)
+                   {
+                     if (!AddressBook::valid(range))
+                       elle::err("invalid address range: %s", range);
+                     return this->_address_book.blocks(this->id(), range);
+                   });
+               });
+           }
            // Lookup owners of a block on this node.
            rpcs.add(
              "kouncil_lookup",
              [this] (Address const& addr)
              {
-               auto res = AddressSet{};
-               for (auto const& e: elle::equal_range(_address_book.get<1>(), addr))
-                 res.emplace(e.node());
-               return res;
+               auto const nodes = this->_address_book.nodes(addr);
+               return AddressSet(nodes.begin(), nodes.end());
              });
            // Send known peers to this node and retrieve its known peers.
            if (this->doughnut()->version() < elle::Version(0, 8, 0))
@@ -279,6 +288,8 @@ namespace memo
         ELLE_TRACE_SCOPE("%s: destruct", this);
         // Stop all background operations.
         this->_broadcast_thread->terminate_now();
+        if (this->_sync_thread)
+          this->_sync_thread->terminate_now();
         {
           // Make sure none of the tasks will wake up during the
           // clear() and try to push a new task.
@@ -334,6 +345,14 @@ namespace memo
                            };
                        })
                 },
+              {"address_book", this->_address_book.stats()},
+              {"anti_entropy", elle::json::Object
+                {
+                  {"interval", elle::sprintf("%s", this->_sync_interval)},
+                  {"probes", this->_synced_probes},
+                  {"ranges", this->_synced_ranges},
+                  {"entries", this->_synced_entries},
+                }},
               {"mutable_blocks", rb.mutable_blocks},
               {"immutable_blocks", rb.immutable_blocks},
               {"underreplicated_immutable_blocks", rb.underreplicated_immutable_blocks},
@@ -414,6 +433,35 @@ namespace memo
         }
       }
 
+      void
+      Kouncil::_anti_entropy()
+      {
+        while (true)
+        {
+          elle::reactor::sleep(this->_sync_interval);
+          auto remotes = std::vector<std::shared_ptr<Remote>>{};
+          for (auto const& peer: this->_peers)
+            if (auto r = std::dynamic_pointer_cast<Remote>(peer))
+              remotes.emplace_back(std::move(r));
+          for (auto r: elle::pick_n(std::min(1, int(remotes.size())), remotes))
+            try
+            {
+              this->_sync_entries(**r);
+            }
+            catch (elle::reactor::network::Error const& e)
+            {
+              ELLE_TRACE("%s: unable to reconcile entries of %f: %s",
+                         this, **r, e);
+            }
+            catch (elle::Error const& e)
+            {
+              // Try again, maybe with another peer, next tick.
+              ELLE_WARN("%s: unable to reconcile entries of %f: %s",
+                        this, **r, e);
+            }
+        }
+      }
+
       /*------.
       | Peers |
       `------*/
@@ -490,6 +538,7 @@ namespace memo
         // The peer can be missing from `_infos` for external discoveries.
         if (auto info = elle::find(this->_infos, peer->id()))
           this->_infos.modify(info, [] (PeerInfo& pi) {pi.storing(true);});
+        this->_address_book.available(peer->id(), true);
         this->_advertise(*peer);
         this->_fetch_entries(*peer);
         ELLE_DUMP("%f: signaling connection to %f",
@@ -513,7 +562,9 @@ namespace memo
               pi.storing(boost::none);
             });
         this->_peers.erase(id);
-        this->_address_book.erase(id);
+        // Keep its entries until eviction: should it come back, only what
+        // changed meanwhile needs to be transferred.
+        this->_address_book.available(id, false);
         this->_update_reachable_blocks();
         peer.reset();
         if (!this->_cleaning)
@@ -611,9 +662,8 @@ namespace memo
         return [this, address, n](MemberGenerator::yielder const& yield)
           {
             int count = 0;
-            for (auto const& entry:
-                   elle::equal_range(this->_address_book.get<1>(), address))
-              if (auto p = elle::find(this->peers(), entry.node()))
+            for (auto const& node: this->_address_book.nodes(address))
+              if (auto p = elle::find(this->peers(), node))
               {
                 yield(*p);
                 if (++count >= n)
@@ -808,30 +858,99 @@ namespace memo
       Kouncil::_fetch_entries(Remote& r)
       {
         ELLE_TRACE_SCOPE("%f: fetch_entries of %f", this, r);
+        ELLE_ASSERT(r.id());
+        if (this->doughnut()->version() >= elle::Version(0, 10, 0))
+          return this->_sync_entries(r);
         auto fetch = r.make_rpc<auto () -> AddressSet>("kouncil_fetch_entries");
         auto entries = fetch();
-        ELLE_ASSERT(r.id());
-        for (auto const& b: entries)
-          this->_address_book.emplace(r.id(), b);
-        ELLE_DEBUG("added %s entries from %f", entries.size(), r);
+        auto const changes = this->_address_book.assign(
+          r.id(), "", std::vector<Address>(entries.begin(), entries.end()));
+        ELLE_DEBUG("fetched %s entries from %f: %s added, %s removed",
+                   entries.size(), r, changes.first, changes.second);
         this->_update_reachable_blocks();
       }
 
-      Overlay::ReachableBlocks
-      Kouncil::_compute_reachable_blocks() const
+      void
+      Kouncil::_sync_entries(Remote& r)
       {
-        std::unordered_map<Address, int> ids_mutable, ids_immutable;
-        for (auto const& entry: this->_address_book.get<2>())
+        ELLE_TRACE_SCOPE("%s: reconcile entries of %f", this, r);
+        using Digests = std::vector<std::vector<AddressBook::Digest>>;
+        auto digests =
+          r.make_rpc<auto (Ranges const&) -> Digests>("kouncil_digests");
+        auto fetch = r.make_rpc<
+          auto (Ranges const&) -> std::vector<std::vector<Address>>>(
+            "kouncil_fetch_ranges");
+        auto const id = r.id();
+        auto added = 0;
+        auto removed = 0;
+        auto const assign = [&] (std::string const& range,
+                                 std::vector<Address> blocks)
+          {
+            auto const changes =
+              this->_address_book.assign(id, range, std::move(blocks));
+            added += changes.first;
+            removed += changes.second;
+          };
+        // Split differing ranges until they are small enough to fetch.
+        // Without prior knowledge of the peer, there is nothing to compare.
+        auto fetched = Ranges{};
+        auto probe = Ranges{};
+        if (this->_address_book.digest(id, "").count)
+          probe.emplace_back("");
+        else
+          fetched.emplace_back("");
+        while (!probe.empty())
         {
-          if (entry.block().mutable_block())
-            ids_mutable[entry.block()] += 1;
-          else
-            ids_immutable[entry.block()] += 1;
+          auto const remote = digests(probe);
+          this->_synced_probes += probe.size();
+          if (remote.size() != probe.size())
+            elle::err("%f returned digests for %s ranges instead of %s",
+                      r, remote.size(), probe.size());
+          auto next = Ranges{};
+          for (auto i = 0u; i < probe.size(); ++i)
+          {
+            auto const local = this->_address_book.digests(id, probe[i]);
+            if (remote[i].size() != local.size())
+              elle::err("%f returned %s digests for range %s",
+                        r, remote[i].size(), probe[i]);
+            for (auto d = 0u; d < local.size(); ++d)
+              if (remote[i][d] != local[d])
+              {
+                auto range = probe[i] + AddressBook::digits[d];
+                if (!remote[i][d].count)
+                  assign(range, {});
+                else if (remote[i][d].count <= sync_leaf ||
+                         range.size() >= sync_depth)
+                  fetched.emplace_back(std::move(range));
+                else
+                  next.emplace_back(std::move(range));
+              }
+          }
+          probe = std::move(next);
         }
+        if (!fetched.empty())
+        {
+          auto blocks = fetch(fetched);
+          if (blocks.size() != fetched.size())
+            elle::err("%f returned blocks for %s ranges instead of %s",
+                      r, blocks.size(), fetched.size());
+          for (auto i = 0u; i < fetched.size(); ++i)
+            assign(fetched[i], std::move(blocks[i]));
+          this->_synced_ranges += fetched.size();
+        }
+        ELLE_DEBUG("fetched %s ranges: %s entries added, %s removed",
+                   fetched.size(), added, removed);
+        this->_synced_entries += added + removed;
+        // A broadcast crossing the reconciliation may be undone by it, and
+        // fixed by the next one.
+        if (added || removed)
+          this->_update_reachable_blocks();
+      }
+
+      Overlay::ReachableBlocks
+      Kouncil::_compute_reachable_blocks() const
+      {
         Overlay::ReachableBlocks res {0,0,0,0,0,0,0};
-        res.total_blocks = ids_mutable.size() + ids_immutable.size();
-        res.mutable_blocks = ids_mutable.size();
-        res.immutable_blocks = ids_immutable.size();
         int rf = 1;
         if (auto* pax = dynamic_cast<model::doughnut::consensus::Paxos*>(
           doughnut()->consensus().get()))
@@ -839,28 +958,35 @@ namespace memo
           rf = pax->factor();
         }
         int quorum = rf/2 + 1;
-        for (auto const& idcount: ids_immutable)
-        {
-          if (idcount.second > rf)
-            res.overreplicated_immutable_blocks++;
-          else if (idcount.second < rf)
-          {
-            res.underreplicated_immutable_blocks++;
-            if (res.sample_underreplicated.size() < 10)
-              res.sample_underreplicated.push_back(idcount.first);
-          }
-        }
-        for (auto const& idcount: ids_mutable)
-        {
-          if (idcount.second < rf)
+        this->_address_book.each(
+          [&] (Address const& block, int holders)
           {
-            res.underreplicated_mutable_blocks++;
-            if (res.sample_underreplicated.size() < 10)
-              res.sample_underreplicated.push_back(idcount.first);
-          }
-          if (idcount.second < quorum)
-            res.under_quorum_mutable_blocks++;
-        }
+            ++res.total_blocks;
+            if (block.mutable_block())
+            {
+              ++res.mutable_blocks;
+              if (holders < rf)
+              {
+                res.underreplicated_mutable_blocks++;
+                if (res.sample_underreplicated.size() < 10)
+                  res.sample_underreplicated.push_back(block);
+              }
+              if (holders < quorum)
+                res.under_quorum_mutable_blocks++;
+            }
+            else
+            {
+              ++res.immutable_blocks;
+              if (holders > rf)
+                res.overreplicated_immutable_blocks++;
+              else if (holders < rf)
+              {
+                res.underreplicated_immutable_blocks++;
+                if (res.sample_underreplicated.size() < 10)
+                  res.sample_underreplicated.push_back(block);
+              }
+            }
+          });
         return res;
       }
 
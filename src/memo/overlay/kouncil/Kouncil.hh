@@ -15,6 +15,7 @@
 
 #include <memo/model/doughnut/Peer.hh>
 #include <memo/overlay/Overlay.hh>
+#include <memo/overlay/kouncil/AddressBook.hh>
 
 namespace memo
 {
@@ -64,27 +65,8 @@ namespace memo
 
         /// Node and blocks address.
         using Address = model::Address;
-        /// Address book entry.
-        class Entry
-        {
-        public:
-          Entry(Address node, Address block);
-          ELLE_ATTRIBUTE_R(Address, node);
-          ELLE_ATTRIBUTE_R(Address, block);
-        };
-
         /// Node / owned block addresses mapping.
-        using AddressBook = bmi::multi_index_container<
-          Entry,
-          bmi::indexed_by<
-            bmi::hashed_non_unique<
-              bmi::const_mem_fun<
-                Entry, Address const&, &Entry::node>>,
-            bmi::hashed_non_unique<
-              bmi::const_mem_fun<
-                Entry, Address const&, &Entry::block>>,
-            bmi::hashed_unique<
-              bmi::identity<Entry>>>>;
+        using AddressBook = kouncil::AddressBook;
         /// Peers by id.
         using Peer = Overlay::Member;
         using Peers =
@@ -161,6 +143,18 @@ namespace memo
         ELLE_ATTRIBUTE((elle::reactor::Channel<std::pair<Address, bool>>),
                        new_entries);
         ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, broadcast_thread);
+        /// Reconcile the entries of a random peer periodically, to repair
+        /// missed broadcasts.
+        void
+        _anti_entropy();
+        /// Interval between reconciliations, zero to disable them.
+        ELLE_ATTRIBUTE_R(elle::Duration, sync_interval);
+        ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, sync_thread);
+        /// Ranges compared and fetched, and entries repaired, by
+        /// reconciliations.
+        ELLE_ATTRIBUTE(int64_t, synced_probes);
+        ELLE_ATTRIBUTE(int64_t, synced_ranges);
+        ELLE_ATTRIBUTE(int64_t, synced_entries);
 
       /*------.
       | Peers |
@@ -288,6 +282,10 @@ namespace memo
         _advertise(Remote& r);
         void
         _fetch_entries(Remote& r);
+        /// Reconcile our entries for @a r with its own, transferring only
+        /// ranges whose digests differ.
+        void
+        _sync_entries(Remote& r);
         void
         _perform(std::string const& name, std::function<void()> job);
         /// A peer appears to have disappeared.  We hope to see it again.
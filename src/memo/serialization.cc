@@ -30,6 +30,7 @@ namespace memo
       DEFINE((0, 9, 0), (0, 4, 0)),
       DEFINE((0, 9, 1), (0, 4, 0)),
       DEFINE((0, 9, 2), (0, 4, 0)),
+      DEFINE((0, 10, 0), (0, 4, 0)),
     };
 
 #undef DEFINE
@@ -0,0 +1,74 @@
+#include <memo/silo/BloomFilter.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace memo
+{
+  namespace silo
+  {
+    BloomFilter::BloomFilter(std::size_t capacity, double false_positive)
+      : _capacity(std::max(capacity, std::size_t(64)))
+      , _count(0)
+    {
+      auto const ln2 = std::log(2.);
+      // Optimal size and hash count for the requested false positive rate.
+      auto const bits = static_cast<std::size_t>(
+        std::ceil(-double(this->_capacity) * std::log(false_positive)
+                  / (ln2 * ln2)));
+      this->_bits.resize((bits + 63) / 64, 0);
+      this->_hashes = std::max(
+        1, static_cast<int>(std::round(
+             double(this->_bits.size() * 64) / this->_capacity * ln2)));
+    }
+
+    template <typename F>
+    void
+    BloomFilter::_each(Key const& key, F const& f) const
+    {
+      // Addresses are uniformly distributed, derive the indexes from two of
+      // their words by double hashing.
+      uint64_t h1;
+      uint64_t h2;
+      std::memcpy(&h1, key.value(), sizeof h1);
+      std::memcpy(&h2, key.value() + sizeof h1, sizeof h2);
+      h2 |= 1;
+      auto const size = this->_bits.size() * 64;
+      for (int i = 0; i < this->_hashes; ++i)
+        f((h1 + i * h2) % size);
+    }
+
+    void
+    BloomFilter::add(Key const& key)
+    {
+      this->_each(
+        key,
+        [this] (uint64_t bit)
+        {
+          this->_bits[bit / 64] |= uint64_t(1) << (bit % 64);
+        });
+      ++this->_count;
+    }
+
+    bool
+    BloomFilter::contains(Key const& key) const
+    {
+      auto res = true;
+      this->_each(
+        key,
+        [&] (uint64_t bit)
+        {
+          if (!(this->_bits[bit / 64] & (uint64_t(1) << (bit % 64))))
+            res = false;
+        });
+      return res;
+    }
+
+    bool
+    BloomFilter::full() const
+    {
+      return this->_count > this->_capacity;
+    }
+  }
+}
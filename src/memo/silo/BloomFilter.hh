@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <elle/attribute.hh>
+
+#include <memo/silo/Key.hh>
+
+namespace memo
+{
+  namespace silo
+  {
+    /// Probabilistic set of keys, without false negatives.
+    ///
+    /// Keys are hashes already, their bits are used directly to index the
+    /// filter.  Keys cannot be removed: a filter over a shrinking set only
+    /// gets more false positives, until it is rebuilt.
+    class BloomFilter
+    {
+    public:
+      /// Build a filter of @a capacity keys with the given false positive
+      /// rate once full.
+      BloomFilter(std::size_t capacity, double false_positive = 0.01);
+      void
+      add(Key const& key);
+      /// Whether @a key may have been added.
+      bool
+      contains(Key const& key) const;
+      /// Whether more keys than the capacity were added.
+      bool
+      full() const;
+      ELLE_ATTRIBUTE_R(std::size_t, capacity);
+      ELLE_ATTRIBUTE_R(std::size_t, count);
+    private:
+      template <typename F>
+      void
+      _each(Key const& key, F const& f) const;
+      ELLE_ATTRIBUTE(std::vector<uint64_t>, bits);
+      ELLE_ATTRIBUTE(int, hashes);
+    };
+  }
+}
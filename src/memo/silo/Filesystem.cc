@@ -1,14 +1,19 @@
 #include <memo/silo/Filesystem.hh>
 
-#include <iterator>
 #include <cstring>
 
+#include <boost/crc.hpp>
+#include <boost/endian/conversion.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <elle/algorithm.hh>
 #include <elle/bench.hh>
 #include <elle/Duration.hh>
+#include <elle/finally.hh>
 #include <elle/log.hh>
+#include <elle/reactor/scheduler.hh>
+#include <elle/With.hh>
 
 #include <memo/silo/Collision.hh>
 #include <memo/silo/MissingKey.hh>
@@ -18,6 +23,44 @@ using namespace std::literals;
 
 ELLE_LOG_COMPONENT("memo.silo.Filesystem");
 
+namespace
+{
+  /// Index layout, in little endian: magic, version, count, `count`
+  /// entries of (key, size), and the CRC-32 of all the above, so torn or
+  /// foreign indexes are rebuilt rather than trusted.
+  uint32_t const index_magic = 0x6d656d6f; // "memo"
+  uint32_t const index_version = 2;
+  auto const index_header_size = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+  auto const index_entry_size =
+    sizeof(memo::silo::Key::Value) + sizeof(uint64_t);
+
+  template <typename T>
+  void
+  put(elle::Buffer& buffer, T value)
+  {
+    boost::endian::native_to_little_inplace(value);
+    buffer.append(&value, sizeof value);
+  }
+
+  template <typename T>
+  T
+  get(uint8_t const*& pos)
+  {
+    auto res = T{};
+    ::memcpy(&res, pos, sizeof res);
+    pos += sizeof res;
+    return boost::endian::little_to_native(res);
+  }
+
+  uint32_t
+  checksum(uint8_t const* data, std::size_t size)
+  {
+    auto crc = boost::crc_32_type{};
+    crc.process_bytes(data, size);
+    return crc.checksum();
+  }
+}
+
 namespace memo
 {
   namespace silo
@@ -28,23 +71,40 @@ namespace memo
                            boost::optional<int64_t> capacity)
       : Silo(std::move(capacity))
       , _root(std::move(root))
+      , _consistent(false)
     {
       bfs::create_directories(this->_root);
-      for (auto const& dir: bfs::directory_iterator(this->_root))
-        if (is_directory(dir.path()))
-          for (auto const& block: bfs::directory_iterator(dir.path()))
-          {
-            auto const path = block.path();
-            auto const size = file_size(path);
-            auto const name = path.filename().string();
-            auto const addr = memo::model::Address::from_string(name);
-            this->_size_cache[addr] = size;
-            this->_usage += size;
-            this->_block_count += 1;
-            _notify_metrics();
-          }
+      if (this->_load_index())
+      {
+        if (elle::reactor::Scheduler::scheduler())
+          this->_check_thread.reset(new elle::reactor::Thread(
+            elle::sprintf("%s check", this), [this] { this->_check(); }));
+      }
+      else
+        this->_scan();
       ELLE_DEBUG("Recovering _usage (%s) and _size_cache (%s)",
                  this->_usage, this->_size_cache.size());
+      this->_notify_metrics();
+    }
+
+    Filesystem::~Filesystem()
+    {
+      // An interrupted or skipped check leaves the index unverified: let
+      // the next start scan instead.
+      this->_check_thread.reset();
+      if (!this->_consistent)
+      {
+        ELLE_TRACE("%s: index not checked, do not save it", this);
+        return;
+      }
+      try
+      {
+        this->checkpoint();
+      }
+      catch (elle::Error const& e)
+      {
+        ELLE_WARN("%s: unable to save index: %s", this, e);
+      }
     }
 
     elle::Buffer
@@ -58,11 +118,14 @@ namespace memo
       }
       static auto bench = elle::Bench<>{"bench.fsstorage.get", 10000s};
       auto bs = bench.scoped();
-      elle::Buffer res;
-      auto&& output = elle::IOStream(res.ostreambuf());
-      std::copy(std::istreambuf_iterator<char>(input),
-                std::istreambuf_iterator<char>(),
-                std::ostreambuf_iterator<char>(output));
+      // Read the whole file at once in a buffer of the right size.
+      input.seekg(0, std::ios::end);
+      auto const size = std::streamsize(input.tellg());
+      input.seekg(0);
+      auto res = elle::Buffer(size);
+      input.read(reinterpret_cast<char*>(res.mutable_contents()), size);
+      if (input.gcount() != size)
+        elle::err("unable to read %s", this->_path(key));
       ELLE_DUMP("content: %s", res);
       return res;
     }
@@ -91,6 +154,8 @@ namespace memo
         reinterpret_cast<const char*>(value.contents()), value.size());
       if (insert && update)
         ELLE_DEBUG("%s: block %s", *this, exists ? "updated" : "inserted");
+      if (this->_touched)
+        this->_touched->insert(key);
 
       this->_size_cache[key] = value.size();
       this->_block_count += exists ? 0 : 1;
@@ -109,6 +174,8 @@ namespace memo
         throw MissingKey(key);
       remove(path);
       this->_block_count -= 1;
+      if (this->_touched)
+        this->_touched->insert(key);
 
       int const delta = this->_size_cache[key];
       this->_size_cache.erase(key);
@@ -129,6 +196,15 @@ namespace memo
       return res;
     }
 
+    BlockStatus
+    Filesystem::_status(Key k)
+    {
+      if (!this->_consistent)
+        return BlockStatus::unknown;
+      return elle::contains(this->_size_cache, k)
+        ? BlockStatus::exists : BlockStatus::missing;
+    }
+
     bfs::path
     Filesystem::_path(Key const& key) const
     {
@@ -140,6 +216,195 @@ namespace memo
       return dir / elle::sprintf("%x", key);
     }
 
+    /*------.
+    | Index |
+    `------*/
+
+    bfs::path
+    Filesystem::_index_path() const
+    {
+      return this->root() / "index";
+    }
+
+    void
+    Filesystem::checkpoint() const
+    {
+      ELLE_TRACE_SCOPE("%s: save index of %s blocks",
+                       this, this->_size_cache.size());
+      auto const path = this->_index_path();
+      auto const tmp = bfs::path(path.string() + ".tmp");
+      auto content = elle::Buffer{};
+      put(content, index_magic);
+      put(content, index_version);
+      put(content, uint64_t(this->_size_cache.size()));
+      for (auto const& e: this->_size_cache)
+      {
+        content.append(e.first.value(), sizeof(Key::Value));
+        put(content, uint64_t(e.second));
+      }
+      put(content, checksum(content.contents(), content.size()));
+      {
+        auto&& output = bfs::ofstream(tmp, std::ios::binary);
+        if (!output.good())
+          elle::err("unable to open for writing: %s", tmp);
+        output.write(reinterpret_cast<char const*>(content.contents()),
+                     content.size());
+        output.flush();
+        if (!output.good())
+          elle::err("unable to write index: %s", tmp);
+      }
+      bfs::rename(tmp, path);
+    }
+
+    bool
+    Filesystem::_load_index()
+    {
+      auto const path = this->_index_path();
+      auto erc = boost::system::error_code{};
+      auto const size = bfs::file_size(path, erc);
+      if (erc)
+      {
+        ELLE_TRACE("%s: no index, scan blocks", this);
+        return false;
+      }
+      ELLE_TRACE_SCOPE("%s: load index (%s bytes)", this, size);
+      // Whatever happens, never trust this index twice: if we crash before
+      // the next checkpoint, the next start must rescan.
+      elle::SafeFinally remove([&] { bfs::remove(path, erc); });
+      auto content = elle::Buffer(size);
+      {
+        auto&& input = bfs::ifstream(path, std::ios::binary);
+        input.read(reinterpret_cast<char*>(content.mutable_contents()), size);
+        if (input.gcount() != static_cast<std::streamsize>(size))
+        {
+          ELLE_WARN("%s: unable to read index %s, scan blocks", this, path);
+          return false;
+        }
+      }
+      if (size < index_header_size + sizeof(uint32_t))
+      {
+        ELLE_WARN("%s: truncated index %s, scan blocks", this, path);
+        return false;
+      }
+      auto const body = size - sizeof(uint32_t);
+      auto trailer = static_cast<uint8_t const*>(content.contents() + body);
+      auto pos = static_cast<uint8_t const*>(content.contents());
+      auto const magic = get<uint32_t>(pos);
+      auto const version = get<uint32_t>(pos);
+      auto const count = get<uint64_t>(pos);
+      if (magic != index_magic
+          || version != index_version
+          || body != index_header_size + count * index_entry_size
+          || get<uint32_t>(trailer) != checksum(content.contents(), body))
+      {
+        ELLE_WARN("%s: invalid index %s, scan blocks", this, path);
+        return false;
+      }
+      this->_size_cache.reserve(count);
+      for (auto i = 0u; i < count; ++i)
+      {
+        auto const key = Key(pos);
+        pos += sizeof(Key::Value);
+        auto const size = get<uint64_t>(pos);
+        this->_size_cache[key] = size;
+        this->_usage += size;
+        this->_block_count += 1;
+      }
+      return true;
+    }
+
+    void
+    Filesystem::_scan()
+    {
+      ELLE_TRACE_SCOPE("%s: scan blocks", this);
+      for (auto const& dir: bfs::directory_iterator(this->_root))
+        if (is_directory(dir.path()))
+          for (auto const& block: bfs::directory_iterator(dir.path()))
+          {
+            auto const path = block.path();
+            auto const size = file_size(path);
+            auto const name = path.filename().string();
+            auto const addr = memo::model::Address::from_string(name);
+            this->_size_cache[addr] = size;
+            this->_usage += size;
+            this->_block_count += 1;
+          }
+      this->_consistent = true;
+    }
+
+    void
+    Filesystem::_check()
+    {
+      ELLE_TRACE_SCOPE("%s: check index consistency", this);
+      this->_touched.emplace();
+      elle::SafeFinally reset([&] { this->_touched.reset(); });
+      auto on_disk = std::unordered_map<Key, int>{};
+      // Walking the directories blocks, keep it off the reactor thread.  Walk
+      // one shard at a time so the check can be interrupted in between.
+      for (auto const& dir: bfs::directory_iterator(this->_root))
+        if (is_directory(dir.path()))
+        {
+          auto shard = std::vector<std::pair<Key, int>>{};
+          elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+          {
+            elle::reactor::background([&] {
+                for (auto const& block: bfs::directory_iterator(dir.path()))
+                  if (is_block(block))
+                    shard.emplace_back(
+                      Key::from_string(block.path().filename().string()),
+                      file_size(block.path()));
+              });
+          };
+          on_disk.insert(shard.begin(), shard.end());
+          elle::reactor::yield();
+        }
+      auto fixed = 0;
+      auto fix = [&] (Key const& k, int size, int previous)
+        {
+          ELLE_DEBUG("%s: fix index entry for %x: %s -> %s",
+                     this, k, previous, size);
+          this->_usage += size - previous;
+          ++fixed;
+        };
+      for (auto const& b: on_disk)
+      {
+        if (elle::contains(*this->_touched, b.first))
+          continue;
+        auto it = this->_size_cache.find(b.first);
+        if (it == this->_size_cache.end())
+        {
+          fix(b.first, b.second, 0);
+          this->_size_cache.emplace(b.first, b.second);
+          this->_block_count += 1;
+        }
+        else if (it->second != b.second)
+        {
+          fix(b.first, b.second, it->second);
+          it->second = b.second;
+        }
+      }
+      for (auto it = this->_size_cache.begin(); it != this->_size_cache.end();)
+        if (!elle::contains(on_disk, it->first) &&
+            !elle::contains(*this->_touched, it->first))
+        {
+          fix(it->first, 0, it->second);
+          this->_block_count -= 1;
+          it = this->_size_cache.erase(it);
+        }
+        else
+          ++it;
+      if (fixed)
+      {
+        ELLE_WARN("%s: fixed %s inconsistent index entries", this, fixed);
+        this->_notify_metrics();
+      }
+      this->_consistent = true;
+    }
+
+    /*--------------.
+    | Silo Config.  |
+    `--------------*/
+
     FilesystemSiloConfig::FilesystemSiloConfig(
         std::string name,
         std::string path,
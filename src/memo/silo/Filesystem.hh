@@ -1,7 +1,11 @@
 #pragma once
 
+#include <unordered_set>
+
 #include <boost/filesystem/path.hpp>
 
+#include <elle/reactor/Thread.hh>
+
 #include <memo/silo/Key.hh>
 #include <memo/silo/Silo.hh>
 
@@ -15,6 +19,7 @@ namespace memo
     public:
       Filesystem(boost::filesystem::path root,
                  boost::optional<int64_t> capacity = {});
+      ~Filesystem() override;
       std::string
       type() const override { return "filesystem"; }
 
@@ -27,11 +32,46 @@ namespace memo
       _erase(Key k) override;
       std::vector<Key>
       _list() override;
+      BlockStatus
+      _status(Key k) override;
       ELLE_ATTRIBUTE_R(boost::filesystem::path, root);
 
     private:
       boost::filesystem::path
       _path(Key const& key) const;
+
+    /*------.
+    | Index |
+    `------*/
+    public:
+      /// Persist the key → size index so the next start can skip the
+      /// directory scan.
+      void
+      checkpoint() const;
+    private:
+      /// Path of the persisted index.
+      boost::filesystem::path
+      _index_path() const;
+      /// Load the index written by the last clean shutdown, if any.
+      ///
+      /// The index is removed once loaded so that a crash falls back to a
+      /// full scan on the next start.
+      ///
+      /// @return Whether an index was loaded.
+      bool
+      _load_index();
+      /// Rebuild the index by walking every shard directory.
+      void
+      _scan();
+      /// Compare the loaded index with the on-disk blocks and fix any
+      /// discrepancy.
+      void
+      _check();
+      /// Keys modified while a consistency check is running.
+      ELLE_ATTRIBUTE(boost::optional<std::unordered_set<Key>>, touched);
+      ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, check_thread);
+      /// Whether the size cache is known to match the disk.
+      ELLE_ATTRIBUTE_R(bool, consistent);
     };
 
     struct FilesystemSiloConfig
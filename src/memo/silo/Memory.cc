@@ -1,5 +1,6 @@
 #include <memo/silo/Memory.hh>
 
+#include <elle/algorithm.hh>
 #include <elle/factory.hh>
 #include <elle/log.hh>
 
@@ -136,6 +137,13 @@ namespace memo
                                });
     }
 
+    BlockStatus
+    Memory::_status(Key k)
+    {
+      return elle::contains(*this->_blocks, k)
+        ? BlockStatus::exists : BlockStatus::missing;
+    }
+
     void
     MemorySiloConfig::serialize(elle::serialization::Serializer& s)
     {
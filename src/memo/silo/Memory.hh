@@ -41,6 +41,8 @@ namespace memo
       _erase(Key k) override;
       std::vector<Key>
       _list() override;
+      BlockStatus
+      _status(Key k) override;
       /// The blocks, with their deleter.
       ELLE_ATTRIBUTE((std::unique_ptr<Blocks, std::function<void (Blocks*)>>),
                      blocks);
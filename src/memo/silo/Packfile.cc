@@ -0,0 +1,620 @@
+#include <memo/silo/Packfile.hh>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef ELLE_WINDOWS
+# include <fcntl.h>
+# include <io.h>
+#else
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#include <boost/crc.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <elle/algorithm.hh>
+#include <elle/bench.hh>
+#include <elle/bytes.hh>
+#include <elle/factory.hh>
+#include <elle/finally.hh>
+#include <elle/log.hh>
+#include <elle/make-vector.hh>
+#include <elle/reactor/scheduler.hh>
+
+#include <memo/silo/Collision.hh>
+#include <memo/silo/InsufficientSpace.hh>
+#include <memo/silo/MissingKey.hh>
+
+using namespace std::literals;
+
+ELLE_LOG_COMPONENT("memo.silo.Packfile");
+
+namespace
+{
+  // On-disk layout, in host byte order.  A segment is a sequence of
+  // records, each a RecordHeader followed by `length` bytes of value.
+  // Sealed segments are followed by one TrailerEntry per record and a
+  // Footer.
+
+  uint32_t const record_magic = 0x70616b72; // "pakr"
+  uint32_t const footer_magic = 0x70616b66; // "pakf"
+
+  struct RecordHeader
+  {
+    uint32_t magic;
+    uint32_t kind;
+    memo::silo::Key::Value key;
+    uint32_t length;
+    uint32_t checksum;
+  };
+
+  struct TrailerEntry
+  {
+    memo::silo::Key::Value key;
+    uint32_t kind;
+    uint32_t length;
+    uint64_t offset;
+  };
+
+  struct Footer
+  {
+    uint64_t count;
+    uint64_t trailer_offset;
+    uint32_t magic;
+    uint32_t checksum;
+  };
+
+  uint32_t
+  checksum(memo::silo::Key::Value const& key, elle::ConstWeakBuffer value)
+  {
+    auto crc = boost::crc_32_type{};
+    crc.process_bytes(key, sizeof key);
+    crc.process_bytes(value.contents(), value.size());
+    return crc.checksum();
+  }
+
+  std::string const segment_prefix = "segment-";
+
+  /// The segment number in @a name, if it names a segment.
+  boost::optional<int>
+  segment_id(std::string const& name)
+  {
+    if (name.compare(0, segment_prefix.size(), segment_prefix) != 0)
+      return {};
+    auto const id = name.substr(segment_prefix.size());
+    if (id.empty() || id.size() > 9 ||
+        id.find_first_not_of("0123456789") != std::string::npos)
+      return {};
+    return std::stoi(id);
+  }
+
+  /// Write the content of @a path to disk.
+  void
+  sync_path(boost::filesystem::path const& path, bool directory)
+  {
+#ifdef ELLE_WINDOWS
+    // Directory entries can not be synced on Windows.
+    if (directory)
+      return;
+    auto const fd = ::_open(path.string().c_str(), _O_RDWR | _O_BINARY);
+#else
+    auto const fd = ::open(path.string().c_str(), O_RDONLY);
+#endif
+    if (fd < 0)
+      elle::err("unable to open %s: %s", path, std::strerror(errno));
+#ifdef ELLE_WINDOWS
+    elle::SafeFinally close([&] { ::_close(fd); });
+    auto const res = ::_commit(fd);
+#else
+    elle::SafeFinally close([&] { ::close(fd); });
+    auto const res = ::fsync(fd);
+#endif
+    if (res)
+      elle::err("unable to sync %s: %s", path, std::strerror(errno));
+  }
+}
+
+namespace memo
+{
+  namespace silo
+  {
+    namespace bfs = boost::filesystem;
+
+    Packfile::Packfile(bfs::path root,
+                       boost::optional<int64_t> capacity,
+                       boost::optional<int64_t> segment_size)
+      : Silo(std::move(capacity))
+      , _root(std::move(root))
+      , _segment_size(segment_size.value_or(64_MiB))
+      , _active(0)
+    {
+      bfs::create_directories(this->_root);
+      this->_recover();
+      if (elle::reactor::Scheduler::scheduler())
+        this->_compaction_thread.reset(new elle::reactor::Thread(
+          elle::sprintf("%s compaction", this),
+          [this] { this->_compaction(); }));
+      this->_notify_metrics();
+    }
+
+    Packfile::~Packfile()
+    {
+      this->_compaction_thread.reset();
+    }
+
+    /*-----.
+    | Silo |
+    `-----*/
+
+    elle::Buffer
+    Packfile::_get(Key key) const
+    {
+      static auto bench = elle::Bench<>{"bench.packfile.get", 10000s};
+      auto bs = bench.scoped();
+      auto it = this->_index.find(key);
+      if (it == this->_index.end())
+        throw MissingKey(key);
+      auto const& loc = it->second;
+      auto const path = this->_segment_path(loc.segment);
+      auto&& input = bfs::ifstream(path, std::ios::binary);
+      input.seekg(loc.offset + sizeof(RecordHeader));
+      auto res = elle::Buffer(loc.length);
+      input.read(reinterpret_cast<char*>(res.mutable_contents()), loc.length);
+      if (input.gcount() != static_cast<std::streamsize>(loc.length))
+        elle::err("unable to read %x from %s at %s", key, path, loc.offset);
+      ELLE_DUMP("content: %s", res);
+      return res;
+    }
+
+    int
+    Packfile::_set(Key key, elle::Buffer const& value,
+                   bool insert, bool update)
+    {
+      ELLE_TRACE("set %x", key);
+      static auto bench = elle::Bench<>{"bench.packfile.set", 10000s};
+      auto bs = bench.scoped();
+      auto it = this->_index.find(key);
+      bool const exists = it != this->_index.end();
+      int const size = exists ? it->second.length : 0;
+      int const delta = value.size() - size;
+      if (this->capacity() && this->usage() + delta > this->capacity())
+        throw InsufficientSpace(delta, this->usage(), this->capacity().get());
+      if (!exists && !insert)
+        throw MissingKey(key);
+      if (exists && !update)
+        throw Collision(key);
+      auto const loc = this->_append(Kind::value, key, value);
+      if (exists)
+      {
+        this->_release(it->second);
+        it->second = loc;
+      }
+      else
+      {
+        this->_index.emplace(key, loc);
+        this->_block_count += 1;
+      }
+      this->_size_cache[key] = value.size();
+      return delta;
+    }
+
+    int
+    Packfile::_erase(Key key)
+    {
+      ELLE_TRACE("erase %x", key);
+      static auto bench = elle::Bench<>{"bench.packfile.erase", 10000s};
+      auto bs = bench.scoped();
+      auto it = this->_index.find(key);
+      if (it == this->_index.end())
+        throw MissingKey(key);
+      this->_append(Kind::tombstone, key, {});
+      int const delta = it->second.length;
+      this->_release(it->second);
+      this->_index.erase(it);
+      this->_block_count -= 1;
+      return -delta;
+    }
+
+    std::vector<Key>
+    Packfile::_list()
+    {
+      return elle::make_vector(this->_index,
+                               [] (auto const& e) { return e.first; });
+    }
+
+    BlockStatus
+    Packfile::_status(Key k)
+    {
+      return elle::contains(this->_index, k)
+        ? BlockStatus::exists : BlockStatus::missing;
+    }
+
+    /*---------.
+    | Segments |
+    `---------*/
+
+    bfs::path
+    Packfile::_segment_path(int id) const
+    {
+      return this->_root / (segment_prefix + std::to_string(id));
+    }
+
+    std::vector<Packfile::Record>
+    Packfile::_records(int id, bool& sealed) const
+    {
+      auto const path = this->_segment_path(id);
+      auto const file_size = bfs::file_size(path);
+      auto&& input = bfs::ifstream(path, std::ios::binary);
+      auto res = std::vector<Record>{};
+      auto footer = Footer{};
+      if (file_size >= sizeof footer)
+      {
+        input.seekg(file_size - sizeof footer);
+        input.read(reinterpret_cast<char*>(&footer), sizeof footer);
+        auto const trailer_size = footer.count * sizeof(TrailerEntry);
+        if (input.good()
+            && footer.magic == footer_magic
+            && footer.trailer_offset + trailer_size + sizeof footer
+               == file_size)
+        {
+          auto trailer = elle::Buffer(trailer_size);
+          input.seekg(footer.trailer_offset);
+          input.read(reinterpret_cast<char*>(trailer.mutable_contents()),
+                     trailer_size);
+          auto crc = boost::crc_32_type{};
+          crc.process_bytes(trailer.contents(), trailer.size());
+          if (input.good() && crc.checksum() == footer.checksum)
+          {
+            sealed = true;
+            res.reserve(footer.count);
+            auto entry = TrailerEntry{};
+            for (auto i = 0u; i < footer.count; ++i)
+            {
+              ::memcpy(&entry, trailer.contents() + i * sizeof entry,
+                       sizeof entry);
+              res.push_back(Record{Key(entry.key),
+                                   static_cast<Kind>(entry.kind),
+                                   entry.offset,
+                                   entry.length});
+            }
+            return res;
+          }
+        }
+        ELLE_DEBUG("%s: segment %s is not sealed, scan records", this, id);
+        input.clear();
+        input.seekg(0);
+      }
+      // Not sealed: this is the segment we were appending to, scan records
+      // up to the first torn one.
+      sealed = false;
+      auto header = RecordHeader{};
+      auto offset = uint64_t(0);
+      auto value = elle::Buffer();
+      while (offset + sizeof header <= file_size)
+      {
+        input.read(reinterpret_cast<char*>(&header), sizeof header);
+        if (!input.good()
+            || header.magic != record_magic
+            || offset + sizeof header + header.length > file_size)
+          break;
+        value.size(header.length);
+        input.read(reinterpret_cast<char*>(value.mutable_contents()),
+                   header.length);
+        if (!input.good() || checksum(header.key, value) != header.checksum)
+          break;
+        res.push_back(Record{Key(header.key),
+                             static_cast<Kind>(header.kind),
+                             offset,
+                             header.length});
+        offset += sizeof header + header.length;
+      }
+      if (offset != file_size)
+      {
+        ELLE_WARN("%s: truncate torn segment %s from %s to %s bytes",
+                  this, path, file_size, offset);
+        input.close();
+        bfs::resize_file(path, offset);
+      }
+      return res;
+    }
+
+    void
+    Packfile::_recover()
+    {
+      ELLE_TRACE_SCOPE("%s: recover index", this);
+      auto ids = std::vector<int>{};
+      for (auto const& p: bfs::directory_iterator(this->_root))
+      {
+        auto const name = p.path().filename().string();
+        if (auto id = segment_id(name))
+          ids.emplace_back(*id);
+        else if (name.compare(0, segment_prefix.size(), segment_prefix) == 0)
+          ELLE_WARN("%s: ignore stray file %s", this, p.path());
+      }
+      std::sort(ids.begin(), ids.end());
+      for (auto id: ids)
+      {
+        bool sealed = false;
+        auto records = this->_records(id, sealed);
+        auto& segment = this->_segments[id];
+        segment.sealed = sealed;
+        segment.size = 0;
+        segment.live = 0;
+        segment.tombstones = 0;
+        for (auto const& r: records)
+        {
+          auto const size = sizeof(RecordHeader) + r.length;
+          segment.size = std::max(segment.size, r.offset + size);
+          auto it = this->_index.find(r.key);
+          if (it != this->_index.end())
+          {
+            this->_release(it->second);
+            this->_usage -= it->second.length;
+            this->_block_count -= 1;
+            this->_index.erase(it);
+            this->_size_cache.erase(r.key);
+          }
+          if (r.kind == Kind::tombstone)
+            segment.tombstones += 1;
+          if (r.kind == Kind::value)
+          {
+            segment.keys.insert(r.key);
+            this->_index.emplace(r.key, Location{id, r.offset, r.length});
+            this->_size_cache[r.key] = r.length;
+            this->_usage += r.length;
+            this->_block_count += 1;
+            segment.live += size;
+          }
+        }
+        if (!sealed)
+          this->_pending_trailer = std::move(records);
+      }
+      if (!ids.empty() && !this->_segments.at(ids.back()).sealed)
+        this->_open(ids.back());
+      else
+        this->_open(ids.empty() ? 0 : ids.back() + 1);
+      ELLE_DEBUG("recovered %s blocks (%s bytes) from %s segments",
+                 this->_block_count, this->_usage, ids.size());
+    }
+
+    void
+    Packfile::_open(int id)
+    {
+      ELLE_DEBUG("%s: open segment %s", this, id);
+      this->_active = id;
+      auto& segment = this->_segments[id];
+      if (segment.size == 0)
+        this->_pending_trailer.clear();
+      this->_output = std::make_unique<bfs::ofstream>(
+        this->_segment_path(id), std::ios::binary | std::ios::app);
+      if (!this->_output->good())
+        elle::err("unable to open for writing: %s", this->_segment_path(id));
+    }
+
+    void
+    Packfile::_seal()
+    {
+      ELLE_TRACE_SCOPE("%s: seal segment %s", this, this->_active);
+      auto& segment = this->_segments.at(this->_active);
+      auto trailer = elle::Buffer(
+        this->_pending_trailer.size() * sizeof(TrailerEntry));
+      auto entry = TrailerEntry{};
+      auto pos = trailer.mutable_contents();
+      for (auto const& r: this->_pending_trailer)
+      {
+        ::memcpy(entry.key, r.key.value(), sizeof entry.key);
+        entry.kind = static_cast<uint32_t>(r.kind);
+        entry.length = r.length;
+        entry.offset = r.offset;
+        ::memcpy(pos, &entry, sizeof entry);
+        pos += sizeof entry;
+      }
+      auto crc = boost::crc_32_type{};
+      crc.process_bytes(trailer.contents(), trailer.size());
+      auto const footer = Footer{
+        this->_pending_trailer.size(), segment.size,
+        footer_magic, crc.checksum()};
+      this->_output->write(
+        reinterpret_cast<char const*>(trailer.contents()), trailer.size());
+      this->_output->write(
+        reinterpret_cast<char const*>(&footer), sizeof footer);
+      this->_output->flush();
+      if (!this->_output->good())
+        elle::err("unable to seal segment %s", this->_active);
+      segment.sealed = true;
+      this->_open(this->_active + 1);
+    }
+
+    Packfile::Location
+    Packfile::_append(Kind kind, Key const& key, elle::ConstWeakBuffer value)
+    {
+      auto& segment = this->_segments.at(this->_active);
+      auto header = RecordHeader{};
+      header.magic = record_magic;
+      header.kind = static_cast<uint32_t>(kind);
+      ::memcpy(header.key, key.value(), sizeof header.key);
+      header.length = value.size();
+      header.checksum = checksum(header.key, value);
+      this->_output->write(
+        reinterpret_cast<char const*>(&header), sizeof header);
+      this->_output->write(
+        reinterpret_cast<char const*>(value.contents()), value.size());
+      this->_output->flush();
+      if (!this->_output->good())
+        elle::err("unable to append to segment %s", this->_active);
+      auto const res = Location{this->_active, segment.size, header.length};
+      this->_pending_trailer.push_back(
+        Record{key, kind, segment.size, header.length});
+      segment.size += sizeof header + value.size();
+      // Tombstones are never live: they only matter until the segments
+      // holding previous values are compacted.
+      if (kind == Kind::value)
+      {
+        segment.live += sizeof header + value.size();
+        segment.keys.insert(key);
+      }
+      else
+        segment.tombstones += 1;
+      if (int64_t(segment.size) >= this->_segment_size)
+        this->_seal();
+      return res;
+    }
+
+    void
+    Packfile::_sync(int first)
+    {
+      ELLE_DEBUG_SCOPE("%s: sync segments %s to %s",
+                       this, first, this->_active);
+      this->_output->flush();
+      if (!this->_output->good())
+        elle::err("unable to flush segment %s", this->_active);
+      for (auto id = first; id <= this->_active; ++id)
+        if (elle::contains(this->_segments, id))
+          sync_path(this->_segment_path(id), false);
+      sync_path(this->_root, true);
+    }
+
+    void
+    Packfile::_release(Location const& location)
+    {
+      this->_segments.at(location.segment).live -=
+        sizeof(RecordHeader) + location.length;
+    }
+
+    /*-----------.
+    | Compaction |
+    `-----------*/
+
+    int64_t
+    Packfile::compact()
+    {
+      ELLE_TRACE_SCOPE("%s: compact", this);
+      auto reclaimed = int64_t(0);
+      auto candidates = std::vector<int>{};
+      for (auto const& s: this->_segments)
+        if (s.first != this->_active && s.second.live * 2 < s.second.size)
+          candidates.push_back(s.first);
+      for (auto id: candidates)
+      {
+        ELLE_DEBUG_SCOPE("compact segment %s (%s live bytes out of %s)",
+                         id, this->_segments.at(id).live,
+                         this->_segments.at(id).size);
+        auto sealed = false;
+        auto const first = this->_active;
+        // Whether a segment older than this one holds a value for @a key.
+        auto const shadowed = [&] (Key const& key)
+          {
+            for (auto const& s: this->_segments)
+              if (s.first >= id)
+                return false;
+              else if (elle::contains(s.second.keys, key))
+                return true;
+            return false;
+          };
+        for (auto const& r: this->_records(id, sealed))
+        {
+          if (r.kind == Kind::tombstone)
+          {
+            // Only needed while an older segment still holds a value for
+            // this key, and the key was not inserted again since.
+            if (!elle::contains(this->_index, r.key) && shadowed(r.key))
+              this->_append(Kind::tombstone, r.key, {});
+            continue;
+          }
+          auto it = this->_index.find(r.key);
+          if (it == this->_index.end()
+              || it->second.segment != id
+              || it->second.offset != r.offset)
+            continue;
+          auto value = this->_get(r.key);
+          auto const loc = this->_append(Kind::value, r.key, value);
+          this->_release(it->second);
+          it->second = loc;
+          if (elle::reactor::Scheduler::scheduler())
+            elle::reactor::yield();
+        }
+        // The copies must be on disk before the originals go away.
+        this->_sync(first);
+        auto const size = this->_segments.at(id).size;
+        this->_segments.erase(id);
+        bfs::remove(this->_segment_path(id));
+        reclaimed += size;
+      }
+      if (reclaimed)
+        ELLE_TRACE("reclaimed %s bytes", reclaimed);
+      return reclaimed;
+    }
+
+    void
+    Packfile::_compaction()
+    {
+      while (true)
+      {
+        elle::reactor::sleep(1min);
+        try
+        {
+          this->compact();
+        }
+        catch (elle::Error const& e)
+        {
+          ELLE_WARN("%s: compaction failed: %s", this, e);
+        }
+      }
+    }
+
+    /*--------------.
+    | Silo Config.  |
+    `--------------*/
+
+    PackfileSiloConfig::PackfileSiloConfig(
+        std::string name,
+        std::string path,
+        boost::optional<int64_t> capacity,
+        boost::optional<std::string> description,
+        boost::optional<int64_t> segment_size)
+      : SiloConfig(
+          std::move(name), std::move(capacity), std::move(description))
+      , path(std::move(path))
+      , segment_size(std::move(segment_size))
+    {}
+
+    PackfileSiloConfig::PackfileSiloConfig(
+      elle::serialization::SerializerIn& s)
+      : SiloConfig(s)
+      , path(s.deserialize<std::string>("path"))
+      , segment_size(s.deserialize<boost::optional<int64_t>>("segment_size"))
+    {}
+
+    void
+    PackfileSiloConfig::serialize(elle::serialization::Serializer& s)
+    {
+      SiloConfig::serialize(s);
+      s.serialize("path", this->path);
+      s.serialize("segment_size", this->segment_size);
+    }
+
+    std::unique_ptr<memo::silo::Silo>
+    PackfileSiloConfig::make()
+    {
+      return std::make_unique<memo::silo::Packfile>(
+        this->path, this->capacity, this->segment_size);
+    }
+
+    static const elle::serialization::Hierarchy<SiloConfig>::
+    Register<PackfileSiloConfig>
+    _register_PackfileSiloConfig("packfile");
+  }
+}
+
+namespace
+{
+  std::unique_ptr<memo::silo::Silo>
+  make(std::vector<std::string> const& args)
+  {
+    return std::make_unique<memo::silo::Packfile>(args[0]);
+  }
+
+  FACTORY_REGISTER(memo::silo::Silo, "packfile", make);
+}
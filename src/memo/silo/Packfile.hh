@@ -0,0 +1,149 @@
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <elle/reactor/Thread.hh>
+
+#include <memo/silo/Key.hh>
+#include <memo/silo/Silo.hh>
+
+namespace memo
+{
+  namespace silo
+  {
+    /// Log-structured storage appending blocks to large segment files.
+    ///
+    /// Every set or erase appends a record to the active segment, which is
+    /// sealed with a trailer listing its records once it reaches
+    /// `segment_size`.  An in-memory index maps keys to their latest record,
+    /// it is rebuilt on startup from the trailers, or by scanning the records
+    /// of segments that were not sealed.  Segments whose live data dropped
+    /// below half their size are compacted in the background.
+    class Packfile
+      : public Silo
+    {
+    public:
+      Packfile(boost::filesystem::path root,
+               boost::optional<int64_t> capacity = {},
+               boost::optional<int64_t> segment_size = {});
+      ~Packfile() override;
+      std::string
+      type() const override { return "packfile"; }
+      /// Rewrite the live records of sparse segments and delete them.
+      ///
+      /// @return The number of bytes reclaimed.
+      int64_t
+      compact();
+
+    protected:
+      elle::Buffer
+      _get(Key k) const override;
+      int
+      _set(Key k, elle::Buffer const& value, bool insert, bool update) override;
+      int
+      _erase(Key k) override;
+      std::vector<Key>
+      _list() override;
+      BlockStatus
+      _status(Key k) override;
+      ELLE_ATTRIBUTE_R(boost::filesystem::path, root);
+      ELLE_ATTRIBUTE_R(int64_t, segment_size);
+
+    /*---------.
+    | Segments |
+    `---------*/
+    public:
+      enum class Kind: uint32_t
+      {
+        value = 1,
+        tombstone = 2,
+      };
+      /// Where the latest record of a key lives.
+      struct Location
+      {
+        int segment;
+        uint64_t offset;
+        uint32_t length;
+      };
+      /// An entry of a segment trailer.
+      struct Record
+      {
+        Key key;
+        Kind kind;
+        uint64_t offset;
+        uint32_t length;
+      };
+      struct Segment
+      {
+        /// Bytes written to the segment, trailer excluded.
+        uint64_t size;
+        /// Bytes of records still referenced by the index.
+        uint64_t live;
+        /// Tombstone records in the segment.
+        uint64_t tombstones;
+        bool sealed;
+        /// Keys with a value record in the segment, live or not.  A
+        /// tombstone is only kept while an older segment has its key.
+        std::unordered_set<Key> keys;
+      };
+      using Index = std::unordered_map<Key, Location>;
+      using Segments = std::map<int, Segment>;
+      ELLE_ATTRIBUTE_R(Index, index);
+      ELLE_ATTRIBUTE_R(Segments, segments);
+
+    private:
+      boost::filesystem::path
+      _segment_path(int id) const;
+      /// Rebuild the index from the segments on disk.
+      void
+      _recover();
+      /// Read the records of a segment, from its trailer if sealed.
+      std::vector<Record>
+      _records(int id, bool& sealed) const;
+      void
+      _open(int id);
+      /// Write the trailer of the active segment and open a new one.
+      void
+      _seal();
+      /// Append a record to the active segment.
+      Location
+      _append(Kind kind, Key const& key, elle::ConstWeakBuffer value);
+      /// Write segments @a first to the active one and the directory to
+      /// disk.
+      void
+      _sync(int first);
+      /// Account for the record at @a location not being live anymore.
+      void
+      _release(Location const& location);
+      void
+      _compaction();
+      ELLE_ATTRIBUTE(int, active);
+      ELLE_ATTRIBUTE(std::unique_ptr<boost::filesystem::ofstream>, output);
+      /// Records of the active segment, written as its trailer when sealed.
+      ELLE_ATTRIBUTE(std::vector<Record>, pending_trailer);
+      ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, compaction_thread);
+    };
+
+    struct PackfileSiloConfig
+      : public SiloConfig
+    {
+      PackfileSiloConfig(std::string name,
+                         std::string path,
+                         boost::optional<int64_t> capacity,
+                         boost::optional<std::string> description,
+                         boost::optional<int64_t> segment_size = {});
+      PackfileSiloConfig(elle::serialization::SerializerIn& input);
+      void
+      serialize(elle::serialization::Serializer& s) override;
+      std::unique_ptr<memo::silo::Silo>
+      make() override;
+      std::string path;
+      boost::optional<int64_t> segment_size;
+    };
+  }
+}
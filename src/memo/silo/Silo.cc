@@ -1,12 +1,19 @@
 #include <memo/silo/Silo.hh>
 
+#include <algorithm>
+#include <map>
+#include <typeindex>
+
 #include <boost/algorithm/string/case_conv.hpp>
 
 #include <elle/factory.hh>
+#include <elle/finally.hh>
 #include <elle/find.hh>
 #include <elle/log.hh>
 
+#include <memo/model/prometheus.hh>
 #include <memo/silo/Key.hh>
+#include <memo/silo/MissingKey.hh>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -16,6 +23,29 @@ ELLE_LOG_COMPONENT("memo.silo.Silo");
 namespace
 {
   int const step = 100 * 1024 * 1024; // 100 MiB
+
+  /// The latency histogram of @a operation for the type of @a silo.
+  memo::prometheus::HistogramPtr const&
+  latency(memo::silo::Silo const& silo, char const* operation)
+  {
+    static auto const family = memo::prometheus::make_histogram_family(
+      "memo_silo_latency_seconds",
+      "How long silo operations take");
+    static auto histograms = std::map<
+      std::pair<std::type_index, std::string>,
+      memo::prometheus::HistogramPtr>{};
+    auto const key = std::make_pair(std::type_index(typeid(silo)),
+                                    std::string(operation));
+    auto it = histograms.find(key);
+    if (it == histograms.end())
+      it = histograms.emplace(
+        key,
+        memo::prometheus::make(
+          family,
+          {{"silo", silo.type()}, {"operation", operation}},
+          memo::prometheus::latency_buckets())).first;
+    return it->second;
+  }
 }
 
 
@@ -29,6 +59,7 @@ namespace memo
       , _base_usage(0)
       , _step(this->capacity() ? (this->capacity().get() / 10) : step)
       , _block_count{0} // recovered in the child ctor.
+      , _hide_metadata(false)
     {
       // _size_cache too has to be recovered in the child ctor.
 
@@ -58,7 +89,12 @@ namespace memo
     Silo::get(Key key) const
     {
       ELLE_TRACE_SCOPE("%s: get %x", this, key);
-      // FIXME: use _size_cache to check block existance?
+      if (this->filtered_out(key))
+      {
+        ELLE_DEBUG("%s: filtered out %x", this, key);
+        throw MissingKey(key);
+      }
+      prometheus::Timer timer(latency(*this, "get"));
       return this->_get(key);
     }
 
@@ -68,7 +104,22 @@ namespace memo
       ELLE_ASSERT(insert || update);
       ELLE_TRACE_SCOPE("%s: %s at %x", this,
                        insert ? update ? "upsert" : "insert" : "update", key);
-      int delta = this->_set(key, value, insert, update);
+      int delta = [&]
+        {
+          prometheus::Timer timer(latency(*this, "set"));
+          return this->_set(key, value, insert, update);
+        }();
+      if (this->_filter_backlog)
+        this->_filter_backlog->emplace_back(key);
+      if (!this->_filters.empty())
+      {
+        if (this->_filters.back().full())
+        {
+          ELLE_DEBUG("%s: grow key filter", this);
+          this->_filters.emplace_back(2 * this->_filters.back().capacity());
+        }
+        this->_filters.back().add(key);
+      }
 
       this->_usage += delta;
       if (std::abs(this->_base_usage - this->_usage) >= this->_step)
@@ -92,7 +143,11 @@ namespace memo
     Silo::erase(Key key)
     {
       ELLE_TRACE_SCOPE("%s: erase %x", this, key);
-      int delta = this->_erase(key);
+      int delta = [&]
+        {
+          prometheus::Timer timer(latency(*this, "erase"));
+          return this->_erase(key);
+        }();
       ELLE_DEBUG("usage %s and delta %s", this->_usage, delta);
       this->_usage += delta;
       this->_size_cache.erase(key);
@@ -104,16 +159,63 @@ namespace memo
     Silo::list()
     {
       ELLE_TRACE_SCOPE("%s: list", this);
-      return this->_list();
+      auto res = this->_list();
+      if (!this->_hide_metadata)
+        return res;
+      // Metadata is only reached through the block it belongs to.
+      res.erase(
+        std::remove_if(
+          res.begin(), res.end(),
+          [] (Key const& k)
+          {
+            return k.value()[Key::flag_byte] ==
+              model::flags::block_metadata;
+          }),
+        res.end());
+      return res;
     }
 
     BlockStatus
     Silo::status(Key k)
     {
       ELLE_TRACE_SCOPE("%s: status %x", this, k);
+      if (this->filtered_out(k))
+        return BlockStatus::missing;
       return this->_status(k);
     }
 
+    void
+    Silo::enable_filter()
+    {
+      ELLE_TRACE_SCOPE("%s: build key filter", this);
+      // Listing may yield, keep track of keys written meanwhile.
+      this->_filter_backlog.emplace();
+      elle::SafeFinally reset([&] { this->_filter_backlog.reset(); });
+      auto const keys = this->_list();
+      auto const& backlog = *this->_filter_backlog;
+      // Leave room to grow before another filter must be appended.
+      auto filter = BloomFilter(
+        2 * std::max<std::size_t>({
+            keys.size() + backlog.size(),
+            std::size_t(std::max<int64_t>(this->_block_count, 0)),
+            1024}));
+      for (auto const& k: keys)
+        filter.add(k);
+      for (auto const& k: backlog)
+        filter.add(k);
+      this->_filters.clear();
+      this->_filters.emplace_back(std::move(filter));
+      ELLE_DEBUG("%s: filter %s keys", this, this->_filters.back().count());
+    }
+
+    bool
+    Silo::filtered_out(Key k) const
+    {
+      return !this->_filters.empty() &&
+        std::none_of(this->_filters.begin(), this->_filters.end(),
+                     [&] (BloomFilter const& f) { return f.contains(k); });
+    }
+
     BlockStatus
     Silo::_status(Key k)
     {
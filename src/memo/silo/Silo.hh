@@ -3,6 +3,7 @@
 #include <atomic>
 #include <cstdint>
 #include <iosfwd>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 #include <boost/signals2.hpp>
@@ -16,6 +17,7 @@
 #include <memo/model/Address.hh>
 #include <memo/model/prometheus.hh>
 #include <memo/serialization.hh>
+#include <memo/silo/BloomFilter.hh>
 #include <memo/silo/fwd.hh>
 
 namespace memo
@@ -69,6 +71,8 @@ namespace memo
 
       /// List of all keys in the storage.
       ///
+      /// Block metadata keys are left out if `hide_metadata`.
+      ///
       /// @return A list of all keys in the storage.
       std::vector<Key>
       list();
@@ -77,6 +81,17 @@ namespace memo
       status(Key k);
       void
       register_notifier(std::function<void ()> f);
+      /// Track stored keys in Bloom filters, answering lookups of absent
+      /// keys without reaching the storage.
+      ///
+      /// Lists the whole storage once, which may take a while: callers
+      /// should run it in a thread of its own.  All writes must go through
+      /// this silo afterwards.
+      void
+      enable_filter();
+      /// Whether @a k is known to be absent.
+      bool
+      filtered_out(Key k) const;
 
       /// The type of storage (e.g., "s3").
       virtual
@@ -121,6 +136,15 @@ namespace memo
       ELLE_ATTRIBUTE(boost::signals2::signal<void ()>, on_storage_size_change);
       /// Number of blocks.
       ELLE_ATTRIBUTE_R(std::atomic<int64_t>, block_count, protected);
+      /// Keys possibly stored, if enabled.  When the last filter is full,
+      /// a larger one is appended instead of listing the storage again.
+      ELLE_ATTRIBUTE_R(std::vector<BloomFilter>, filters);
+      /// Keys written while the filter is being built.
+      ELLE_ATTRIBUTE(boost::optional<std::vector<Key>>, filter_backlog);
+      /// Whether to leave block metadata keys out of listings.  Only set
+      /// when blocks addresses are flagged: before that, their flag byte
+      /// is random and may be that of metadata.
+      ELLE_ATTRIBUTE_RW(bool, hide_metadata);
     };
 
     std::unique_ptr<Silo>
@@ -1,10 +1,16 @@
+#include <elle/With.hh>
 #include <elle/filesystem/TemporaryDirectory.hh>
 #include <elle/log.hh>
 #include <elle/memory.hh>
+#include <elle/printf.hh>
 #include <elle/test.hh>
 
 #include <elle/cryptography/rsa/KeyPair.hh>
 
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <elle/reactor/Scope.hh>
 #include <elle/reactor/scheduler.hh>
 #include <elle/reactor/semaphore.hh>
 #include <elle/reactor/signal.hh>
@@ -12,10 +18,13 @@
 #include <memo/model/doughnut/Async.hh>
 #include <memo/model/doughnut/Consensus.hh>
 #include <memo/model/doughnut/Doughnut.hh>
+#include <memo/model/doughnut/Journal.hh>
 #include <memo/model/doughnut/Passport.hh>
 
 ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Async.test");
 
+using namespace std::literals;
+
 namespace dht = memo::model::doughnut;
 
 class SyncedConsensus
@@ -89,6 +98,34 @@ public:
   }
 };
 
+class SquashingResolver
+  : public memo::model::ConflictResolver
+{
+public:
+  std::unique_ptr<memo::model::blocks::Block>
+  operator () (memo::model::blocks::Block&,
+               memo::model::blocks::Block&) override
+  {
+    elle::unreachable();
+  }
+
+  memo::model::SquashOperation
+  squashable(SquashStack const&) override
+  {
+    return {memo::model::Squash::at_first_position_continue, {}};
+  }
+
+  void
+  serialize(elle::serialization::Serializer&, elle::Version const&) override
+  {}
+
+  std::string
+  description() const override
+  {
+    return "squashing";
+  }
+};
+
 class DummyDoughnut
   : public dht::Doughnut
 {
@@ -176,9 +213,126 @@ ELLE_TEST_SCHEDULED(fetch_disk_queued_multiple)
   }
 }
 
+// Updates trickling in while the first one is held back get squashed in it.
+ELLE_TEST_SCHEDULED(coalesce)
+{
+  DummyDoughnut dht;
+  auto const a = memo::model::Address::random(0); // FIXME
+  auto scu = std::make_unique<SyncedConsensus>(dht);
+  auto& sc = *scu;
+  auto&& async = dht::consensus::Async(std::move(scu), {}, 100);
+  for (int i = 0; i < 5; ++i)
+  {
+    async.store(std::make_unique<memo::model::blocks::Block>(
+                  a, elle::Buffer(elle::sprintf("a%s", i))),
+                memo::model::STORE_UPDATE,
+                std::make_unique<SquashingResolver>());
+    elle::reactor::sleep(5ms);
+  }
+  sc.sem.release();
+  sc.sem.release();
+  elle::reactor::wait(sc.stored());
+  elle::reactor::sleep(300ms);
+  BOOST_CHECK_EQUAL(sc.nstore, 1);
+  BOOST_CHECK_EQUAL(async.processed_op_count(), 1);
+}
+
+ELLE_TEST_SCHEDULED(journal)
+{
+  using Journal = dht::consensus::Journal;
+  auto const d = elle::filesystem::TemporaryDirectory{};
+  auto const payload = [] (int i)
+    {
+      return elle::Buffer(elle::sprintf("operation %s", i));
+    };
+  {
+    Journal journal(d.path(), 64, true);
+    for (int i = 1; i <= 10; ++i)
+      journal.put(i, payload(i));
+    journal.put(3, elle::Buffer("squashed"));
+    journal.commit();
+    BOOST_CHECK_EQUAL(journal.get(3), "squashed");
+    for (int i = 1; i <= 5; ++i)
+      journal.drop(i);
+    journal.commit();
+    BOOST_CHECK_EQUAL(journal.index().size(), 5);
+  }
+  ELLE_LOG("reopen")
+  {
+    Journal journal(d.path(), 64, true);
+    BOOST_CHECK_EQUAL(journal.index().size(), 5);
+    for (int i = 6; i <= 10; ++i)
+      BOOST_CHECK_EQUAL(journal.get(i), payload(i));
+    ELLE_LOG("truncate processed segments")
+    {
+      for (int i = 6; i <= 10; ++i)
+        journal.drop(i);
+      journal.commit();
+      auto segments = std::distance(
+        boost::filesystem::directory_iterator(d.path()),
+        boost::filesystem::directory_iterator());
+      BOOST_CHECK_EQUAL(segments, 1);
+    }
+    journal.put(11, payload(11));
+    journal.put(12, payload(12));
+    journal.commit();
+  }
+  ELLE_LOG("ignore torn tail")
+  {
+    auto const last = d.path() / elle::sprintf(
+      "segment-%s", Journal::scan(d.path()).at(12).segment);
+    boost::filesystem::resize_file(
+      last, boost::filesystem::file_size(last) - 1);
+    auto const index = Journal::scan(d.path());
+    BOOST_CHECK_EQUAL(index.size(), 1);
+    BOOST_CHECK_EQUAL(Journal::read(d.path(), 11, index.at(11)), payload(11));
+  }
+  ELLE_LOG("migrate legacy journal")
+  {
+    auto const legacy = elle::filesystem::TemporaryDirectory{};
+    for (int i = 1; i <= 3; ++i)
+    {
+      boost::filesystem::ofstream output(
+        legacy.path() / std::to_string(i), std::ios::binary);
+      output << payload(i).string();
+    }
+    BOOST_CHECK_EQUAL(Journal::scan(legacy.path()).size(), 3);
+    Journal journal(legacy.path());
+    BOOST_CHECK_EQUAL(journal.index().size(), 3);
+    BOOST_CHECK(!boost::filesystem::exists(legacy.path() / "1"));
+    for (int i = 1; i <= 3; ++i)
+      BOOST_CHECK_EQUAL(journal.get(i), payload(i));
+  }
+}
+
+// Concurrent commits share fsyncs.
+ELLE_TEST_SCHEDULED(journal_group_commit)
+{
+  auto const d = elle::filesystem::TemporaryDirectory{};
+  dht::consensus::Journal journal(d.path());
+  elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& s)
+  {
+    for (int i = 1; i <= 32; ++i)
+      s.run_background(
+        elle::sprintf("push %s", i),
+        [&, i]
+        {
+          journal.put(i, elle::Buffer(elle::sprintf("operation %s", i)));
+          journal.commit();
+        });
+    elle::reactor::wait(s);
+  };
+  BOOST_CHECK_EQUAL(journal.index().size(), 32);
+  BOOST_CHECK_GE(journal.syncs(), 1);
+  BOOST_CHECK_LT(journal.syncs(), 32);
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(fetch_disk_queued), 0, 10);
   suite.add(BOOST_TEST_CASE(fetch_disk_queued_multiple), 0, 10);
+  suite.add(BOOST_TEST_CASE(coalesce), 0, 10);
+  suite.add(BOOST_TEST_CASE(journal), 0, 10);
+  suite.add(BOOST_TEST_CASE(journal_group_commit), 0, 10);
 }
@@ -85,9 +85,48 @@ ELLE_TEST_SCHEDULED(disk)
   }
 }
 
+ELLE_TEST_SCHEDULED(scan_resistance)
+{
+  auto&& r = Recipe(boost::optional<int>(64 * 1024));
+  auto make = [&]
+    {
+      auto b = r.dht.make_block<memo::model::blocks::MutableBlock>(
+        elle::Buffer(std::string(1024, 'x')));
+      b->seal(1);
+      r.instrument.add(*b);
+      return b->address();
+    };
+  auto hot = std::vector<memo::model::Address>{};
+  ELLE_LOG("fetch hot blocks")
+  {
+    for (int i = 0; i < 8; ++i)
+    {
+      hot.emplace_back(make());
+      for (int j = 0; j < 4; ++j)
+        r.cache.fetch(hot.back());
+    }
+  }
+  ELLE_LOG("scan cold blocks")
+  {
+    for (int i = 0; i < 200; ++i)
+      r.cache.fetch(make());
+  }
+  r.instrument.fetched().connect(
+    [] (memo::model::Address const& addr)
+    {
+      BOOST_FAIL(elle::sprintf("block %f should have been cached", addr));
+    });
+  ELLE_LOG("fetch hot blocks again")
+  {
+    for (auto const& addr: hot)
+      BOOST_CHECK(r.cache.fetch(addr));
+  }
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(memory), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(disk), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(scan_resistance), 0, valgrind(1));
 }
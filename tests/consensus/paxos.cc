@@ -1,5 +1,18 @@
+#include <elle/With.hh>
+#include <elle/cast.hh>
+#include <elle/err.hh>
+#include <elle/finally.hh>
+#include <elle/make-vector.hh>
 #include <elle/test.hh>
 
+#include <elle/reactor/Scope.hh>
+
+#include <memo/environ.hh>
+#include <memo/model/Conflict.hh>
+#include <memo/model/MissingBlock.hh>
+#include <memo/model/doughnut/consensus/Rebalancer.hh>
+#include <memo/silo/Memory.hh>
+
 #include "../DHT.hh"
 
 ELLE_LOG_COMPONENT("memo.model.doughnut.consensus.Paxos.test");
@@ -62,9 +75,336 @@ ELLE_TEST_SCHEDULED(availability_3)
   }
 }
 
+ELLE_TEST_SCHEDULED(get_many)
+{
+  using memo::model::doughnut::consensus::Paxos;
+  auto a = std::make_unique<DHT>();
+  auto b = std::make_unique<DHT>();
+  a->overlay->connect(*b->overlay);
+  auto addresses = std::vector<memo::model::Address>{};
+  ELLE_LOG("store blocks")
+    for (int i = 0; i < 8; ++i)
+    {
+      auto block = a->dht->make_block<memo::model::blocks::MutableBlock>();
+      block->data(elle::Buffer(elle::sprintf("block %s", i)));
+      a->dht->seal_and_insert(*block);
+      addresses.emplace_back(block->address());
+    }
+  auto const missing =
+    memo::model::Address::random(memo::model::flags::mutable_block);
+  addresses.emplace_back(missing);
+  auto local = std::dynamic_pointer_cast<Paxos::LocalPeer>(b->dht->local());
+  BOOST_REQUIRE(local);
+  ELLE_LOG("get %s addresses at once", addresses.size())
+  {
+    auto const res = local->get_many(
+      Paxos::PaxosServer::Quorum{a->dht->id(), b->dht->id()},
+      addresses,
+      std::vector<boost::optional<int>>(addresses.size()));
+    BOOST_CHECK_EQUAL(res.size(), addresses.size());
+    for (auto const& addr: addresses)
+      if (addr == missing)
+        BOOST_CHECK(std::dynamic_pointer_cast<memo::model::MissingBlock>(
+                      res.at(addr).second));
+      else
+      {
+        BOOST_CHECK(!res.at(addr).second);
+        BOOST_CHECK(res.at(addr).first);
+      }
+  }
+  ELLE_LOG("multifetch %s addresses", addresses.size())
+  {
+    auto hits = 0;
+    b->dht->multifetch(
+      elle::make_vector(addresses,
+                        [] (auto const& addr)
+                        {
+                          return memo::model::Model::AddressVersion(
+                            addr, boost::none);
+                        }),
+      [&] (memo::model::Address addr,
+           std::unique_ptr<memo::model::blocks::Block> block,
+           std::exception_ptr e)
+      {
+        if (addr == missing)
+          BOOST_CHECK(e);
+        else if (block && !e)
+          ++hits;
+      });
+    BOOST_CHECK_EQUAL(hits, 8);
+  }
+}
+
+ELLE_TEST_SCHEDULED(acceptor_log)
+{
+  auto storage = memo::silo::Memory::Blocks{};
+  auto const id = memo::model::Address::random();
+  auto const payload = std::string(1024 * 1024, 'x');
+  auto address = memo::model::Address{};
+  auto const metadata = [&]
+    {
+      auto value = address.value();
+      return memo::model::Address(
+        value, memo::model::flags::block_metadata, true);
+    };
+  ELLE_LOG("update block")
+  {
+    auto dht = DHT(::id = id,
+                   ::storage = std::make_unique<memo::silo::Memory>(storage));
+    auto block = dht.dht->make_block<memo::model::blocks::MutableBlock>();
+    address = block->address();
+    block->data(elle::Buffer("foo"));
+    dht.dht->seal_and_insert(*block);
+    for (int i = 0; i < 3; ++i)
+    {
+      block->data(elle::Buffer(elle::sprintf("%s%s", payload, i)));
+      dht.dht->seal_and_update(*block);
+    }
+    // Proposals and confirmations are logged apart, the value is only
+    // written when accepted.
+    BOOST_TEST(storage.count(metadata()));
+    BOOST_TEST(storage.at(metadata()).size() < 4096u);
+  }
+  ELLE_LOG("reload block")
+  {
+    auto dht = DHT(::id = id,
+                   ::storage = std::make_unique<memo::silo::Memory>(storage));
+    BOOST_TEST(dht.dht->fetch(address)->data() ==
+               elle::sprintf("%s%s", payload, 2));
+    ELLE_LOG("remove block")
+      dht.dht->remove(address);
+    BOOST_TEST(!storage.count(address));
+    BOOST_TEST(!storage.count(metadata()));
+  }
+}
+
+ELLE_TEST_SCHEDULED(read_lease)
+{
+  auto const leased = [] (dht::Doughnut& dht)
+    {
+      return std::make_unique<dht::consensus::Paxos>(
+        dht::consensus::doughnut = dht,
+        dht::consensus::replication_factor = 3,
+        dht::consensus::read_lease = std::chrono::system_clock::duration(1s));
+    };
+  auto a = std::make_unique<DHT>(dht::consensus_builder = leased);
+  auto b = std::make_unique<DHT>(dht::consensus_builder = leased);
+  auto c = std::make_unique<DHT>(dht::consensus_builder = leased);
+  a->overlay->connect(*b->overlay);
+  a->overlay->connect(*c->overlay);
+  b->overlay->connect(*c->overlay);
+  auto block = a->dht->make_block<memo::model::blocks::MutableBlock>();
+  ELLE_LOG("store block")
+  {
+    block->data(elle::Buffer("foo"));
+    a->dht->seal_and_insert(*block);
+    block->data(elle::Buffer("foobar"));
+    a->dht->seal_and_update(*block);
+  }
+  ELLE_LOG("update block from another node")
+  {
+    auto other = b->dht->fetch(block->address());
+    BOOST_TEST(other->data() == "foobar");
+    dynamic_cast<memo::model::blocks::MutableBlock&>(*other).data(
+      elle::Buffer("foobarbaz"));
+    // The proposal waits for the lease of the first node to expire.
+    auto const start = std::chrono::steady_clock::now();
+    b->dht->seal_and_update(*other);
+    BOOST_TEST(std::chrono::steady_clock::now() - start >= 800ms);
+    BOOST_TEST(a->dht->fetch(block->address())->data() == "foobarbaz");
+  }
+  ELLE_LOG("read block under lease")
+  {
+    c.reset();
+    a.reset();
+    // A quorum is out of reach, yet the last writer holds a lease.
+    BOOST_TEST(b->dht->fetch(block->address())->data() == "foobarbaz");
+    elle::reactor::sleep(1s);
+    BOOST_CHECK_THROW(b->dht->fetch(block->address()),
+                      elle::athena::paxos::TooFewPeers);
+  }
+}
+
+/// Append a character to the current version.
+class AppendResolver
+  : public memo::model::ConflictResolver
+{
+public:
+  AppendResolver(char c)
+    : _c(c)
+  {}
+
+  std::unique_ptr<memo::model::blocks::Block>
+  operator () (memo::model::blocks::Block&,
+               memo::model::blocks::Block& current) override
+  {
+    auto res = elle::cast<memo::model::blocks::MutableBlock>::runtime(
+      current.clone());
+    res->data([this] (elle::Buffer& data) { data.append(&this->_c, 1); });
+    return std::move(res);
+  }
+
+  std::string
+  description() const override
+  {
+    return elle::sprintf("append %s", this->_c);
+  }
+
+  void
+  serialize(elle::serialization::Serializer&, elle::Version const&) override
+  {}
+
+private:
+  char _c;
+};
+
+ELLE_TEST_SCHEDULED(contention)
+{
+  auto a = std::make_unique<DHT>();
+  auto b = std::make_unique<DHT>();
+  auto c = std::make_unique<DHT>();
+  a->overlay->connect(*b->overlay);
+  a->overlay->connect(*c->overlay);
+  b->overlay->connect(*c->overlay);
+  auto block = a->dht->make_block<memo::model::blocks::MutableBlock>();
+  block->data(elle::Buffer(""));
+  a->dht->seal_and_insert(*block);
+  auto const writers = 32;
+  auto const update = [&] (char c)
+    {
+      auto mine = a->dht->fetch(block->address());
+      auto& mb = dynamic_cast<memo::model::blocks::MutableBlock&>(*mine);
+      mb.data([c] (elle::Buffer& data) { data.append(&c, 1); });
+      a->dht->seal_and_update(*mine, std::make_unique<AppendResolver>(c));
+    };
+  auto const run = [&] (std::string const& what, auto const& f)
+    {
+      auto const start = std::chrono::steady_clock::now();
+      f();
+      auto const elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+      ELLE_LOG("%s: %s updates in %ss, %s updates/s",
+               what, writers, elapsed, writers / elapsed);
+    };
+  run("sequential", [&]
+      {
+        for (int i = 0; i < writers; ++i)
+          update('a' + i % 26);
+      });
+  run("concurrent", [&]
+      {
+        elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& s)
+        {
+          for (int i = 0; i < writers; ++i)
+            s.run_background(elle::print("writer %s", i),
+                             [&, i] { update('A' + i % 26); });
+          elle::reactor::wait(s);
+        };
+      });
+  // Every update made it, whether merged or resolved.
+  auto const data = a->dht->fetch(block->address())->data().string();
+  BOOST_TEST(data.size() == 2u * writers);
+  for (int i = 0; i < writers; ++i)
+    BOOST_TEST(data.find('A' + i % 26) != std::string::npos);
+}
+
+ELLE_TEST_SCHEDULED(batch_leader_terminated)
+{
+  // Keep the leader waiting for joiners long enough to kill it.
+  memo::setenv("PAXOS_BATCH_WINDOW", 500);
+  elle::SafeFinally restore([] { memo::unsetenv("PAXOS_BATCH_WINDOW"); });
+  auto a = std::make_unique<DHT>();
+  auto b = std::make_unique<DHT>();
+  auto c = std::make_unique<DHT>();
+  a->overlay->connect(*b->overlay);
+  a->overlay->connect(*c->overlay);
+  b->overlay->connect(*c->overlay);
+  auto block = a->dht->make_block<memo::model::blocks::MutableBlock>();
+  block->data(elle::Buffer(""));
+  a->dht->seal_and_insert(*block);
+  auto const update = [&] (char c)
+    {
+      auto mine = a->dht->fetch(block->address());
+      auto& mb = dynamic_cast<memo::model::blocks::MutableBlock&>(*mine);
+      mb.data([c] (elle::Buffer& data) { data.append(&c, 1); });
+      a->dht->seal_and_update(*mine, std::make_unique<AppendResolver>(c));
+    };
+  elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& s)
+  {
+    auto& leader = s.run_background("leader", [&] { update('a'); });
+    elle::reactor::sleep(100ms);
+    s.run_background("joiner", [&] { update('b'); });
+    elle::reactor::sleep(100ms);
+    ELLE_LOG("terminate batch leader")
+      leader.terminate_now();
+    // The joiner is not told its update succeeded, it commits it itself.
+    elle::reactor::wait(s);
+  };
+  BOOST_TEST(a->dht->fetch(block->address())->data().string() == "b");
+}
+
+ELLE_TEST_SCHEDULED(rebalancer)
+{
+  using memo::model::doughnut::consensus::Rebalancer;
+  Rebalancer rebalancer("rebalancer", 1, 0, 0);
+  auto done = std::vector<int>{};
+  auto const address = memo::model::Address::random();
+  auto const job = [&] (int replicas)
+    {
+      return [&, replicas]
+        {
+          done.emplace_back(replicas);
+          return int64_t(1024);
+        };
+    };
+  // Least replicated blocks first, duplicates dropped.
+  rebalancer.schedule(memo::model::Address::random(),
+                      Rebalancer::Kind::rebalance, 2, job(2));
+  rebalancer.schedule(address, Rebalancer::Kind::evict, 1, job(1));
+  rebalancer.schedule(address, Rebalancer::Kind::evict, 1, job(1));
+  rebalancer.schedule(address, Rebalancer::Kind::extend, 3, job(3));
+  rebalancer.schedule(memo::model::Address::random(),
+                      Rebalancer::Kind::rebalance, 0, job(0));
+  BOOST_TEST(rebalancer.pending() == 4u);
+  while (rebalancer.pending())
+    elle::reactor::sleep(std::chrono::milliseconds(10));
+  BOOST_TEST(done == (std::vector<int>{0, 1, 2, 3}));
+  BOOST_TEST(rebalancer.done() == 4);
+  BOOST_TEST(rebalancer.failed() == 0);
+  BOOST_TEST(rebalancer.transferred() == 4 * 1024);
+  BOOST_TEST(rebalancer.eta() == std::chrono::seconds(0));
+  // Failures are counted and leave the worker running.
+  rebalancer.schedule(memo::model::Address::random(),
+                      Rebalancer::Kind::rebalance, 0,
+                      [] () -> int64_t { elle::err("boom"); });
+  rebalancer.schedule(memo::model::Address::random(),
+                      Rebalancer::Kind::rebalance, 1, job(1));
+  while (rebalancer.pending())
+    elle::reactor::sleep(std::chrono::milliseconds(10));
+  BOOST_TEST(rebalancer.done() == 6);
+  BOOST_TEST(rebalancer.failed() == 1);
+  BOOST_TEST(rebalancer.running() == 0);
+  // Evictions of distinct nodes from one quorum are all kept.
+  auto const lost_a = memo::model::Address::random();
+  auto const lost_b = memo::model::Address::random();
+  rebalancer.schedule(address, Rebalancer::Kind::evict, 1, job(1), lost_a);
+  rebalancer.schedule(address, Rebalancer::Kind::evict, 1, job(1), lost_b);
+  rebalancer.schedule(address, Rebalancer::Kind::evict, 1, job(1), lost_a);
+  BOOST_TEST(rebalancer.pending() == 2u);
+  while (rebalancer.pending())
+    elle::reactor::sleep(std::chrono::milliseconds(10));
+  BOOST_TEST(rebalancer.done() == 8);
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(availability_2), 0, 10);
   suite.add(BOOST_TEST_CASE(availability_3), 0, 10);
+  suite.add(BOOST_TEST_CASE(get_many), 0, 10);
+  suite.add(BOOST_TEST_CASE(acceptor_log), 0, 10);
+  suite.add(BOOST_TEST_CASE(read_lease), 0, 20);
+  suite.add(BOOST_TEST_CASE(contention), 0, 60);
+  suite.add(BOOST_TEST_CASE(batch_leader_terminated), 0, 20);
+  suite.add(BOOST_TEST_CASE(rebalancer), 0, 10);
 }
@@ -375,6 +375,109 @@ ELLE_TEST_SCHEDULED(missing_block, (bool, paxos))
                       MissingBlock);
 }
 
+ELLE_TEST_SCHEDULED(multifetch, (bool, paxos))
+{
+  using namespace memo::model;
+  DHTs dhts(paxos);
+  auto addresses = std::vector<Model::AddressVersion>{};
+  auto expected = std::unordered_map<Address, elle::Buffer>{};
+  ELLE_LOG("store blocks")
+    for (int i = 0; i < 64; ++i)
+    {
+      auto data = elle::Buffer(elle::sprintf("block %s", i));
+      auto block = dhts.dht_a->make_block<blocks::ImmutableBlock>(data);
+      addresses.emplace_back(block->address(), boost::none);
+      expected.emplace(block->address(), std::move(data));
+      dhts.dht_a->seal_and_insert(*block);
+    }
+  auto mblock = dhts.dht_a->make_block<blocks::MutableBlock>();
+  mblock->data(elle::Buffer("mutable"));
+  dhts.dht_a->seal_and_insert(*mblock);
+  addresses.emplace_back(mblock->address(), mblock->version());
+  auto const missing = Address::random(flags::immutable_block);
+  addresses.emplace_back(missing, boost::none);
+  auto hits = 0;
+  auto up_to_date = false;
+  auto missed = false;
+  ELLE_LOG("fetch %s blocks", addresses.size())
+    dhts.dht_b->multifetch(
+      addresses,
+      [&] (Address addr,
+           std::unique_ptr<blocks::Block> b,
+           std::exception_ptr ex)
+      {
+        if (addr == missing)
+        {
+          BOOST_CHECK_THROW(std::rethrow_exception(ex), MissingBlock);
+          missed = true;
+        }
+        else if (addr == mblock->address())
+        {
+          BOOST_CHECK(!ex);
+          BOOST_CHECK(!b);
+          up_to_date = true;
+        }
+        else
+        {
+          BOOST_CHECK(!ex);
+          BOOST_REQUIRE(b);
+          BOOST_CHECK_EQUAL(b->data(), expected.at(addr));
+          ++hits;
+        }
+      });
+  BOOST_CHECK_EQUAL(hits, 64);
+  BOOST_CHECK(up_to_date);
+  BOOST_CHECK(missed);
+}
+
+ELLE_TEST_SCHEDULED(fetch_serialized, (bool, paxos))
+{
+  // Networks from 0.10.0 on fetch stored bytes from peers that store blocks
+  // as is, older ones and Paxos peers fetch decoded blocks.
+  for (auto version: {boost::optional<elle::Version>(),
+                      boost::optional<elle::Version>(elle::Version(0, 9, 0))})
+  {
+    ELLE_LOG("network version %s", version);
+    DHTs dhts(paxos,
+              version_a = version, version_b = version, version_c = version);
+    auto iblock =
+      dhts.dht_a->make_block<blocks::ImmutableBlock>(elle::Buffer("chb"));
+    auto mblock = dhts.dht_a->make_block<blocks::MutableBlock>();
+    mblock->data(elle::Buffer("okb"));
+    ELLE_LOG("store blocks")
+    {
+      dhts.dht_a->seal_and_insert(*iblock);
+      dhts.dht_a->seal_and_insert(*mblock);
+    }
+    ELLE_LOG("fetch blocks")
+    {
+      BOOST_CHECK_EQUAL(dhts.dht_b->fetch(iblock->address())->data(), "chb");
+      BOOST_CHECK_EQUAL(dhts.dht_b->fetch(mblock->address())->data(), "okb");
+    }
+    ELLE_LOG("fetch up to date block")
+      BOOST_CHECK(!dhts.dht_b->fetch(mblock->address(), mblock->version()));
+  }
+}
+
+ELLE_TEST_SCHEDULED(negative_cache, (bool, paxos))
+{
+  DHTs dhts(paxos);
+  auto block = dhts.dht_a->make_block<blocks::MutableBlock>();
+  block->data(elle::Buffer("negative_cache"));
+  ELLE_LOG("fetch block before it exists")
+  {
+    BOOST_CHECK_THROW(dhts.dht_a->fetch(block->address()),
+                      memo::model::MissingBlock);
+    BOOST_CHECK_THROW(dhts.dht_a->fetch(block->address()),
+                      memo::model::MissingBlock);
+  }
+  ELLE_LOG("insert block")
+    dhts.dht_a->seal_and_insert(*block);
+  ELLE_LOG("fetch block")
+    BOOST_CHECK_EQUAL(dhts.dht_a->fetch(block->address())->data(),
+                      block->data());
+}
+
 ELLE_TEST_SCHEDULED(async, (bool, paxos))
 {
   DHTs dhts(paxos);
@@ -472,6 +575,86 @@ ELLE_TEST_SCHEDULED(ACB, (bool, paxos))
   }
 }
 
+ELLE_TEST_SCHEDULED(ACB_secret_cache, (bool, paxos))
+{
+  DHTs dhts(paxos);
+  auto block = dhts.dht_a->make_block<blocks::ACLBlock>();
+  block->data(elle::Buffer("\\_o<"));
+  block->set_permissions(dht::User(dhts.keys_b->K(), ""), true, false);
+  dhts.dht_a->seal_and_insert(*block);
+  auto& cache = dhts.dht_b->secret_cache();
+  ELLE_LOG("other: fetch ACB twice")
+    for (int i = 0; i < 2; ++i)
+      BOOST_CHECK_EQUAL(dhts.dht_b->fetch(block->address())->data(), "\\_o<");
+  BOOST_CHECK_EQUAL(cache.secret_misses(), 1);
+  BOOST_CHECK_EQUAL(cache.secret_hits(), 1);
+  ELLE_LOG("owner: update ACB")
+  {
+    block->data(elle::Buffer(":-)"));
+    dhts.dht_a->seal_and_update(*block);
+  }
+  ELLE_LOG("other: fetch updated ACB")
+    BOOST_CHECK_EQUAL(dhts.dht_b->fetch(block->address())->data(), ":-)");
+  ELLE_LOG("owner: revoke ACB read permissions")
+  {
+    block->set_permissions(dht::User(dhts.keys_b->K(), ""), false, false);
+    dhts.dht_a->seal_and_update(*block);
+  }
+  ELLE_LOG("other: fetch revoked ACB")
+    BOOST_CHECK_THROW(dhts.dht_b->fetch(block->address())->data(),
+                      elle::Error);
+}
+
+ELLE_TEST_SCHEDULED(signature_cache, (bool, paxos))
+{
+  DHTs dhts(paxos);
+  auto block = dhts.dht_a->make_block<blocks::MutableBlock>();
+  block->data(elle::Buffer("\\_o<"));
+  dhts.dht_a->seal_and_insert(*block);
+  auto& cache = dhts.dht_b->signature_cache();
+  ELLE_LOG("other: fetch OKB twice")
+    for (int i = 0; i < 2; ++i)
+      BOOST_CHECK_EQUAL(dhts.dht_b->fetch(block->address())->data(), "\\_o<");
+  BOOST_CHECK_GE(cache.hits(), 1);
+  ELLE_LOG("check forged signatures are not accepted")
+  {
+    auto const& keys = *dhts.keys_a;
+    auto const data = elle::Buffer("data");
+    auto const signature = keys.k().sign(data);
+    BOOST_CHECK(cache.verify(keys.K(), signature, data));
+    BOOST_CHECK(cache.verify(keys.K(), signature, data));
+    BOOST_CHECK(!cache.verify(keys.K(), signature, elle::Buffer("other")));
+    BOOST_CHECK(!cache.verify(dhts.keys_b->K(), signature, data));
+  }
+}
+
+ELLE_TEST_SCHEDULED(ACB_batch, (bool, paxos))
+{
+  DHTs dhts(paxos);
+  auto acbs = std::vector<std::unique_ptr<blocks::ACLBlock>>{};
+  auto batch = std::vector<blocks::Block*>{};
+  for (int i = 0; i < 8; ++i)
+  {
+    acbs.emplace_back(dhts.dht_a->make_block<blocks::ACLBlock>());
+    acbs.back()->data(elle::Buffer(elle::sprintf("block %s", i)));
+    acbs.back()->set_permissions(dht::User(dhts.keys_b->K(), ""), true, false);
+    batch.emplace_back(acbs.back().get());
+  }
+  ELLE_LOG("owner: store ACBs")
+    dhts.dht_a->seal_and_insert(batch);
+  ELLE_LOG("owner: update ACBs")
+  {
+    for (int i = 0; i < signed(acbs.size()); ++i)
+      acbs[i]->data(elle::Buffer(elle::sprintf("block %s!", i)));
+    dhts.dht_a->seal_and_update(batch);
+  }
+  ELLE_LOG("other: fetch ACBs")
+    for (int i = 0; i < signed(acbs.size()); ++i)
+      BOOST_CHECK_EQUAL(
+        dhts.dht_b->fetch(acbs[i]->address())->data().string(),
+        elle::sprintf("block %s!", i));
+}
+
 ELLE_TEST_SCHEDULED(NB, (bool, paxos))
 {
   DHTs dhts(paxos);
@@ -2372,8 +2555,14 @@ ELLE_TEST_SUITE()
   TEST(CHB);
   TEST(OKB);
   TEST(missing_block);
+  TEST(multifetch);
+  TEST(fetch_serialized);
+  TEST(negative_cache);
   TEST(async);
   TEST(ACB);
+  TEST(ACB_secret_cache);
+  TEST(signature_cache);
+  TEST(ACB_batch);
   TEST(NB);
   TEST(UB);
   TEST(conflict);
@@ -2,6 +2,7 @@
 #include <boost/algorithm/cxx11/none_of.hpp>
 #include <boost/range/algorithm/count_if.hpp>
 #include <boost/range/algorithm/find_if.hpp>
+#include <boost/range/size.hpp>
 
 #include <elle/test.hh>
 
@@ -1922,6 +1923,166 @@ ELLE_TEST_SCHEDULED(not_storing, (TestConfiguration, config))
   }
 }
 
+ELLE_TEST_SCHEDULED(address_book)
+{
+  auto book = kouncil::AddressBook();
+  auto const a = Address::random();
+  auto const b = Address::random();
+  auto blocks = std::vector<Address>{};
+  for (int i = 0; i < 1000; ++i)
+    blocks.emplace_back(Address::random());
+  // One by one, through the recent run.
+  for (auto const& block: blocks)
+    BOOST_TEST(book.insert(a, block));
+  BOOST_TEST(!book.insert(a, blocks[0]));
+  // In bulk, half of them known already.
+  auto more = std::vector<Address>{};
+  for (int i = 0; i < 1000; ++i)
+    more.emplace_back(Address::random());
+  auto bulk = std::vector<Address>(blocks.begin(), blocks.begin() + 500);
+  bulk.insert(bulk.end(), more.begin(), more.end());
+  BOOST_TEST(book.insert(b, bulk) == 1500);
+  BOOST_TEST(book.insert(b, bulk) == 0);
+  BOOST_TEST(book.size() == 2500u);
+  BOOST_TEST(book.block_count() == 2000u);
+  BOOST_TEST(book.node_count() == 2u);
+  BOOST_TEST(book.contains(a, blocks[0]));
+  BOOST_TEST(book.contains(b, blocks[0]));
+  BOOST_TEST(!book.contains(a, more[0]));
+  BOOST_TEST(book.nodes(blocks[0]).size() == 2u);
+  BOOST_TEST(book.nodes(blocks[999]) == std::vector<Address>{a});
+  BOOST_TEST(book.blocks(a).size() == 1000u);
+  // Removal, down to tombstones and back.
+  BOOST_TEST(book.erase(a, blocks[999]));
+  BOOST_TEST(!book.erase(a, blocks[999]));
+  BOOST_TEST(book.nodes(blocks[999]).empty());
+  BOOST_TEST(book.block_count() == 1999u);
+  BOOST_TEST(book.insert(b, blocks[999]));
+  BOOST_TEST(book.nodes(blocks[999]) == std::vector<Address>{b});
+  // Eviction of a whole node.
+  BOOST_TEST(book.erase(b) == 1501);
+  BOOST_TEST(book.erase(b) == 0);
+  BOOST_TEST(book.size() == 999u);
+  BOOST_TEST(book.block_count() == 999u);
+  BOOST_TEST(book.node_count() == 1u);
+  BOOST_TEST(book.nodes(more[0]).empty());
+  BOOST_TEST(book.nodes(blocks[0]) == std::vector<Address>{a});
+  auto count = 0;
+  book.each([&] (Address const&, int holders)
+            {
+              BOOST_TEST(holders == 1);
+              ++count;
+            });
+  BOOST_TEST(count == 999);
+  BOOST_TEST(book.memory() > 999u * sizeof(Address));
+  // Unreachable nodes are kept, but not counted.
+  BOOST_TEST(book.insert(b, blocks[0]));
+  book.available(b, false);
+  BOOST_TEST(book.nodes(blocks[0]) == std::vector<Address>{a});
+  book.available(b, true);
+  BOOST_TEST(book.nodes(blocks[0]).size() == 2u);
+}
+
+ELLE_TEST_SCHEDULED(address_book_reconcile)
+{
+  auto const node = Address::random();
+  auto blocks = std::vector<Address>{};
+  for (int i = 0; i < 10000; ++i)
+    blocks.emplace_back(Address::random());
+  auto reference = kouncil::AddressBook();
+  auto stale = kouncil::AddressBook();
+  reference.insert(node, blocks);
+  stale.insert(node, blocks);
+  BOOST_TEST(reference.digest(node, "") == stale.digest(node, ""));
+  for (int i = 0; i < 10; ++i)
+  {
+    reference.erase(node, blocks[i]);
+    reference.insert(node, Address::random());
+  }
+  BOOST_TEST(reference.digest(node, "") != stale.digest(node, ""));
+  // Split differing ranges down to a few blocks, and only fetch those.
+  auto probe = std::vector<std::string>{""};
+  auto fetched = 0u;
+  while (!probe.empty())
+  {
+    auto next = std::vector<std::string>{};
+    for (auto const& range: probe)
+    {
+      auto const expected = reference.digests(node, range);
+      auto const actual = stale.digests(node, range);
+      BOOST_TEST(expected.size() == 16u);
+      for (auto d = 0u; d < expected.size(); ++d)
+        if (expected[d] != actual[d])
+        {
+          auto const sub = range + kouncil::AddressBook::digits[d];
+          BOOST_TEST(kouncil::AddressBook::valid(sub));
+          if (expected[d].count > 16)
+            next.emplace_back(sub);
+          else
+          {
+            auto const update = reference.blocks(node, sub);
+            fetched += update.size();
+            stale.assign(node, sub, update);
+          }
+        }
+    }
+    probe = std::move(next);
+  }
+  BOOST_TEST(reference.digest(node, "") == stale.digest(node, ""));
+  BOOST_TEST(stale.size() == 10000u);
+  BOOST_TEST(fetched < 1000u);
+  auto expected = reference.blocks(node);
+  auto actual = stale.blocks(node);
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  BOOST_TEST(expected == actual);
+  BOOST_TEST(!kouncil::AddressBook::valid("0g"));
+}
+
+ELLE_TEST_SCHEDULED(file_table)
+{
+  auto const self = Address::random();
+  auto const other = Address::random();
+  auto files = kelips::Files(self, 2);
+  auto const start = elle::Time{} + std::chrono::hours(1);
+  auto blocks = std::vector<Address>{};
+  for (int i = 0; i < 4; ++i)
+    blocks.emplace_back(Address::random());
+  for (auto const& block: blocks)
+    BOOST_TEST(files.insert(kelips::File{block, self, start, {}, 0}).second);
+  BOOST_TEST(!files.insert(kelips::File{blocks[0], self, start, {}, 0}).second);
+  BOOST_TEST(files.insert(kelips::File{blocks[0], other, start, {}, 0}).second);
+  BOOST_TEST(files.size() == 5u);
+  BOOST_TEST(boost::size(files.equal_range(blocks[0])) == 2);
+  // New entries graduate once gossiped about often enough.
+  for (auto f: files.fresh(10))
+    files.gossiped(*f, start);
+  BOOST_TEST(files.fresh(10).size() == 5u);
+  auto const mine = files.find(blocks[1], self);
+  BOOST_TEST(mine);
+  files.gossiped(*mine, start + std::chrono::seconds(1));
+  BOOST_TEST(files.fresh(10).size() == 4u);
+  BOOST_TEST(files.fresh(10)[0]->gossip_count == 1);
+  // Stale entries are our own not gossiped about for a while.
+  auto const stale = files.stale(start + std::chrono::seconds(1), 10);
+  BOOST_TEST(stale.size() == 3u);
+  BOOST_TEST(boost::algorithm::none_of_equal(stale, mine));
+  // The least recently gossiped about entries come first.
+  auto const rotation = files.rotation(10);
+  BOOST_TEST(rotation.size() == 5u);
+  BOOST_TEST(rotation.back() == mine);
+  // Only entries of other nodes expire.
+  auto const theirs = files.find(blocks[0], other);
+  BOOST_TEST(theirs);
+  files.seen(*theirs, start + std::chrono::seconds(10));
+  BOOST_TEST(files.expire(start + std::chrono::seconds(5)) == 0);
+  BOOST_TEST(files.expire(start + std::chrono::hours(1)) == 1);
+  BOOST_TEST(!files.find(blocks[0], other));
+  BOOST_TEST(files.erase(blocks[0], self));
+  BOOST_TEST(!files.erase(blocks[0], self));
+  BOOST_TEST(files.size() == 3u);
+}
+
 ELLE_TEST_SUITE()
 {
   static auto const factor =
@@ -2020,4 +2181,7 @@ ELLE_TEST_SUITE()
   TEST(kouncil, kouncil, "remove", 5, remove, false);
   TEST(kouncil, kouncil, "remove_disconnected", 5, remove_disconnected, false);
   TEST(kouncil, kouncil, "not_storing", 5, not_storing);
+  kouncil->add(BOOST_TEST_CASE(address_book), 0, valgrind(5));
+  kouncil->add(BOOST_TEST_CASE(address_book_reconcile), 0, valgrind(5));
+  kelips->add(BOOST_TEST_CASE(file_table), 0, valgrind(5));
 }
@@ -1,5 +1,6 @@
 #include <elle/test.hh>
 
+#include <elle/reactor/Barrier.hh>
 #include <elle/reactor/scheduler.hh>
 #include <elle/reactor/Scope.hh>
 #include <elle/reactor/network/tcp-server.hh>
@@ -8,6 +9,7 @@
 #include <elle/protocol/Serializer.hh>
 #include <elle/protocol/ChanneledStream.hh>
 
+#include <memo/CryptoPool.hh>
 #include <memo/RPC.hh>
 #include <memo/utility.hh>
 
@@ -90,6 +92,69 @@ ELLE_TEST_SCHEDULED(unknown)
   BOOST_CHECK_EQUAL(succ(0), 1);
 }
 
+ELLE_TEST_SCHEDULED(procedure_id)
+{
+  Server s;
+  auto stream = s.connect();
+  elle::protocol::Serializer serializer(stream, memo::version(), false);
+  auto&& channels = elle::protocol::ChanneledStream{serializer};
+  auto const v10 = elle::Version(0, 10, 0);
+  memo::RPC<int (int)> succ("succ", channels, v10);
+  BOOST_TEST(succ.compact());
+  BOOST_TEST(succ(0) == 1);
+  try
+  {
+    memo::RPC<int (int)> unknown("unknown", channels, v10);
+    unknown(0);
+    BOOST_FAIL("unknown RPC succeeded");
+  }
+  catch (memo::UnknownRPC const& e)
+  {
+    BOOST_TEST(e.name() == elle::sprintf("#%x", memo::rpc_id("unknown")));
+  }
+  // Older networks still call by name.
+  memo::RPC<int (int)> legacy("succ", channels, elle::Version(0, 9, 0));
+  BOOST_TEST(!legacy.compact());
+  BOOST_TEST(legacy(1) == 2);
+}
+
+ELLE_TEST_SCHEDULED(batch)
+{
+  auto served = 0;
+  Server s(
+    [&] (memo::RPCServer& s)
+    {
+      s.add("double", [&] (int x) { ++served; return x * 2; });
+    });
+  auto stream = s.connect();
+  elle::protocol::Serializer serializer(stream, memo::version(), false);
+  auto&& channels = elle::protocol::ChanneledStream{serializer};
+  // Older networks get the calls one after the other.
+  for (auto version: {elle::Version(0, 10, 0), elle::Version(0, 9, 0)})
+  {
+    ELLE_LOG("version %s", version);
+    served = 0;
+    memo::RPC<int (int)> succ("succ", channels, version);
+    memo::RPC<int (int)> twice("double", channels, version);
+    memo::RPC<int (int)> unknown("unknown", channels, version);
+    memo::RPCBatch batch(channels, version);
+    auto results = std::vector<memo::RPCBatch::Result<int>>{};
+    for (int i = 0; i < 10; ++i)
+      results.emplace_back(batch.call(i % 2 ? succ : twice, i));
+    auto failed = batch.call(unknown, 0);
+    BOOST_TEST(batch.size() == 11u);
+    BOOST_CHECK_THROW(results[0].get(), elle::Error);
+    batch.send();
+    BOOST_TEST(batch.size() == 0u);
+    BOOST_TEST(served == 5);
+    for (int i = 0; i < 10; ++i)
+      BOOST_TEST(results[i].get() == (i % 2 ? i + 1 : i * 2));
+    BOOST_CHECK_THROW(failed.get(), memo::UnknownRPC);
+    // The RPCs and the channel are still usable.
+    BOOST_TEST(succ(41) == 42);
+  }
+}
+
 ELLE_TEST_SCHEDULED(simultaneous)
 {
   Server s(
@@ -221,12 +286,136 @@ ELLE_TEST_SCHEDULED(parallel)
   }
 }
 
+// Waiting requests are admitted by priority, and procedures are bounded.
+ELLE_TEST_SCHEDULED(admission)
+{
+  auto const delay = valgrind(120ms, 4);
+  memo::setenv("RPC_SERVE_THREADS", 2);
+  memo::setenv("RPC_SERVE_PROCEDURE_THREADS", 1);
+  auto served = std::vector<std::string>{};
+  elle::reactor::Barrier release_a;
+  elle::reactor::Barrier release_b;
+  Server s(
+    [&] (memo::RPCServer& s)
+    {
+      s.add("hold_a", [&] (int a) {
+          elle::reactor::wait(release_a);
+          return a;
+      });
+      s.add("hold_b", [&] (int a) {
+          elle::reactor::wait(release_b);
+          return a;
+      });
+      s.add("sleep", [&] (int a) {
+          elle::reactor::sleep(delay);
+          return a;
+      });
+      s.add("bulk", [&] (int a) {
+          served.emplace_back("bulk");
+          return a;
+      });
+      s.add("consensus", [&] (int a) {
+          served.emplace_back("consensus");
+          return a;
+      });
+      s.add("suspend", [&] (int a) {
+          memo::RPCAdmission::suspend([&] { elle::reactor::wait(release_a); });
+          return a;
+      });
+      s.priority("bulk", memo::RPCPriority::bulk);
+      s.priority("consensus", memo::RPCPriority::consensus);
+    });
+  auto stream = s.connect();
+  elle::protocol::Serializer serializer(stream, memo::version(), false);
+  auto&& channels = elle::protocol::ChanneledStream{serializer};
+  auto call = [&] (std::string const& name)
+    {
+      memo::RPC<int (int)> rpc(name, channels, memo::version());
+      BOOST_TEST(rpc(42) == 42);
+    };
+  elle::With<elle::reactor::Scope>() << [&](elle::reactor::Scope& scope)
+  {
+    scope.run_background("hold a", [&] { call("hold_a"); });
+    scope.run_background("hold b", [&] { call("hold_b"); });
+    elle::reactor::sleep(delay);
+    scope.run_background("bulk", [&] { call("bulk"); });
+    elle::reactor::sleep(delay);
+    scope.run_background("consensus", [&] { call("consensus"); });
+    elle::reactor::sleep(delay);
+    BOOST_TEST(served.empty());
+    release_a.open();
+    elle::reactor::sleep(delay);
+    BOOST_TEST((served == std::vector<std::string>{"consensus"}));
+    release_b.open();
+    elle::reactor::wait(scope);
+  };
+  BOOST_TEST((served == std::vector<std::string>{"consensus", "bulk"}));
+  ELLE_LOG("bound procedures")
+  {
+    auto start = Clock::now();
+    elle::With<elle::reactor::Scope>() << [&](elle::reactor::Scope& scope)
+    {
+      for (int i = 0; i < 2; ++i)
+        scope.run_background("sleep", [&] { call("sleep"); });
+      elle::reactor::wait(scope);
+    };
+    BOOST_TEST(delay * 2 <= Clock::now() - start);
+  }
+  ELLE_LOG("suspended requests free their slot")
+  {
+    release_a.close();
+    elle::With<elle::reactor::Scope>() << [&](elle::reactor::Scope& scope)
+    {
+      scope.run_background("suspend a", [&] { call("suspend"); });
+      scope.run_background("suspend b", [&] { call("suspend"); });
+      elle::reactor::sleep(delay);
+      served.clear();
+      call("bulk");
+      BOOST_TEST((served == std::vector<std::string>{"bulk"}));
+      release_a.open();
+      elle::reactor::wait(scope);
+    };
+  }
+  memo::unsetenv("RPC_SERVE_PROCEDURE_THREADS");
+  memo::unsetenv("RPC_SERVE_THREADS");
+}
+
+ELLE_TEST_SCHEDULED(crypto_pool)
+{
+  memo::CryptoPool pool(4);
+  auto const key = elle::cryptography::SecretKey{"secret"};
+  // Payloads on both sides of the offloading threshold, ciphered
+  // concurrently, come back in one piece to their own caller.
+  elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& scope)
+  {
+    for (auto size: {16, 4096, 65536, 1048576, 4194304})
+      for (int i = 0; i < 4; ++i)
+        scope.run_background(
+          elle::sprintf("cipher %s", size),
+          [&, size, i]
+          {
+            auto plain = elle::Buffer(size);
+            std::fill(plain.mutable_contents(),
+                      plain.mutable_contents() + size, i);
+            auto const cipher = pool.encipher(key, plain);
+            BOOST_TEST(pool.decipher(key, cipher) == plain);
+          });
+    elle::reactor::wait(scope);
+  };
+  BOOST_TEST(pool.active() >= 1);
+  BOOST_TEST(pool.active() <= 4);
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
   suite.add(BOOST_TEST_CASE(move));
   suite.add(BOOST_TEST_CASE(unknown));
+  suite.add(BOOST_TEST_CASE(procedure_id));
+  suite.add(BOOST_TEST_CASE(batch));
   suite.add(BOOST_TEST_CASE(bidirectional));
   suite.add(BOOST_TEST_CASE(simultaneous));
   suite.add(BOOST_TEST_CASE(parallel));
+  suite.add(BOOST_TEST_CASE(admission));
+  suite.add(BOOST_TEST_CASE(crypto_pool));
 }
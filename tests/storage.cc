@@ -1,3 +1,5 @@
+#include <boost/filesystem/fstream.hpp>
+
 #include <elle/filesystem/TemporaryDirectory.hh>
 #include <elle/serialization/json.hh>
 #include <elle/test.hh>
@@ -6,6 +8,7 @@
 #include <memo/silo/Filesystem.hh>
 #include <memo/silo/Memory.hh>
 #include <memo/silo/MissingKey.hh>
+#include <memo/silo/Packfile.hh>
 #include <memo/silo/S3.hh>
 #include <memo/silo/Silo.hh>
 
@@ -118,6 +121,223 @@ filesystem_large_capacity()
   tests_capacity(storage, size);
 }
 
+static
+void
+filesystem_index()
+{
+  elle::filesystem::TemporaryDirectory d;
+  auto const k1 = memo::silo::Key::random();
+  auto const k2 = memo::silo::Key::random();
+  {
+    memo::silo::Filesystem storage(d.path());
+    storage.set(k1, elle::Buffer(std::string("the grey")));
+    storage.set(k2, elle::Buffer(std::string("the white")));
+  }
+  BOOST_CHECK(boost::filesystem::exists(d.path() / "index"));
+  {
+    memo::silo::Filesystem storage(d.path());
+    // The index is consumed on load so a crash forces a rescan.
+    BOOST_CHECK(!boost::filesystem::exists(d.path() / "index"));
+    BOOST_CHECK_EQUAL(storage.block_count(), 2);
+    BOOST_CHECK_EQUAL(storage.usage(), 17);
+    BOOST_CHECK_EQUAL(storage.get(k2), "the white");
+    storage.erase(k1);
+  }
+  // Without a scheduler, the loaded index is never checked: it is not
+  // saved again.
+  BOOST_CHECK(!boost::filesystem::exists(d.path() / "index"));
+  {
+    memo::silo::Filesystem storage(d.path());
+    BOOST_CHECK_EQUAL(storage.block_count(), 1);
+    BOOST_CHECK_EQUAL(storage.usage(), 9);
+    BOOST_CHECK_EQUAL(storage.list().size(), 1);
+  }
+  // Without an index, blocks are recovered by scanning.
+  boost::filesystem::remove(d.path() / "index");
+  {
+    memo::silo::Filesystem storage(d.path());
+    BOOST_CHECK_EQUAL(storage.block_count(), 1);
+    BOOST_CHECK_EQUAL(storage.usage(), 9);
+  }
+  // A damaged index is detected and rebuilt by scanning.
+  {
+    boost::filesystem::fstream index(
+      d.path() / "index", std::ios::in | std::ios::out | std::ios::binary);
+    // Corrupt the size of the first entry, after the header and its key.
+    index.seekp(16 + 32);
+    index.put(42);
+  }
+  {
+    memo::silo::Filesystem storage(d.path());
+    BOOST_CHECK_EQUAL(storage.block_count(), 1);
+    BOOST_CHECK_EQUAL(storage.usage(), 9);
+  }
+}
+
+static
+void
+packfile()
+{
+  elle::filesystem::TemporaryDirectory d;
+  memo::silo::Packfile storage(d.path());
+  tests(storage);
+}
+
+static
+void
+packfile_recovery()
+{
+  elle::filesystem::TemporaryDirectory d;
+  auto keys = std::vector<memo::silo::Key>{};
+  for (int i = 0; i < 64; ++i)
+    keys.push_back(memo::silo::Key::random());
+  auto const value = elle::Buffer(std::string(100, 'x'));
+  {
+    memo::silo::Packfile storage(d.path(), {}, 1024);
+    for (auto const& k: keys)
+      storage.set(k, value);
+    for (int i = 0; i < 48; ++i)
+      storage.erase(keys[i]);
+    storage.set(keys[63], elle::Buffer(std::string("overwritten")),
+                false, true);
+    BOOST_CHECK_GT(storage.segments().size(), 1);
+  }
+  {
+    memo::silo::Packfile storage(d.path(), {}, 1024);
+    BOOST_CHECK_EQUAL(storage.block_count(), 16);
+    BOOST_CHECK_EQUAL(storage.usage(), 15 * 100 + 11);
+    BOOST_CHECK_THROW(storage.get(keys[0]), memo::silo::MissingKey);
+    BOOST_CHECK_EQUAL(storage.get(keys[50]), value);
+    BOOST_CHECK_EQUAL(storage.get(keys[63]), "overwritten");
+    auto const segments = storage.segments().size();
+    BOOST_CHECK_GT(storage.compact(), 0);
+    BOOST_CHECK_LT(storage.segments().size(), segments);
+    for (int i = 48; i < 63; ++i)
+      BOOST_CHECK_EQUAL(storage.get(keys[i]), value);
+    BOOST_CHECK_EQUAL(storage.get(keys[63]), "overwritten");
+  }
+  // Unrelated files are ignored.
+  boost::filesystem::ofstream(d.path() / "segment-backup") << "junk";
+  {
+    memo::silo::Packfile storage(d.path(), {}, 1024);
+    BOOST_CHECK_EQUAL(storage.block_count(), 16);
+    BOOST_CHECK_EQUAL(storage.list().size(), 16);
+    BOOST_CHECK_THROW(storage.get(keys[10]), memo::silo::MissingKey);
+  }
+}
+
+static
+void
+packfile_tombstones()
+{
+  elle::filesystem::TemporaryDirectory d;
+  auto const value = elle::Buffer(std::string(400, 'x'));
+  auto const tombstones = [] (memo::silo::Packfile const& storage)
+    {
+      auto res = 0;
+      for (auto const& s: storage.segments())
+        res += s.second.tombstones;
+      return res;
+    };
+  auto keys = std::vector<memo::silo::Key>{};
+  for (int i = 0; i < 9; ++i)
+    keys.push_back(memo::silo::Key::random());
+  {
+    memo::silo::Packfile storage(d.path(), {}, 1024);
+    // Segment 0: 0, 1, 2.
+    for (int i = 0; i < 3; ++i)
+      storage.set(keys[i], value);
+    // Segment 1: tombstone for 0, then 3, 4, 5, all overwritten in
+    // segment 2.
+    storage.erase(keys[0]);
+    for (int i = 3; i < 6; ++i)
+      storage.set(keys[i], value);
+    for (int i = 3; i < 6; ++i)
+      storage.set(keys[i], value, false, true);
+    BOOST_CHECK_EQUAL(tombstones(storage), 1);
+    // Segment 0 still holds 0, the tombstone is moved to segment 3.
+    BOOST_CHECK_GT(storage.compact(), 0);
+    BOOST_CHECK_EQUAL(tombstones(storage), 1);
+    // Segment 3: tombstone for 0 and 1, then 6, 7, 8, all overwritten.
+    storage.erase(keys[1]);
+    for (int i = 6; i < 9; ++i)
+      storage.set(keys[i], value);
+    for (int i = 6; i < 9; ++i)
+      storage.set(keys[i], value, false, true);
+    BOOST_CHECK_EQUAL(tombstones(storage), 2);
+    // Segment 0 is compacted first, nothing is left for the tombstones to
+    // shadow.
+    BOOST_CHECK_GT(storage.compact(), 0);
+    BOOST_CHECK_EQUAL(tombstones(storage), 0);
+    BOOST_CHECK_EQUAL(storage.compact(), 0);
+  }
+  {
+    memo::silo::Packfile storage(d.path(), {}, 1024);
+    BOOST_CHECK_EQUAL(storage.block_count(), 7);
+    BOOST_CHECK_THROW(storage.get(keys[0]), memo::silo::MissingKey);
+    BOOST_CHECK_THROW(storage.get(keys[1]), memo::silo::MissingKey);
+    for (int i = 2; i < 9; ++i)
+      BOOST_CHECK_EQUAL(storage.get(keys[i]), value);
+  }
+}
+
+static
+void
+list_metadata()
+{
+  memo::silo::Memory storage;
+  auto const block = memo::model::Address::random(
+    memo::model::flags::mutable_block);
+  // Metadata, or a block from before flagged addresses whose last byte
+  // happens to match.
+  auto const metadata = memo::model::Address(
+    memo::model::Address::random().value(),
+    memo::model::flags::block_metadata, true);
+  storage.set(block, elle::Buffer("block"));
+  storage.set(metadata, elle::Buffer("metadata"));
+  BOOST_CHECK_EQUAL(storage.list().size(), 2u);
+  storage.hide_metadata(true);
+  BOOST_CHECK(storage.list() == std::vector<memo::silo::Key>{block});
+}
+
+static
+void
+filter()
+{
+  memo::silo::Memory::Blocks blocks;
+  auto keys = std::vector<memo::silo::Key>{};
+  {
+    memo::silo::Memory storage(blocks);
+    for (int i = 0; i < 16; ++i)
+    {
+      keys.emplace_back(memo::silo::Key::random());
+      storage.set(keys.back(), elle::Buffer(elle::sprintf("block %s", i)));
+    }
+  }
+  memo::silo::Memory storage(blocks);
+  storage.enable_filter();
+  BOOST_REQUIRE_EQUAL(storage.filters().size(), 1u);
+  for (int i = 0; i < 16; ++i)
+    BOOST_CHECK_EQUAL(storage.get(keys[i]).string(),
+                      elle::sprintf("block %s", i));
+  auto const missing = memo::silo::Key::random();
+  BOOST_CHECK_THROW(storage.get(missing), memo::silo::MissingKey);
+  BOOST_CHECK(storage.status(missing) == memo::silo::BlockStatus::missing);
+  // Outgrow the filter so another one is appended, without listing.
+  auto const capacity = storage.filters().front().capacity();
+  for (int i = 16; i < signed(capacity) + 16; ++i)
+  {
+    keys.emplace_back(memo::silo::Key::random());
+    storage.set(keys.back(), elle::Buffer(elle::sprintf("block %s", i)));
+  }
+  BOOST_CHECK_EQUAL(storage.filters().size(), 2u);
+  BOOST_CHECK_GE(storage.filters().back().capacity(), 2 * capacity);
+  BOOST_CHECK(storage.status(missing) == memo::silo::BlockStatus::missing);
+  for (int i = 0; i < signed(keys.size()); ++i)
+    BOOST_CHECK_EQUAL(storage.get(keys[i]).string(),
+                      elle::sprintf("block %s", i));
+}
+
 extern const std::string zero_five_four_s3_storage_reduced;
 extern const std::string zero_five_four_s3_storage_default;
 
@@ -157,7 +377,13 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(filesystem));
   suite.add(BOOST_TEST_CASE(filesystem_small_capacity));
   suite.add(BOOST_TEST_CASE(filesystem_large_capacity));
+  suite.add(BOOST_TEST_CASE(filesystem_index));
+  suite.add(BOOST_TEST_CASE(filter));
+  suite.add(BOOST_TEST_CASE(list_metadata));
   suite.add(BOOST_TEST_CASE(memory));
+  suite.add(BOOST_TEST_CASE(packfile));
+  suite.add(BOOST_TEST_CASE(packfile_recovery));
+  suite.add(BOOST_TEST_CASE(packfile_tombstones));
   suite.add(BOOST_TEST_CASE(s3_storage_class_backward_reduced));
   suite.add(BOOST_TEST_CASE(s3_storage_class_backward_default));
 }